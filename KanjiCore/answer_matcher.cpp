@@ -0,0 +1,262 @@
+#include "answer_matcher.h"
+#include "kanji_database.h"
+#include "japanese_text_utils.h"
+#include <QChar>
+#include <QStringList>
+#include <algorithm>
+
+AnswerMatcher::AnswerMatcher()
+{
+}
+
+AnswerMatcher AnswerMatcher::forMeaning(const KanjiCard &card)
+{
+    AnswerMatcher matcher;
+    // Handle multiple meanings separated by "/"
+    const QStringList meanings = card.meaning.split('/');
+    for (const QString &meaning : meanings) {
+        matcher.addAcceptedForm(meaning, true);
+    }
+    return matcher;
+}
+
+AnswerMatcher AnswerMatcher::forReading(const KanjiCard &card)
+{
+    AnswerMatcher matcher;
+    matcher.addAcceptedForm(card.on_reading, false);
+    matcher.addAcceptedForm(card.kun_reading, false);
+    return matcher;
+}
+
+void AnswerMatcher::addAcceptedForm(const QString &form, bool allowTypos)
+{
+    char16_t strict[MaxFormLength];
+    char16_t loose[MaxFormLength];
+
+    int length = normalize(form, strict);
+    if (length <= 0) {
+        return;
+    }
+
+    const int looseLength = foldKana(strict, length, loose);
+
+    Form accepted;
+    accepted.exactHash = hash(strict, length);
+    accepted.looseHash = hash(loose, looseLength);
+    accepted.length = length;
+    accepted.looseLength = looseLength;
+    std::copy(strict, strict + length, accepted.text.begin());
+    std::copy(loose, loose + looseLength, accepted.looseText.begin());
+    accepted.maxTypos = allowTypos ? typoBudget(length) : 0;
+
+    for (const Form &existing : forms) {
+        if (existing.exactHash == accepted.exactHash && sameText(existing.text, existing.length, strict, length)) {
+            return;
+        }
+    }
+
+    // Precompute the Myers pattern masks so match() only runs the bit loop
+    if (accepted.maxTypos > 0) {
+        for (int i = 0; i < length; ++i) {
+            int slot = 0;
+            while (slot < accepted.peqCount && accepted.peqChars[slot] != strict[i]) {
+                ++slot;
+            }
+            if (slot == accepted.peqCount) {
+                accepted.peqChars[slot] = strict[i];
+                accepted.peqMasks[slot] = 0;
+                ++accepted.peqCount;
+            }
+            accepted.peqMasks[slot] |= quint64(1) << i;
+        }
+    }
+
+    forms.append(accepted);
+}
+
+AnswerMatcher::Match AnswerMatcher::match(QStringView answer) const
+{
+    char16_t strict[MaxFormLength];
+    int length = normalize(answer, strict);
+    if (length <= 0) {
+        return Match::None;
+    }
+
+    // The hash only rules forms out; a match is confirmed on the text
+    const quint64 exactHash = hash(strict, length);
+    for (const Form &form : forms) {
+        if (form.exactHash == exactHash && sameText(form.text, form.length, strict, length)) {
+            return Match::Exact;
+        }
+    }
+
+    char16_t loose[MaxFormLength];
+    const int looseLength = foldKana(strict, length, loose);
+    const quint64 looseHash = hash(loose, looseLength);
+    for (const Form &form : forms) {
+        if (form.looseHash == looseHash && sameText(form.looseText, form.looseLength, loose, looseLength)) {
+            return Match::KanaVariant;
+        }
+    }
+
+    for (const Form &form : forms) {
+        if (form.maxTypos > 0 && qAbs(form.length - length) <= form.maxTypos &&
+            distance(form, strict, length) <= form.maxTypos) {
+            return Match::Typo;
+        }
+    }
+
+    return Match::None;
+}
+
+int AnswerMatcher::editDistance(QStringView pattern, QStringView text)
+{
+    if (pattern.isEmpty()) {
+        return int(text.size());
+    }
+    if (pattern.size() > MaxFormLength) {
+        return -1;
+    }
+
+    Form form;
+    form.length = int(pattern.size());
+    for (int i = 0; i < form.length; ++i) {
+        const char16_t ch = pattern[i].unicode();
+        int slot = 0;
+        while (slot < form.peqCount && form.peqChars[slot] != ch) {
+            ++slot;
+        }
+        if (slot == form.peqCount) {
+            form.peqChars[slot] = ch;
+            form.peqMasks[slot] = 0;
+            ++form.peqCount;
+        }
+        form.peqMasks[slot] |= quint64(1) << i;
+    }
+
+    return distance(form, text.utf16(), int(text.size()));
+}
+
+int AnswerMatcher::typoBudget(int length)
+{
+    // Short words must be exact, otherwise "two" would accept "tow" and "to"
+    if (length <= 3) return 0;
+    if (length <= 7) return 1;
+    return 2;
+}
+
+int AnswerMatcher::normalize(QStringView text, char16_t *out)
+{
+    // Lowercase, fold full-width ASCII and katakana, trim and collapse spaces
+    int length = 0;
+    bool pendingSpace = false;
+
+    for (QChar qch : text) {
+        char16_t ch = qch.unicode();
+        if (ch == 0x3000) {
+            ch = u' '; // Ideographic space
+        } else if (ch >= 0xFF01 && ch <= 0xFF5E) {
+            ch = char16_t(ch - 0xFEE0); // Full-width ASCII
+        }
+
+        if (QChar::isSpace(char32_t(ch))) {
+            pendingSpace = length > 0;
+            continue;
+        }
+
+        if (length + (pendingSpace ? 2 : 1) > MaxFormLength) {
+            return -1;
+        }
+        if (pendingSpace) {
+            out[length++] = u' ';
+            pendingSpace = false;
+        }
+        out[length++] = JapaneseTextUtils::toHiragana(char16_t(QChar::toLower(char32_t(ch))));
+    }
+
+    return length;
+}
+
+int AnswerMatcher::foldKana(const char16_t *in, int length, char16_t *out)
+{
+    // Only spellings of the same sound meet: small kana compare at full size,
+    // the long vowel mark is spelled out (こー -> こう, せー -> せい) and おお is
+    // written おう. Vowel length is kept, so こ and こう stay different.
+    int folded = 0;
+    char previousVowel = 0;
+
+    for (int i = 0; i < length; ++i) {
+        char16_t ch = in[i];
+        if (ch == 0x30FC && previousVowel != 0) {
+            switch (previousVowel) {
+                case 'a': ch = 0x3042; break; // あ
+                case 'i': case 'e': ch = 0x3044; break; // い
+                default: ch = 0x3046; break; // う
+            }
+        }
+
+        ch = JapaneseTextUtils::toFullSizeKana(ch);
+        if (ch == 0x304A && previousVowel == 'o') {
+            ch = 0x3046; // おお -> おう
+        }
+
+        out[folded++] = ch;
+        previousVowel = JapaneseTextUtils::kanaVowel(ch);
+    }
+
+    return folded;
+}
+
+quint64 AnswerMatcher::hash(const char16_t *text, int length)
+{
+    // FNV-1a over UTF-16 code units
+    quint64 value = 14695981039346656037ULL;
+    for (int i = 0; i < length; ++i) {
+        value ^= text[i];
+        value *= 1099511628211ULL;
+    }
+    return value;
+}
+
+bool AnswerMatcher::sameText(const std::array<char16_t, MaxFormLength> &stored, int storedLength,
+                             const char16_t *text, int length)
+{
+    return storedLength == length && std::equal(text, text + length, stored.begin());
+}
+
+int AnswerMatcher::distance(const Form &form, const char16_t *text, int length)
+{
+    // Myers/Hyyro bit-vector Levenshtein distance, pattern in one machine word
+    const quint64 highBit = quint64(1) << (form.length - 1);
+    quint64 pv = ~quint64(0);
+    quint64 mv = 0;
+    int score = form.length;
+
+    for (int j = 0; j < length; ++j) {
+        quint64 eq = 0;
+        for (int slot = 0; slot < form.peqCount; ++slot) {
+            if (form.peqChars[slot] == text[j]) {
+                eq = form.peqMasks[slot];
+                break;
+            }
+        }
+
+        const quint64 xv = eq | mv;
+        const quint64 xh = (((eq & pv) + pv) ^ pv) | eq;
+        quint64 ph = mv | ~(xh | pv);
+        quint64 mh = pv & xh;
+
+        if (ph & highBit) {
+            ++score;
+        } else if (mh & highBit) {
+            --score;
+        }
+
+        ph = (ph << 1) | 1;
+        mh <<= 1;
+        pv = mh | ~(xv | ph);
+        mv = ph & xv;
+    }
+
+    return score;
+}
@@ -0,0 +1,78 @@
+#ifndef ANSWER_MATCHER_H
+#define ANSWER_MATCHER_H
+
+// DLL Export/Import macros
+#ifdef _WIN32
+    #ifdef KANJICORE_EXPORTS
+        #define KANJICORE_API __declspec(dllexport)
+    #else
+        #define KANJICORE_API __declspec(dllimport)
+    #endif
+#else
+    #define KANJICORE_API
+#endif
+
+#include <QString>
+#include <QStringView>
+#include <QVector>
+#include <array>
+
+struct KanjiCard;
+
+// Checks quiz answers against the accepted forms of one card.
+// Accepted forms are normalized and hashed once when the session loads,
+// so match() only folds the typed answer into a stack buffer and compares.
+class KANJICORE_API AnswerMatcher
+{
+public:
+    enum class Match {
+        None,        // Wrong answer
+        Exact,       // Same text after case, width and whitespace folding
+        KanaVariant, // Same reading spelled differently: ー or おお for おう, small kana at full size
+        Typo         // Within the typo budget of an accepted meaning
+    };
+
+    static constexpr int MaxFormLength = 64; // Longer input is rejected
+
+    AnswerMatcher();
+
+    // Meanings are split on "/" and allow typos, readings only kana folding
+    static AnswerMatcher forMeaning(const KanjiCard &card);
+    static AnswerMatcher forReading(const KanjiCard &card);
+
+    void addAcceptedForm(const QString &form, bool allowTypos);
+
+    Match match(QStringView answer) const;
+    bool isEmpty() const { return forms.isEmpty(); }
+
+    // Levenshtein distance using Myers' bit-parallel algorithm (pattern <= 64 chars)
+    static int editDistance(QStringView pattern, QStringView text);
+
+private:
+    struct Form {
+        quint64 exactHash = 0;
+        quint64 looseHash = 0;
+        int length = 0;
+        int looseLength = 0;
+        // Normalized and kana-folded text, compared when a hash matches
+        std::array<char16_t, MaxFormLength> text {};
+        std::array<char16_t, MaxFormLength> looseText {};
+        int maxTypos = 0;
+        // Myers pattern bitmasks, one entry per distinct character
+        int peqCount = 0;
+        std::array<char16_t, MaxFormLength> peqChars {};
+        std::array<quint64, MaxFormLength> peqMasks {};
+    };
+
+    static int typoBudget(int length);
+    static int normalize(QStringView text, char16_t *out);
+    static int foldKana(const char16_t *in, int length, char16_t *out);
+    static quint64 hash(const char16_t *text, int length);
+    static bool sameText(const std::array<char16_t, MaxFormLength> &stored, int storedLength,
+                         const char16_t *text, int length);
+    static int distance(const Form &form, const char16_t *text, int length);
+
+    QVector<Form> forms;
+};
+
+#endif // ANSWER_MATCHER_H
@@ -0,0 +1,94 @@
+#include "database_backup.h"
+#include <QThread>
+#include <QDir>
+#include <QFile>
+#include <QDateTime>
+#include <QDebug>
+
+DatabaseBackup::DatabaseBackup(KanjiDatabase *database, QObject *parent)
+    : QObject(parent), database(database), pagesPerStep(DefaultPagesPerStep), worker(nullptr), cancelled(0)
+{
+}
+
+DatabaseBackup::~DatabaseBackup()
+{
+    // The worker posts its result back to this object
+    if (worker) {
+        cancel();
+        worker->wait();
+    }
+}
+
+bool DatabaseBackup::backup(const QString &path)
+{
+    return start(path, QString(), 0);
+}
+
+bool DatabaseBackup::snapshot(int retention)
+{
+    const QString directory = database->getBackupDirectory();
+    if (!QDir().mkpath(directory)) {
+        return false;
+    }
+    const QString name = "kanji_learning-" + QDateTime::currentDateTime().toString("yyyyMMdd-HHmmss") + ".db";
+    return start(QDir(directory).filePath(name), directory, retention);
+}
+
+void DatabaseBackup::cancel()
+{
+    cancelled.storeRelaxed(1);
+}
+
+bool DatabaseBackup::start(const QString &path, const QString &snapshotDirectory, int retention)
+{
+    if (worker) {
+        return false;
+    }
+    cancelled.storeRelaxed(0);
+
+    // The worker's connection only sees committed progress
+    if (!database->flushProgress()) {
+        qDebug() << "Backup: progress flush failed, recent answers not included:" << database->getLastError();
+    }
+
+    const int pages = pagesPerStep;
+    worker = QThread::create([this, path, snapshotDirectory, retention, pages]() {
+        KanjiDatabase source("KanjiBackup");
+        bool ok = source.open() && source.backupTo(path, pages, [this](int copied, int total) {
+            QMetaObject::invokeMethod(this, [this, copied, total]() { emit progress(copied, total); },
+                                      Qt::QueuedConnection);
+            return cancelled.loadRelaxed() == 0;
+        });
+        QString result = ok ? path : source.getLastError();
+
+        if (ok && !snapshotDirectory.isEmpty()) {
+            removeOldSnapshots(snapshotDirectory, retention);
+        }
+
+        QMetaObject::invokeMethod(this, [this, ok, result]() {
+            worker = nullptr;
+            emit finished(ok, result);
+        }, Qt::QueuedConnection);
+    });
+    connect(worker, &QThread::finished, worker, &QObject::deleteLater);
+    worker->start();
+    return true;
+}
+
+QFileInfoList DatabaseBackup::snapshots(const QString &directory)
+{
+    // Names sort by the time they were taken
+    return QDir(directory).entryInfoList({"kanji_learning-*.db"}, QDir::Files, QDir::Name | QDir::Reversed);
+}
+
+int DatabaseBackup::removeOldSnapshots(const QString &directory, int retention)
+{
+    const QFileInfoList files = snapshots(directory);
+    int removed = 0;
+    for (int i = qMax(0, retention); i < files.size(); ++i) {
+        if (QFile::remove(files[i].filePath())) {
+            ++removed;
+        }
+    }
+    return removed;
+}
@@ -0,0 +1,61 @@
+#ifndef DATABASE_BACKUP_H
+#define DATABASE_BACKUP_H
+
+// DLL Export/Import macros
+#ifdef _WIN32
+    #ifdef KANJICORE_EXPORTS
+        #define KANJICORE_API __declspec(dllexport)
+    #else
+        #define KANJICORE_API __declspec(dllimport)
+    #endif
+#else
+    #define KANJICORE_API
+#endif
+
+#include <QObject>
+#include <QAtomicInt>
+#include <QFileInfoList>
+#include "kanji_database.h"
+
+class QThread;
+
+// Runs KanjiDatabase::backupTo() on a worker thread with its own connection,
+// so answers keep committing on the GUI connection while the copy runs.
+// Snapshots are point-in-time backups named by the time they were taken; the
+// oldest are deleted once more than the retention count exist.
+class KANJICORE_API DatabaseBackup : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr int DefaultPagesPerStep = 256;
+    static constexpr int DefaultRetention = 7;
+
+    explicit DatabaseBackup(KanjiDatabase *database, QObject *parent = nullptr);
+    ~DatabaseBackup(); // Cancels and waits for a running backup
+
+    bool backup(const QString &path);                 // False if one is already running
+    bool snapshot(int retention = DefaultRetention);  // Into the database's backup directory
+    bool isRunning() const { return worker != nullptr; }
+    void cancel();
+
+    void setPagesPerStep(int pages) { pagesPerStep = pages; }
+
+    // Snapshot files in directory, newest first
+    static QFileInfoList snapshots(const QString &directory);
+    static int removeOldSnapshots(const QString &directory, int retention);
+
+signals:
+    void progress(int pagesCopied, int pageCount);
+    void finished(bool ok, const QString &pathOrError);
+
+private:
+    bool start(const QString &path, const QString &snapshotDirectory, int retention);
+
+    KanjiDatabase *database;
+    int pagesPerStep;
+    QThread *worker;
+    QAtomicInt cancelled;
+};
+
+#endif // DATABASE_BACKUP_H
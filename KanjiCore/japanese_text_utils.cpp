@@ -271,6 +271,56 @@ bool JapaneseTextUtils::isKanji(const QString &text)
     return !text.isEmpty();
 }
 
+char16_t JapaneseTextUtils::toHiragana(char16_t ch)
+{
+    // Katakana U+30A1-U+30F6 map one-to-one onto hiragana U+3041-U+3096
+    if (ch >= 0x30A1 && ch <= 0x30F6) {
+        return char16_t(ch - 0x60);
+    }
+    return ch;
+}
+
+char16_t JapaneseTextUtils::toFullSizeKana(char16_t ch)
+{
+    switch (ch) {
+        case 0x3041: case 0x3043: case 0x3045: case 0x3047: case 0x3049: // ぁぃぅぇぉ
+        case 0x3063:                                                     // っ
+        case 0x3083: case 0x3085: case 0x3087:                           // ゃゅょ
+        case 0x308E:                                                     // ゎ
+            return char16_t(ch + 1);
+        case 0x3095: return 0x304B; // ゕ -> か
+        case 0x3096: return 0x3051; // ゖ -> け
+        default: return ch;
+    }
+}
+
+char JapaneseTextUtils::kanaVowel(char16_t ch)
+{
+    // Vowel of each hiragana in U+3040-U+309F, '-' where there is none
+    static const char vowels[] =
+        "-"
+        "aaiiuueeoo"        // ぁ-お
+        "aaiiuueeoo"        // か-ご
+        "aaiiuueeoo"        // さ-ぞ
+        "aaii-uueeoo"       // た-ど (small tsu has none)
+        "aiueo"             // な-の
+        "aaaiiiuuueeeooo"   // は-ぽ
+        "aiueo"             // ま-も
+        "aauuoo"            // ゃ-よ
+        "aiueo"             // ら-ろ
+        "aaieo"             // ゎ-を
+        "-uae"              // ん ゔ ゕ ゖ
+        "---------";
+    static_assert(sizeof(vowels) == 0x60 + 1, "one entry per hiragana code point");
+    
+    ch = toHiragana(ch);
+    if (ch < 0x3040 || ch > 0x309F) {
+        return 0;
+    }
+    char vowel = vowels[ch - 0x3040];
+    return vowel == '-' ? 0 : vowel;
+}
+
 // Global convenience function
 QString convertRomajiToHiragana(const QString &romaji)
 {
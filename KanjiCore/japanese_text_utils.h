@@ -28,6 +28,11 @@ public:
     bool isKatakana(const QString &text);
     bool isKanji(const QString &text);
     
+    // Character-level kana folding (no allocation, safe from any thread)
+    static char16_t toHiragana(char16_t ch);     // Katakana -> hiragana
+    static char16_t toFullSizeKana(char16_t ch); // ぁ -> あ, ゃ -> や, ...
+    static char kanaVowel(char16_t ch);          // 'a','i','u','e','o' or 0
+    
 private:
     void initializeRomajiMap();
     QMap<QString, QString> romajiToHiragana;
@@ -0,0 +1,307 @@
+#include "kanji_analytics.h"
+#include "kanji_clock.h"
+#include <QThread>
+#include <QDebug>
+#include <limits>
+#include <utility>
+
+namespace {
+
+// Every group's counters side by side in one small array, so each answer is a
+// fixed number of adds at computed offsets and a slice's counters stay in L1
+enum AnswerSlot {
+    TotalSlot = 0,
+    RecentSlot = 1,
+    LevelSlot = 2,
+    DifficultySlot = LevelSlot + KanjiStatistics::LevelCount,
+    HourSlot = DifficultySlot + KanjiStatistics::DifficultyCount,
+    RetentionSlot = HourSlot + KanjiStatistics::HourCount,
+    DiscardSlot = RetentionSlot + KanjiStatistics::RetentionBucketCount, // Also "no interval"
+    SlotCount = DiscardSlot + 1
+};
+
+struct AnswerHistogram {
+    qint64 reviews[SlotCount] = {};
+    qint64 correct[SlotCount] = {};
+};
+
+// Plain pointers into the columns for the worker threads
+struct AnswerColumns {
+    const int *kanjiId;
+    const qint64 *reviewedAt;
+    const quint8 *correct;
+    const quint8 *srsLevel;
+    const quint8 *difficulty;
+    const quint8 *hourOfDay;
+    const quint8 *retentionSlot;
+    const quint8 *inScope;
+};
+
+// No branches on the data: answers outside the active deck add zero
+void countAnswers(const AnswerColumns &columns, int begin, int end, qint64 recentFrom, AnswerHistogram &histogram)
+{
+    for (int i = begin; i < end; ++i) {
+        const qint64 weight = columns.inScope[columns.kanjiId[i]];
+        const qint64 hit = weight & columns.correct[i];
+        const int slots[] = {
+            TotalSlot,
+            columns.reviewedAt[i] >= recentFrom ? RecentSlot : DiscardSlot,
+            LevelSlot + columns.srsLevel[i],
+            DifficultySlot + columns.difficulty[i] - 1,
+            HourSlot + columns.hourOfDay[i],
+            RetentionSlot + columns.retentionSlot[i]
+        };
+        for (int slot : slots) {
+            histogram.reviews[slot] += weight;
+            histogram.correct[slot] += hit;
+        }
+    }
+}
+
+// Bucket b holds intervals from 2^b seconds up to 2^(b+1)
+quint8 retentionBucket(qint32 elapsedSeconds)
+{
+    if (elapsedSeconds < 0) {
+        return KanjiStatistics::RetentionBucketCount;
+    }
+    int bucket = 0;
+    while (bucket < KanjiStatistics::RetentionBucketCount - 1 && (qint64(2) << bucket) <= elapsedSeconds) {
+        ++bucket;
+    }
+    return quint8(bucket);
+}
+
+} // namespace
+
+KanjiAnalytics::KanjiAnalytics(KanjiDatabase *database, int threads, QObject *parent)
+    : QObject(parent), database(database),
+      threadCount(threads > 0 ? threads : qMax(1, QThread::idealThreadCount())),
+      cardsStale(true), maxReviewedId(0), loader(nullptr)
+{
+    pool.setMaxThreadCount(threadCount);
+    connect(database->notifier(), &KanjiChangeNotifier::changed, this, &KanjiAnalytics::applyChange);
+}
+
+KanjiAnalytics::~KanjiAnalytics()
+{
+    // The loader writes into this object
+    if (loader) {
+        loader->wait();
+    }
+}
+
+void KanjiAnalytics::preload()
+{
+    if (loader) {
+        return;
+    }
+
+    // The worker's connection only sees committed answers
+    if (!database->flushProgress()) {
+        qDebug() << "KanjiAnalytics: progress flush failed:" << database->getLastError();
+    }
+
+    loaded = KanjiReviewColumns();
+    loaded.lastLogId = reviews.lastLogId;
+    loader = QThread::create([this]() {
+        KanjiDatabase reader("KanjiAnalyticsLoad");
+        if (!reader.open() || !reader.readReviewLog(loaded)) {
+            // Whatever is missing is read by the next statistics() call
+            qDebug() << "KanjiAnalytics: background read failed:" << reader.getLastError();
+        }
+    });
+    connect(loader, &QThread::finished, this, &KanjiAnalytics::takeLoadedReviews);
+    connect(loader, &QThread::finished, loader, &QObject::deleteLater);
+    loader->start();
+}
+
+void KanjiAnalytics::takeLoadedReviews()
+{
+    if (!loader) {
+        return; // Already taken by statistics()
+    }
+    loader->wait();
+    loader = nullptr;
+    appendReviews(loaded);
+    loaded = KanjiReviewColumns();
+}
+
+KanjiStatistics KanjiAnalytics::statistics()
+{
+    // Deltas still waiting in the notifier patch the card columns first
+    database->notifier()->flush();
+    if (cardsStale) {
+        loadCards();
+    }
+    loadReviews();
+
+    const qint64 nowMs = KanjiClock::now().toMSecsSinceEpoch();
+    KanjiStatistics statistics;
+    aggregateCards(statistics, nowMs);
+    aggregateAnswers(statistics, nowMs);
+    return statistics;
+}
+
+void KanjiAnalytics::loadCards()
+{
+    cardRows.clear();
+    if (!database->readCardStates(cards)) {
+        // Counted as an empty deck and read again next time
+        qDebug() << "KanjiAnalytics: card states unavailable:" << database->getLastError();
+        inScope.fill(0);
+        return;
+    }
+
+    int maxId = maxReviewedId;
+    cardRows.reserve(cards.size());
+    for (int row = 0; row < cards.size(); ++row) {
+        cardRows.insert(cards.id[row], row);
+        maxId = qMax(maxId, cards.id[row]);
+    }
+
+    inScope.fill(0, maxId + 1);
+    for (int id : cards.id) {
+        inScope[id] = 1;
+    }
+    cardsStale = false;
+}
+
+void KanjiAnalytics::loadReviews()
+{
+    // A background read still running is waited for, then only the tail is left
+    takeLoadedReviews();
+
+    KanjiReviewColumns chunk;
+    chunk.lastLogId = reviews.lastLogId;
+    if (!database->readReviewLog(chunk)) {
+        qDebug() << "KanjiAnalytics: review log unavailable:" << database->getLastError();
+    }
+    appendReviews(chunk);
+}
+
+void KanjiAnalytics::appendReviews(KanjiReviewColumns &chunk)
+{
+    if (reviews.size() == 0) {
+        reviews = std::move(chunk);
+    } else {
+        reviews.lastLogId = chunk.lastLogId;
+        reviews.kanjiId += chunk.kanjiId;
+        reviews.reviewedAt += chunk.reviewedAt;
+        reviews.elapsedSeconds += chunk.elapsedSeconds;
+        reviews.correct += chunk.correct;
+        reviews.srsLevel += chunk.srsLevel;
+        reviews.difficulty += chunk.difficulty;
+        reviews.hourOfDay += chunk.hourOfDay;
+    }
+
+    // Derived per new answer only; the log is append-only
+    retentionSlot.reserve(reviews.size());
+    for (int i = retentionSlot.size(); i < reviews.size(); ++i) {
+        retentionSlot.append(retentionBucket(reviews.elapsedSeconds[i]));
+        maxReviewedId = qMax(maxReviewedId, reviews.kanjiId[i]);
+    }
+
+    // Cards answered outside the deck may have ids past the last one in it
+    if (inScope.size() <= maxReviewedId) {
+        inScope.resize(maxReviewedId + 1);
+    }
+}
+
+void KanjiAnalytics::aggregateCards(KanjiStatistics &statistics, qint64 nowMs) const
+{
+    qint64 soonest = std::numeric_limits<qint64>::max();
+    for (int i = 0; i < cards.size(); ++i) {
+        const int learned = cards.learned[i];
+        const qint64 nextReview = cards.nextReview[i];
+        statistics.learnedCards += learned;
+        statistics.cardsByLevel[cards.srsLevel[i] * learned] += 1;
+        statistics.dueCards += learned & int(nextReview >= 0 && nextReview <= nowMs);
+        if (learned && nextReview > nowMs) {
+            soonest = qMin(soonest, nextReview);
+        }
+    }
+
+    statistics.totalCards = cards.size();
+    statistics.newCards = statistics.totalCards - statistics.learnedCards;
+    if (soonest != std::numeric_limits<qint64>::max()) {
+        statistics.nextReview = QDateTime::fromMSecsSinceEpoch(soonest);
+    }
+}
+
+void KanjiAnalytics::aggregateAnswers(KanjiStatistics &statistics, qint64 nowMs)
+{
+    const int rows = reviews.size();
+    const qint64 recentFrom = nowMs - qint64(KanjiStatistics::RecentDays) * 24 * 3600 * 1000;
+    const AnswerColumns columns = {
+        reviews.kanjiId.constData(), reviews.reviewedAt.constData(), reviews.correct.constData(),
+        reviews.srsLevel.constData(), reviews.difficulty.constData(), reviews.hourOfDay.constData(),
+        retentionSlot.constData(), inScope.constData()
+    };
+
+    // One contiguous slice per task; each fills its own histogram
+    const int taskCount = qBound(1, rows / MinRowsPerTask, threadCount);
+    QVector<AnswerHistogram> partials(taskCount);
+    if (taskCount == 1) {
+        countAnswers(columns, 0, rows, recentFrom, partials[0]);
+    } else {
+        AnswerHistogram *slots = partials.data();
+        for (int task = 0; task < taskCount; ++task) {
+            const int begin = int(qint64(rows) * task / taskCount);
+            const int end = int(qint64(rows) * (task + 1) / taskCount);
+            pool.start([=]() { countAnswers(columns, begin, end, recentFrom, slots[task]); });
+        }
+        pool.waitForDone();
+    }
+
+    AnswerHistogram merged;
+    for (const AnswerHistogram &partial : partials) {
+        for (int slot = 0; slot < SlotCount; ++slot) {
+            merged.reviews[slot] += partial.reviews[slot];
+            merged.correct[slot] += partial.correct[slot];
+        }
+    }
+
+    auto group = [&merged](int slot) {
+        KanjiAnswerCounts counts;
+        counts.reviews = merged.reviews[slot];
+        counts.correct = merged.correct[slot];
+        return counts;
+    };
+    statistics.answers = group(TotalSlot);
+    statistics.recentAnswers = group(RecentSlot);
+    for (int level = 0; level < KanjiStatistics::LevelCount; ++level) {
+        statistics.byLevel[level] = group(LevelSlot + level);
+    }
+    for (int difficulty = 0; difficulty < KanjiStatistics::DifficultyCount; ++difficulty) {
+        statistics.byDifficulty[difficulty] = group(DifficultySlot + difficulty);
+    }
+    for (int hour = 0; hour < KanjiStatistics::HourCount; ++hour) {
+        statistics.byHour[hour] = group(HourSlot + hour);
+    }
+    for (int bucket = 0; bucket < KanjiStatistics::RetentionBucketCount; ++bucket) {
+        statistics.retention[bucket] = group(RetentionSlot + bucket);
+    }
+}
+
+void KanjiAnalytics::applyChange(const KanjiChangeSet &change)
+{
+    if (change.kinds & (KanjiChangeSet::CardsReset | KanjiChangeSet::CardsImported | KanjiChangeSet::ScopeChanged)) {
+        cardsStale = true;
+        return;
+    }
+    if (cardsStale) {
+        return;
+    }
+
+    // Reschedules only name cards in the active deck, which are all loaded
+    for (const KanjiReschedule &reschedule : change.reschedules) {
+        const int row = cardRows.value(reschedule.cardId, -1);
+        if (row < 0) {
+            cardsStale = true;
+            return;
+        }
+        cards.learned[row] = reschedule.isLearned ? 1 : 0;
+        cards.srsLevel[row] = quint8(qBound(0, reschedule.toLevel, KanjiStatistics::LevelCount - 1));
+        cards.nextReview[row] = reschedule.toReview.isValid() ? reschedule.toReview.toMSecsSinceEpoch() : qint64(-1);
+    }
+}
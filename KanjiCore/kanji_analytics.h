@@ -0,0 +1,109 @@
+#ifndef KANJI_ANALYTICS_H
+#define KANJI_ANALYTICS_H
+
+// DLL Export/Import macros
+#ifdef _WIN32
+    #ifdef KANJICORE_EXPORTS
+        #define KANJICORE_API __declspec(dllexport)
+    #else
+        #define KANJICORE_API __declspec(dllimport)
+    #endif
+#else
+    #define KANJICORE_API
+#endif
+
+#include <QObject>
+#include <QDateTime>
+#include <QHash>
+#include <QThread>
+#include <QThreadPool>
+#include <QVector>
+#include "kanji_database.h"
+#include "kanji_change_notifier.h"
+
+// Answers in one group
+struct KANJICORE_API KanjiAnswerCounts {
+    qint64 reviews = 0;
+    qint64 correct = 0;
+
+    double accuracy() const { return reviews > 0 ? double(correct) / reviews : 0.0; }
+};
+
+// Card counts and answer accuracy for the active deck
+struct KANJICORE_API KanjiStatistics {
+    static constexpr int LevelCount = 9;             // SRS levels 0-8, 0 for new cards
+    static constexpr int DifficultyCount = 5;        // difficulty_level 1-5
+    static constexpr int HourCount = 24;
+    static constexpr int RetentionBucketCount = 24;  // Powers of two seconds, the last open-ended
+    static constexpr int RecentDays = 30;
+
+    // Same values as the database's count queries
+    int totalCards = 0;
+    int learnedCards = 0;
+    int newCards = 0;
+    int dueCards = 0;
+    int cardsByLevel[LevelCount] = {};
+    QDateTime nextReview; // Soonest next_review still in the future, invalid if none
+
+    KanjiAnswerCounts answers;
+    KanjiAnswerCounts recentAnswers;                 // Last RecentDays days
+    KanjiAnswerCounts byLevel[LevelCount];           // Level the card was answered at
+    KanjiAnswerCounts byDifficulty[DifficultyCount]; // Index difficulty_level - 1
+    KanjiAnswerCounts byHour[HourCount];             // Local hour of the answer
+    // Retention curve: answers by time since the card's previous review, bucket
+    // b from 2^b seconds up to 2^(b+1). A card's first review has no interval.
+    KanjiAnswerCounts retention[RetentionBucketCount];
+
+    static qint64 retentionBucketStart(int bucket) { return bucket == 0 ? 0 : qint64(1) << bucket; }
+};
+
+// Review history and card state held as columns in memory. preload() reads
+// the history on a worker thread with its own connection; statistics() waits
+// for that read if it is still running, then only reads answers logged since.
+// Card columns are read on first use and follow the change notifier's
+// per-card reschedules, so refreshing the numbers costs one rowid range
+// instead of a query per count. Aggregation runs over the columns in slices
+// on a thread pool, each slice into its own counters, merged at the end.
+// GUI thread only, on the database's own connection.
+class KANJICORE_API KanjiAnalytics : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr int MinRowsPerTask = 64 * 1024; // Smaller histories aggregate on the calling thread
+
+    explicit KanjiAnalytics(KanjiDatabase *database, int threadCount = 0, QObject *parent = nullptr); // 0 = ideal
+    ~KanjiAnalytics();
+
+    void preload(); // Start reading the review history in the background unless a read is running
+    KanjiStatistics statistics();
+    int reviewCount() const { return reviews.size(); } // Answers loaded so far, across every deck
+
+private slots:
+    void applyChange(const KanjiChangeSet &change);
+    void takeLoadedReviews();
+
+private:
+    void loadCards();
+    void loadReviews();
+    void appendReviews(KanjiReviewColumns &chunk);
+    void aggregateCards(KanjiStatistics &statistics, qint64 nowMs) const;
+    void aggregateAnswers(KanjiStatistics &statistics, qint64 nowMs);
+
+    KanjiDatabase *database;
+    int threadCount;
+    QThreadPool pool;
+    bool cardsStale;
+
+    KanjiCardColumns cards;
+    QHash<int, int> cardRows;       // Card id -> index in cards
+    KanjiReviewColumns reviews;
+    QVector<quint8> retentionSlot;  // Per answer: retention bucket, RetentionBucketCount for none
+    QVector<quint8> inScope;        // Indexed by card id: 1 for cards in the active deck
+    int maxReviewedId;
+
+    QThread *loader;                // Running preload(), null when none
+    KanjiReviewColumns loaded;      // Written by the loader only until it finishes
+};
+
+#endif // KANJI_ANALYTICS_H
@@ -0,0 +1,54 @@
+#include "kanji_change_notifier.h"
+
+void KanjiChangeSet::merge(const KanjiChangeSet &other)
+{
+    kinds |= other.kinds;
+    totalDelta += other.totalDelta;
+    learnedDelta += other.learnedDelta;
+    newDelta += other.newDelta;
+    reviewDueDelta += other.reviewDueDelta;
+    cardIds.append(other.cardIds);
+    reschedules.append(other.reschedules);
+
+    if (other.earliestNextReview.isValid() &&
+        (!earliestNextReview.isValid() || other.earliestNextReview < earliestNextReview)) {
+        earliestNextReview = other.earliestNextReview;
+    }
+}
+
+KanjiChangeNotifier::KanjiChangeNotifier(QObject *parent)
+    : QObject(parent), flushScheduled(false), currentRevision(0)
+{
+}
+
+void KanjiChangeNotifier::post(const KanjiChangeSet &change)
+{
+    if (change.isEmpty()) {
+        return;
+    }
+
+    ++currentRevision;
+    pending.merge(change);
+
+    if (!flushScheduled) {
+        flushScheduled = true;
+        QMetaObject::invokeMethod(this, &KanjiChangeNotifier::flush, Qt::QueuedConnection);
+    }
+}
+
+void KanjiChangeNotifier::flush()
+{
+    flushScheduled = false;
+    if (pending.isEmpty()) {
+        return;
+    }
+
+    KanjiChangeSet change = pending;
+    pending = KanjiChangeSet();
+    emit changed(change);
+}
+
+void KanjiChangeNotifier::discardPending()
+{
+    pending = KanjiChangeSet();
+}
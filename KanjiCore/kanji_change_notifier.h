@@ -0,0 +1,88 @@
+#ifndef KANJI_CHANGE_NOTIFIER_H
+#define KANJI_CHANGE_NOTIFIER_H
+
+// DLL Export/Import macros
+#ifdef _WIN32
+    #ifdef KANJICORE_EXPORTS
+        #define KANJICORE_API __declspec(dllexport)
+    #else
+        #define KANJICORE_API __declspec(dllimport)
+    #endif
+#else
+    #define KANJICORE_API
+#endif
+
+#include <QObject>
+#include <QList>
+#include <QDateTime>
+#include <QMetaType>
+
+// One card's schedule before and after a write
+struct KANJICORE_API KanjiReschedule {
+    int cardId = 0;
+    bool wasLearned = false;
+    QDateTime fromReview;
+    int fromLevel = 0;
+    bool isLearned = false;
+    QDateTime toReview;
+    int toLevel = 0;
+};
+
+// Counter deltas produced by one or more KanjiDatabase writes
+struct KANJICORE_API KanjiChangeSet {
+    enum Kind {
+        CardsLearned = 0x1,      // Unlearned cards became learned
+        CardsRescheduled = 0x2,  // next_review / srs_level moved
+        CardsReset = 0x4,        // Progress wiped
+        CardsImported = 0x8,     // New cards inserted
+        CardsReordered = 0x10,   // New-card priorities changed, counts unaffected
+        ScopeChanged = 0x20      // Active deck switched; re-read counts, deltas don't apply
+    };
+
+    int kinds = 0;
+    int totalDelta = 0;
+    int learnedDelta = 0;
+    int newDelta = 0;
+    int reviewDueDelta = 0;
+    QList<int> cardIds;            // Touched cards, empty for bulk operations
+    QDateTime earliestNextReview;  // Soonest review scheduled by these writes
+    // Per-card writes in the active deck, for listeners keeping per-time
+    // aggregates (KanjiForecast). Reset, import and scope changes rewrite
+    // schedules in bulk and carry none; re-read after those.
+    QList<KanjiReschedule> reschedules;
+
+    bool isEmpty() const { return kinds == 0; }
+    void merge(const KanjiChangeSet &other);
+};
+
+Q_DECLARE_METATYPE(KanjiChangeSet)
+
+// Owned by KanjiDatabase. Writes post their deltas here; everything posted
+// before control returns to the event loop is emitted as a single changed()
+// so a burst of answers costs listeners one update.
+class KANJICORE_API KanjiChangeNotifier : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit KanjiChangeNotifier(QObject *parent = nullptr);
+
+    void post(const KanjiChangeSet &change);
+    void flush();          // Emit pending changes now
+    void discardPending(); // Caller re-read absolute counts that already include them
+
+    // Bumped synchronously by every post(), so cached query results can be
+    // checked for staleness before the coalesced signal has gone out
+    quint64 revision() const { return currentRevision; }
+
+signals:
+    void changed(const KanjiChangeSet &change);
+    void progressFlushed(); // Write-behind answers were committed; other connections see them now
+
+private:
+    KanjiChangeSet pending;
+    bool flushScheduled;
+    quint64 currentRevision;
+};
+
+#endif // KANJI_CHANGE_NOTIFIER_H
@@ -0,0 +1,37 @@
+#include "kanji_clock.h"
+#include <QAtomicInteger>
+
+namespace {
+constexpr qint64 SystemTime = -1;
+
+// Read from worker threads too (SessionPrefetcher, DatabaseBackup)
+QAtomicInteger<qint64> virtualMsecs(SystemTime);
+}
+
+QDateTime KanjiClock::now()
+{
+    const qint64 msecs = virtualMsecs.loadRelaxed();
+    return msecs == SystemTime ? QDateTime::currentDateTime() : QDateTime::fromMSecsSinceEpoch(msecs);
+}
+
+void KanjiClock::setVirtualTime(const QDateTime &time)
+{
+    virtualMsecs.storeRelaxed(time.toMSecsSinceEpoch());
+}
+
+void KanjiClock::advance(qint64 seconds)
+{
+    if (isVirtual()) {
+        virtualMsecs.fetchAndAddRelaxed(seconds * 1000);
+    }
+}
+
+void KanjiClock::useSystemTime()
+{
+    virtualMsecs.storeRelaxed(SystemTime);
+}
+
+bool KanjiClock::isVirtual()
+{
+    return virtualMsecs.loadRelaxed() != SystemTime;
+}
@@ -0,0 +1,31 @@
+#ifndef KANJI_CLOCK_H
+#define KANJI_CLOCK_H
+
+// DLL Export/Import macros
+#ifdef _WIN32
+    #ifdef KANJICORE_EXPORTS
+        #define KANJICORE_API __declspec(dllexport)
+    #else
+        #define KANJICORE_API __declspec(dllimport)
+    #endif
+#else
+    #define KANJICORE_API
+#endif
+
+#include <QDateTime>
+
+// The time scheduling decisions are made against. Follows the system clock
+// unless a virtual time is set, which tools use to replay months of reviews
+// in minutes. The virtual time only moves when set or advanced.
+class KANJICORE_API KanjiClock
+{
+public:
+    static QDateTime now();
+
+    static void setVirtualTime(const QDateTime &time);
+    static void advance(qint64 seconds); // Virtual time only
+    static void useSystemTime();
+    static bool isVirtual();
+};
+
+#endif // KANJI_CLOCK_H
@@ -0,0 +1,458 @@
+#include "kanji_column_file.h"
+#include <QHash>
+#include <QVector>
+#include <QtEndian>
+#include <cstring>
+
+using namespace KanjiColumnFormat;
+
+namespace {
+
+void putVarint(QByteArray &out, quint64 value)
+{
+    while (value >= 0x80) {
+        out.append(char(value | 0x80));
+        value >>= 7;
+    }
+    out.append(char(value));
+}
+
+void putZigzag(QByteArray &out, qint64 value)
+{
+    putVarint(out, (quint64(value) << 1) ^ quint64(value >> 63));
+}
+
+bool getVarint(const char *&p, const char *end, quint64 &value)
+{
+    value = 0;
+    for (int shift = 0; p < end && shift < 64; shift += 7) {
+        const quint8 byte = quint8(*p++);
+        value |= quint64(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool getZigzag(const char *&p, const char *end, qint64 &value)
+{
+    quint64 raw;
+    if (!getVarint(p, end, raw)) {
+        return false;
+    }
+    value = qint64(raw >> 1) ^ -qint64(raw & 1);
+    return true;
+}
+
+template <typename T>
+void putFixed(QByteArray &out, T value)
+{
+    char bytes[sizeof(T)];
+    qToLittleEndian(value, bytes);
+    out.append(bytes, sizeof(T));
+}
+
+void appendColumn(QByteArray &payload, Encoding encoding, const QByteArray &data)
+{
+    payload.append(char(encoding));
+    putVarint(payload, quint64(data.size()));
+    payload.append(data);
+}
+
+// Sorted or slowly changing columns (ids, timestamps) shrink as differences
+void encodeIntegers(QByteArray &payload, const QVector<qint64> &values)
+{
+    QByteArray plain;
+    QByteArray delta;
+    qint64 previous = 0;
+    for (qint64 value : values) {
+        putZigzag(plain, value);
+        putZigzag(delta, qint64(quint64(value) - quint64(previous)));
+        previous = value;
+    }
+    if (delta.size() < plain.size()) {
+        appendColumn(payload, DeltaIntegers, delta);
+    } else {
+        appendColumn(payload, PlainIntegers, plain);
+    }
+}
+
+void encodeStrings(QByteArray &payload, const QList<QString> &values)
+{
+    QByteArray plain;
+    QByteArray indices;
+    QByteArray dictionary;
+    QHash<QString, int> positions;
+    positions.reserve(values.size());
+
+    for (const QString &value : values) {
+        const QByteArray utf8 = value.toUtf8();
+        putVarint(plain, quint64(utf8.size()));
+        plain.append(utf8);
+
+        auto position = positions.constFind(value);
+        if (position == positions.constEnd()) {
+            position = positions.insert(value, positions.size());
+            putVarint(dictionary, quint64(utf8.size()));
+            dictionary.append(utf8);
+        }
+        putVarint(indices, quint64(*position));
+    }
+
+    QByteArray encoded;
+    putVarint(encoded, quint64(positions.size()));
+    encoded.append(dictionary);
+    encoded.append(indices);
+    if (encoded.size() < plain.size()) {
+        appendColumn(payload, DictionaryStrings, encoded);
+    } else {
+        appendColumn(payload, PlainStrings, plain);
+    }
+}
+
+// Column header: encoding and the bounds of its data
+bool beginColumn(const char *&p, const char *end, quint8 &encoding, const char *&columnEnd)
+{
+    quint64 size;
+    if (p >= end) {
+        return false;
+    }
+    encoding = quint8(*p++);
+    if (!getVarint(p, end, size) || size > quint64(end - p)) {
+        return false;
+    }
+    columnEnd = p + size;
+    return true;
+}
+
+bool decodeIntegers(const char *&p, const char *end, int rows, QVector<qint64> &values)
+{
+    quint8 encoding;
+    const char *columnEnd;
+    if (!beginColumn(p, end, encoding, columnEnd) ||
+        (encoding != PlainIntegers && encoding != DeltaIntegers)) {
+        return false;
+    }
+
+    values.resize(rows);
+    qint64 previous = 0;
+    for (int row = 0; row < rows; ++row) {
+        qint64 value;
+        if (!getZigzag(p, columnEnd, value)) {
+            return false;
+        }
+        if (encoding == DeltaIntegers) {
+            value = qint64(quint64(previous) + quint64(value));
+            previous = value;
+        }
+        values[row] = value;
+    }
+    return p == columnEnd;
+}
+
+bool getString(const char *&p, const char *end, QString &value)
+{
+    quint64 size;
+    if (!getVarint(p, end, size) || size > quint64(end - p)) {
+        return false;
+    }
+    value = QString::fromUtf8(p, qsizetype(size));
+    p += size;
+    return true;
+}
+
+bool decodeStrings(const char *&p, const char *end, int rows, QList<QString> &values)
+{
+    quint8 encoding;
+    const char *columnEnd;
+    if (!beginColumn(p, end, encoding, columnEnd)) {
+        return false;
+    }
+
+    values.resize(rows);
+    if (encoding == PlainStrings) {
+        for (int row = 0; row < rows; ++row) {
+            if (!getString(p, columnEnd, values[row])) {
+                return false;
+            }
+        }
+    } else if (encoding == DictionaryStrings) {
+        quint64 dictionarySize;
+        if (!getVarint(p, columnEnd, dictionarySize) || dictionarySize > quint64(columnEnd - p)) {
+            return false;
+        }
+        QList<QString> dictionary(qsizetype(dictionarySize));
+        for (QString &entry : dictionary) {
+            if (!getString(p, columnEnd, entry)) {
+                return false;
+            }
+        }
+        for (int row = 0; row < rows; ++row) {
+            quint64 index;
+            if (!getVarint(p, columnEnd, index) || index >= dictionarySize) {
+                return false;
+            }
+            values[row] = dictionary.at(qsizetype(index)); // Implicitly shared, no copy
+        }
+    } else {
+        return false;
+    }
+    return p == columnEnd;
+}
+
+bool readFixed(QIODevice *device, char *bytes, qint64 size)
+{
+    return device->read(bytes, size) == size;
+}
+
+qint64 toMSecs(const QDateTime &time)
+{
+    return time.isValid() ? time.toMSecsSinceEpoch() : -1;
+}
+
+QDateTime fromMSecs(qint64 msecs)
+{
+    return msecs >= 0 ? QDateTime::fromMSecsSinceEpoch(msecs) : QDateTime();
+}
+
+} // namespace
+
+quint32 KanjiColumnFormat::crc32(const char *data, qsizetype size)
+{
+    // IEEE 802.3 polynomial, as used by zlib and PNG
+    static const QVector<quint32> table = []() {
+        QVector<quint32> entries(256);
+        for (quint32 i = 0; i < 256; ++i) {
+            quint32 c = i;
+            for (int bit = 0; bit < 8; ++bit) {
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            }
+            entries[i] = c;
+        }
+        return entries;
+    }();
+
+    quint32 crc = 0xFFFFFFFFu;
+    for (qsizetype i = 0; i < size; ++i) {
+        crc = table[(crc ^ quint8(data[i])) & 0xFF] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFFu;
+}
+
+KanjiColumnWriter::KanjiColumnWriter(QIODevice *device, int rowGroupSize)
+    : device(device), rowGroupSize(qMax(1, rowGroupSize)), totalRows(0)
+{
+}
+
+bool KanjiColumnWriter::begin()
+{
+    QByteArray header(Magic, sizeof(Magic));
+    putFixed<quint16>(header, Version);
+    putFixed<quint16>(header, ColumnCount);
+    if (device->write(header) != header.size()) {
+        lastError = "Cannot write export file: " + device->errorString();
+        return false;
+    }
+
+    cards.reserve(rowGroupSize);
+    levels.reserve(rowGroupSize);
+    return true;
+}
+
+bool KanjiColumnWriter::append(const KanjiCard &card, int jlptLevels)
+{
+    cards.append(card);
+    levels.append(jlptLevels);
+    return cards.size() < rowGroupSize || writeRowGroup();
+}
+
+bool KanjiColumnWriter::finish()
+{
+    if (!cards.isEmpty() && !writeRowGroup()) {
+        return false;
+    }
+
+    QByteArray trailer;
+    putFixed<quint32>(trailer, 0);
+    putFixed<quint64>(trailer, quint64(totalRows));
+    if (device->write(trailer) != trailer.size()) {
+        lastError = "Cannot write export file: " + device->errorString();
+        return false;
+    }
+    return true;
+}
+
+bool KanjiColumnWriter::writeRowGroup()
+{
+    const int rows = cards.size();
+    QByteArray payload;
+    QVector<qint64> integers(rows);
+    QList<QString> strings(rows);
+
+    // Written in KanjiColumnFormat::Column order
+    auto integerColumn = [&](auto field) {
+        for (int row = 0; row < rows; ++row) {
+            integers[row] = field(cards.at(row));
+        }
+        encodeIntegers(payload, integers);
+    };
+    auto stringColumn = [&](QString KanjiCard::*field) {
+        for (int row = 0; row < rows; ++row) {
+            strings[row] = cards.at(row).*field;
+        }
+        encodeStrings(payload, strings);
+    };
+
+    integerColumn([](const KanjiCard &card) { return qint64(card.id); });
+    stringColumn(&KanjiCard::kanji);
+    stringColumn(&KanjiCard::meaning);
+    stringColumn(&KanjiCard::on_reading);
+    stringColumn(&KanjiCard::kun_reading);
+    stringColumn(&KanjiCard::example_word);
+    stringColumn(&KanjiCard::example_reading);
+    stringColumn(&KanjiCard::example_meaning);
+    integerColumn([](const KanjiCard &card) { return qint64(card.difficulty_level); });
+    integerColumn([](const KanjiCard &card) { return qint64(card.is_learned ? 1 : 0); });
+    integerColumn([](const KanjiCard &card) { return toMSecs(card.last_reviewed); });
+    integerColumn([](const KanjiCard &card) { return toMSecs(card.next_review); });
+    integerColumn([](const KanjiCard &card) { return qint64(card.srs_level); });
+    integerColumn([](const KanjiCard &card) { return qint64(card.review_count); });
+    integerColumn([](const KanjiCard &card) { return card.priority; });
+    for (int row = 0; row < rows; ++row) {
+        integers[row] = levels.at(row);
+    }
+    encodeIntegers(payload, integers);
+
+    QByteArray group;
+    group.reserve(payload.size() + 12);
+    putFixed<quint32>(group, quint32(rows));
+    putFixed<quint32>(group, quint32(payload.size()));
+    group.append(payload);
+    putFixed<quint32>(group, crc32(payload.constData(), payload.size()));
+    if (device->write(group) != group.size()) {
+        lastError = "Cannot write export file: " + device->errorString();
+        return false;
+    }
+
+    totalRows += rows;
+    cards.clear();
+    levels.clear();
+    return true;
+}
+
+KanjiColumnReader::KanjiColumnReader(QIODevice *device)
+    : device(device), reachedEnd(false), totalRows(0)
+{
+}
+
+bool KanjiColumnReader::open()
+{
+    char header[8];
+    if (!readFixed(device, header, sizeof(header)) || memcmp(header, Magic, sizeof(Magic)) != 0) {
+        lastError = "Not a kanji export file";
+        return false;
+    }
+
+    const quint16 version = qFromLittleEndian<quint16>(header + 4);
+    const quint16 columns = qFromLittleEndian<quint16>(header + 6);
+    if (version != Version || columns != ColumnCount) {
+        lastError = QString("Unsupported kanji export file version %1").arg(version);
+        return false;
+    }
+    return true;
+}
+
+bool KanjiColumnReader::readRowGroup(QList<KanjiCard> &cards, QList<int> *jlptLevels)
+{
+    cards.clear();
+    if (jlptLevels) {
+        jlptLevels->clear();
+    }
+    if (reachedEnd) {
+        return false;
+    }
+
+    char sizes[8];
+    if (!readFixed(device, sizes, 4)) {
+        lastError = "Export file is truncated";
+        return false;
+    }
+    const quint32 rows = qFromLittleEndian<quint32>(sizes);
+
+    if (rows == 0) {
+        char trailer[8];
+        if (!readFixed(device, trailer, sizeof(trailer)) || qFromLittleEndian<quint64>(trailer) != quint64(totalRows)) {
+            lastError = "Export file trailer does not match its rows";
+            return false;
+        }
+        reachedEnd = true;
+        return false;
+    }
+
+    if (!readFixed(device, sizes + 4, 4)) {
+        lastError = "Export file is truncated";
+        return false;
+    }
+    const quint32 size = qFromLittleEndian<quint32>(sizes + 4);
+
+    // Every column stores at least one byte per row
+    QByteArray payload = device->read(size);
+    char checksum[4];
+    if (rows > size || payload.size() != qsizetype(size) || !readFixed(device, checksum, sizeof(checksum))) {
+        lastError = "Export file is truncated";
+        return false;
+    }
+    if (qFromLittleEndian<quint32>(checksum) != crc32(payload.constData(), payload.size())) {
+        lastError = QString("Checksum mismatch in rows %1-%2").arg(totalRows + 1).arg(totalRows + rows);
+        return false;
+    }
+
+    const char *p = payload.constData();
+    const char *end = p + payload.size();
+    const int count = int(rows);
+    QVector<qint64> integers[ColumnCount];
+    QList<QString> strings[ColumnCount];
+
+    bool ok = decodeIntegers(p, end, count, integers[IdColumn]);
+    for (int column = KanjiColumn; ok && column <= ExampleMeaningColumn; ++column) {
+        ok = decodeStrings(p, end, count, strings[column]);
+    }
+    for (int column = DifficultyColumn; ok && column < ColumnCount; ++column) {
+        ok = decodeIntegers(p, end, count, integers[column]);
+    }
+    if (!ok || p != end) {
+        lastError = QString("Corrupt column data in rows %1-%2").arg(totalRows + 1).arg(totalRows + rows);
+        return false;
+    }
+
+    cards.reserve(count);
+    for (int row = 0; row < count; ++row) {
+        KanjiCard card;
+        card.id = int(integers[IdColumn][row]);
+        card.kanji = strings[KanjiColumn][row];
+        card.meaning = strings[MeaningColumn][row];
+        card.on_reading = strings[OnReadingColumn][row];
+        card.kun_reading = strings[KunReadingColumn][row];
+        card.example_word = strings[ExampleWordColumn][row];
+        card.example_reading = strings[ExampleReadingColumn][row];
+        card.example_meaning = strings[ExampleMeaningColumn][row];
+        card.difficulty_level = int(integers[DifficultyColumn][row]);
+        card.is_learned = integers[LearnedColumn][row] != 0;
+        card.last_reviewed = fromMSecs(integers[LastReviewedColumn][row]);
+        card.next_review = fromMSecs(integers[NextReviewColumn][row]);
+        card.srs_level = int(integers[SrsLevelColumn][row]);
+        card.review_count = int(integers[ReviewCountColumn][row]);
+        card.priority = integers[PriorityColumn][row];
+        cards.append(card);
+    }
+    if (jlptLevels) {
+        jlptLevels->reserve(count);
+        for (qint64 levels : integers[JlptLevelsColumn]) {
+            jlptLevels->append(int(levels));
+        }
+    }
+
+    totalRows += rows;
+    return true;
+}
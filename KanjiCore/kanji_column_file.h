@@ -0,0 +1,117 @@
+#ifndef KANJI_COLUMN_FILE_H
+#define KANJI_COLUMN_FILE_H
+
+// DLL Export/Import macros
+#ifdef _WIN32
+    #ifdef KANJICORE_EXPORTS
+        #define KANJICORE_API __declspec(dllexport)
+    #else
+        #define KANJICORE_API __declspec(dllimport)
+    #endif
+#else
+    #define KANJICORE_API
+#endif
+
+#include <QIODevice>
+#include <QByteArray>
+#include <QList>
+#include <QString>
+#include "kanji_database.h"
+
+// Card export file (.kcol), content and progress together. Layout:
+//
+//   header     "KCOL", u16 version, u16 column count
+//   row group  u32 row count, u32 payload size, payload, u32 CRC-32 of payload
+//   ...
+//   trailer    u32 0, u64 total rows
+//
+// All integers are little endian. A payload holds every column of its rows
+// one after another, each as u8 encoding, varint size, data. The writer picks
+// the smaller encoding per column and group: integers as zigzag varints,
+// plain or as differences from the previous row; strings as length-prefixed
+// UTF-8, plain or as a dictionary of distinct values plus varint indices.
+// Timestamps are milliseconds since the epoch, -1 for none.
+class KANJICORE_API KanjiColumnWriter
+{
+public:
+    static constexpr int DefaultRowGroupSize = 8192;
+
+    explicit KanjiColumnWriter(QIODevice *device, int rowGroupSize = DefaultRowGroupSize);
+
+    bool begin();
+    // jlptLevels: bit n set for membership of the JLPT Nn deck
+    bool append(const KanjiCard &card, int jlptLevels = 0);
+    bool finish(); // Writes the last group and the trailer
+
+    qint64 rowCount() const { return totalRows; }
+    QString getLastError() const { return lastError; }
+
+private:
+    bool writeRowGroup();
+
+    QIODevice *device;
+    int rowGroupSize;
+    QList<KanjiCard> cards;
+    QList<int> levels;
+    qint64 totalRows;
+    QString lastError;
+};
+
+// Reads a .kcol file one row group at a time, checking each group's CRC
+class KANJICORE_API KanjiColumnReader
+{
+public:
+    explicit KanjiColumnReader(QIODevice *device);
+
+    bool open(); // Reads and checks the header
+
+    // False at the end of the file or on error; getLastError() tells them apart
+    bool readRowGroup(QList<KanjiCard> &cards, QList<int> *jlptLevels = nullptr);
+
+    bool atEnd() const { return reachedEnd; }
+    qint64 rowCount() const { return totalRows; }
+    QString getLastError() const { return lastError; }
+
+private:
+    QIODevice *device;
+    bool reachedEnd;
+    qint64 totalRows;
+    QString lastError;
+};
+
+// Shared by the writer and reader
+namespace KanjiColumnFormat {
+    constexpr char Magic[4] = {'K', 'C', 'O', 'L'};
+    constexpr quint16 Version = 1;
+
+    enum Column : quint16 {
+        IdColumn,
+        KanjiColumn,
+        MeaningColumn,
+        OnReadingColumn,
+        KunReadingColumn,
+        ExampleWordColumn,
+        ExampleReadingColumn,
+        ExampleMeaningColumn,
+        DifficultyColumn,
+        LearnedColumn,
+        LastReviewedColumn,
+        NextReviewColumn,
+        SrsLevelColumn,
+        ReviewCountColumn,
+        PriorityColumn,
+        JlptLevelsColumn,
+        ColumnCount
+    };
+
+    enum Encoding : quint8 {
+        PlainIntegers = 1,
+        DeltaIntegers = 2,
+        PlainStrings = 3,
+        DictionaryStrings = 4
+    };
+
+    KANJICORE_API quint32 crc32(const char *data, qsizetype size);
+}
+
+#endif // KANJI_COLUMN_FILE_H
@@ -1,36 +1,127 @@
 #include "kanji_database.h"
+#include "kanji_search_index.h"
+#include "kanji_reading_index.h"
+#include "kanji_change_notifier.h"
+#include "progress_write_buffer.h"
+#include "kanji_clock.h"
+#include "kanji_column_file.h"
 #include <QSqlDatabase>
 #include <QSqlQuery>
 #include <QSqlError>
+#include <QSqlRecord>
+#include <QSqlDriver>
 #include <QDateTime>
+#include <QStringList>
+#include <QFile>
+#include <QSaveFile>
+#include <QTextStream>
+#include <QUuid>
+#include <QThread>
 #include <QDebug>
+#include <limits>
 
-KanjiDatabase::KanjiDatabase()
+#ifdef KANJICORE_HAVE_SQLITE3
+#include <sqlite3.h>
+#else
+struct sqlite3;
+#endif
+
+static QString dataLocationOverride;
+static std::function<void(const QString &)> statementObserver;
+
+KanjiDatabase::KanjiDatabase(const QString &connectionName)
+    : connectionName(connectionName.isEmpty() ? QString(QSqlDatabase::defaultConnection) : connectionName),
+      searchIndex(nullptr), readingIndex(nullptr), changeNotifier(new KanjiChangeNotifier()),
+      activeDeckId(0), progressBuffer(nullptr)
 {
 }
 
 KanjiDatabase::~KanjiDatabase()
 {
+    if (!flushProgress()) {
+        qDebug() << "Progress left in the journal for the next start:" << lastError;
+    }
+    delete progressBuffer;
+    delete searchIndex;
+    delete readingIndex;
+    delete changeNotifier;
     if (db.isOpen()) {
         db.close();
     }
+    
+    // Drop the handle first so the name can be reused by the next instance
+    if (db.isValid()) {
+        db = QSqlDatabase();
+        QSqlDatabase::removeDatabase(connectionName);
+    }
+}
+
+void KanjiDatabase::setDataLocation(const QString &directory)
+{
+    dataLocationOverride = directory;
+}
+
+QString KanjiDatabase::dataLocation()
+{
+    return dataLocationOverride.isEmpty() ? QStandardPaths::writableLocation(QStandardPaths::AppDataLocation)
+                                          : dataLocationOverride;
+}
+
+void KanjiDatabase::setStatementObserver(const std::function<void(const QString &)> &observer)
+{
+    statementObserver = observer;
+}
+
+bool KanjiDatabase::prepareQuery(QSqlQuery &query, const QString &sql)
+{
+    if (statementObserver) {
+        statementObserver(sql);
+    }
+    return query.prepare(sql);
 }
 
 QString KanjiDatabase::getDatabasePath()
 {
-    QString dataPath = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    QString dataPath = dataLocation();
     QDir().mkpath(dataPath);
     return dataPath + "/kanji_learning.db";
 }
 
+bool KanjiDatabase::openConnection()
+{
+    db = QSqlDatabase::addDatabase("QSQLITE", connectionName);
+    db.setDatabaseName(getDatabasePath());
+    
+    if (!db.open()) {
+        lastError = "Cannot open database: " + db.lastError().text();
+        return false;
+    }
+    
+    // WAL lets a connection on another thread read while this one writes;
+    // busy_timeout makes the rare writer/writer overlap wait instead of failing
+    QSqlQuery pragma(db);
+    pragma.exec("PRAGMA journal_mode = WAL");
+    pragma.exec("PRAGMA synchronous = NORMAL");
+    pragma.exec("PRAGMA busy_timeout = 5000");
+    
+    return true;
+}
+
+bool KanjiDatabase::open()
+{
+    if (!openConnection()) {
+        return false;
+    }
+    
+    searchIndex = new KanjiSearchIndex(db);
+    searchIndex->attach();
+    return true;
+}
+
 bool KanjiDatabase::initialize()
 {
     try {
-        db = QSqlDatabase::addDatabase("QSQLITE");
-        db.setDatabaseName(getDatabasePath());
-        
-        if (!db.open()) {
-            lastError = "Cannot open database: " + db.lastError().text();
+        if (!openConnection()) {
             return false;
         }
         
@@ -38,16 +129,31 @@ bool KanjiDatabase::initialize()
             return false;
         }
         
+        // Answers journaled but never committed before the app last stopped
+        if (!replayProgressJournal()) {
+            return false;
+        }
+        
+        // Search index is optional - without FTS5 searchKanji falls back to LIKE
+        searchIndex = new KanjiSearchIndex(db);
+        searchIndex->initialize();
+        
         // Check if we need to populate the database
         QSqlQuery query(db);
-        query.prepare("SELECT COUNT(*) FROM kanji");
+        prepareQuery(query, "SELECT COUNT(*) FROM kanji");
         if (query.exec() && query.next()) {
             int count = query.value(0).toInt();
-            if (count == 0) {
-                return populateN5Kanji();
+            if (count == 0 && !populateN5Kanji()) {
+                return false;
             }
         }
         
+        // Databases created before decks existed only hold N5
+        prepareQuery(query, "SELECT card_count FROM decks WHERE jlpt_level = 4");
+        if (query.exec() && query.next() && query.value(0).toInt() == 0) {
+            return populateN4Kanji();
+        }
+        
         return true;
     }
     catch (const std::exception& e) {
@@ -79,7 +185,8 @@ bool KanjiDatabase::createTables()
             last_reviewed DATETIME,
             next_review DATETIME,
             srs_level INTEGER DEFAULT 1,
-            review_count INTEGER DEFAULT 0
+            review_count INTEGER DEFAULT 0,
+            priority INTEGER DEFAULT 0
         )
     )";
     
@@ -91,9 +198,225 @@ bool KanjiDatabase::createTables()
     QString addSrsLevelColumn = "ALTER TABLE kanji ADD COLUMN srs_level INTEGER DEFAULT 1";
     executeQuery(addSrsLevelColumn); // Don't check result - column might already exist
     
+    // Add priority column (corpus frequency, higher = study sooner) for existing databases
+    QString addPriorityColumn = "ALTER TABLE kanji ADD COLUMN priority INTEGER DEFAULT 0";
+    executeQuery(addPriorityColumn); // Don't check result - column might already exist
+    
+    // Lets getNewKanji walk unlearned kanji in priority order without sorting
+    QString createPriorityIndex = "CREATE INDEX IF NOT EXISTS idx_kanji_new_priority ON kanji(is_learned, priority DESC, id)";
+    if (!executeQuery(createPriorityIndex)) {
+        return false;
+    }
+    
+    // Review queue and due counts filter on is_learned and next_review
+    QString createReviewIndex = "CREATE INDEX IF NOT EXISTS idx_kanji_review ON kanji(is_learned, next_review)";
+    if (!executeQuery(createReviewIndex)) {
+        return false;
+    }
+    
+    // Deck browser sort orders; kanji and id are already indexed
+    const QStringList browseIndexes = {
+        "CREATE INDEX IF NOT EXISTS idx_kanji_srs_level ON kanji(srs_level, id)",
+        "CREATE INDEX IF NOT EXISTS idx_kanji_next_review ON kanji(next_review, id)",
+        "CREATE INDEX IF NOT EXISTS idx_kanji_priority ON kanji(priority, id)"
+    };
+    for (const QString &createIndex : browseIndexes) {
+        if (!executeQuery(createIndex)) {
+            return false;
+        }
+    }
+    
+    return createDeckTables() && createSyncTables() && createReviewLogTable();
+}
+
+bool KanjiDatabase::createDeckTables()
+{
+    QSqlQuery query(db);
+    prepareQuery(query, "SELECT COUNT(*) FROM sqlite_master WHERE type = 'table' AND name = 'decks'");
+    bool hadDecks = query.exec() && query.next() && query.value(0).toInt() > 0;
+    
+    QString createDecksTable = R"(
+        CREATE TABLE IF NOT EXISTS decks (
+            id INTEGER PRIMARY KEY AUTOINCREMENT,
+            name TEXT NOT NULL UNIQUE,
+            jlpt_level INTEGER,
+            card_count INTEGER NOT NULL DEFAULT 0,
+            learned_count INTEGER NOT NULL DEFAULT 0
+        )
+    )";
+    
+    // Keyed deck first so deck-scoped queries walk only that deck's cards
+    QString createMembershipTable = R"(
+        CREATE TABLE IF NOT EXISTS kanji_decks (
+            deck_id INTEGER NOT NULL,
+            kanji_id INTEGER NOT NULL,
+            PRIMARY KEY (deck_id, kanji_id)
+        ) WITHOUT ROWID
+    )";
+    
+    // Per-deck counters follow membership and is_learned changes, so switching
+    // decks reads one row instead of aggregating the kanji table
+    const QStringList statements = {
+        createDecksTable,
+        createMembershipTable,
+        "CREATE INDEX IF NOT EXISTS idx_kanji_decks_kanji ON kanji_decks(kanji_id, deck_id)",
+        R"(
+            CREATE TRIGGER IF NOT EXISTS kanji_decks_insert AFTER INSERT ON kanji_decks BEGIN
+                UPDATE decks SET
+                    card_count = card_count + 1,
+                    learned_count = learned_count +
+                        COALESCE((SELECT is_learned = TRUE FROM kanji WHERE id = NEW.kanji_id), 0)
+                WHERE id = NEW.deck_id;
+            END
+        )",
+        R"(
+            CREATE TRIGGER IF NOT EXISTS kanji_decks_delete AFTER DELETE ON kanji_decks BEGIN
+                UPDATE decks SET
+                    card_count = card_count - 1,
+                    learned_count = learned_count -
+                        COALESCE((SELECT is_learned = TRUE FROM kanji WHERE id = OLD.kanji_id), 0)
+                WHERE id = OLD.deck_id;
+            END
+        )",
+        R"(
+            CREATE TRIGGER IF NOT EXISTS kanji_decks_learned AFTER UPDATE OF is_learned ON kanji
+            WHEN OLD.is_learned IS NOT NEW.is_learned BEGIN
+                UPDATE decks SET
+                    learned_count = learned_count + CASE WHEN NEW.is_learned = TRUE THEN 1 ELSE -1 END
+                WHERE id IN (SELECT deck_id FROM kanji_decks WHERE kanji_id = NEW.id);
+            END
+        )",
+        R"(
+            CREATE TRIGGER IF NOT EXISTS kanji_decks_card_delete BEFORE DELETE ON kanji BEGIN
+                DELETE FROM kanji_decks WHERE kanji_id = OLD.id;
+            END
+        )",
+        R"(
+            INSERT OR IGNORE INTO decks (name, jlpt_level) VALUES
+                ('JLPT N5', 5), ('JLPT N4', 4), ('JLPT N3', 3), ('JLPT N2', 2), ('JLPT N1', 1)
+        )"
+    };
+    for (const QString &statement : statements) {
+        if (!executeQuery(statement)) {
+            return false;
+        }
+    }
+    
+    // Every card in a database from before decks came from the N5 seed
+    if (!hadDecks) {
+        QString migrate = R"(
+            INSERT OR IGNORE INTO kanji_decks (deck_id, kanji_id)
+            SELECT decks.id, kanji.id FROM kanji, decks WHERE decks.jlpt_level = 5
+        )";
+        if (!executeQuery(migrate)) {
+            return false;
+        }
+    }
+    
+    return true;
+}
+
+bool KanjiDatabase::createSyncTables()
+{
+    QSqlQuery query(db);
+    prepareQuery(query, "SELECT COUNT(*) FROM sqlite_master WHERE type = 'table' AND name = 'progress_changelog'");
+    bool hadChangelog = query.exec() && query.next() && query.value(0).toInt() > 0;
+    
+    // One row per card holding the sequence of its latest progress change, so
+    // "changed since N" is an index range and repeated answers don't grow the log.
+    // Sequence numbers come from a counter in sync_state that never goes back;
+    // rows written by applyProgressChanges are marked imported rather than removed.
+    const QStringList statements = {
+        "CREATE TABLE IF NOT EXISTS sync_state (key TEXT PRIMARY KEY, value TEXT)",
+        R"(
+            CREATE TABLE IF NOT EXISTS progress_changelog (
+                kanji_id INTEGER PRIMARY KEY,
+                seq INTEGER NOT NULL,
+                imported INTEGER NOT NULL DEFAULT 0
+            )
+        )",
+        "CREATE INDEX IF NOT EXISTS idx_progress_changelog_seq ON progress_changelog(seq)",
+        // Synced progress for cards this database doesn't have yet
+        R"(
+            CREATE TABLE IF NOT EXISTS pending_progress (
+                kanji TEXT PRIMARY KEY,
+                is_learned BOOLEAN NOT NULL,
+                srs_level INTEGER NOT NULL,
+                review_count INTEGER NOT NULL,
+                last_reviewed DATETIME,
+                next_review DATETIME
+            )
+        )"
+    };
+    for (const QString &statement : statements) {
+        if (!executeQuery(statement)) {
+            return false;
+        }
+    }
+    
+    // Add imported column for databases from before it existed
+    executeQuery("ALTER TABLE progress_changelog ADD COLUMN imported INTEGER NOT NULL DEFAULT 0"); // Don't check result - column might already exist
+    
+    // Progress made before tracking existed goes out with the first export
+    if (!hadChangelog) {
+        QString baseline = R"(
+            INSERT INTO progress_changelog (kanji_id, seq)
+            SELECT id, ROW_NUMBER() OVER (ORDER BY id) FROM kanji
+            WHERE is_learned = TRUE OR review_count > 0
+        )";
+        if (!executeQuery(baseline)) {
+            return false;
+        }
+    }
+    
+    // The counter starts above every sequence already used or exported. The
+    // trigger is recreated so databases with the old MAX(seq) + 1 one switch over.
+    const QStringList counter = {
+        R"(
+            INSERT OR IGNORE INTO sync_state (key, value)
+            SELECT 'progress_seq', MAX(
+                COALESCE((SELECT MAX(seq) FROM progress_changelog), 0),
+                COALESCE((SELECT CAST(value AS INTEGER) FROM sync_state WHERE key = 'exported_seq'), 0))
+        )",
+        "DROP TRIGGER IF EXISTS progress_changelog_update",
+        R"(
+            CREATE TRIGGER progress_changelog_update
+            AFTER UPDATE OF is_learned, srs_level, review_count, last_reviewed, next_review ON kanji BEGIN
+                UPDATE sync_state SET value = CAST(value AS INTEGER) + 1 WHERE key = 'progress_seq';
+                INSERT OR REPLACE INTO progress_changelog (kanji_id, seq, imported)
+                VALUES (NEW.id, (SELECT CAST(value AS INTEGER) FROM sync_state WHERE key = 'progress_seq'), 0);
+            END
+        )"
+    };
+    for (const QString &statement : counter) {
+        if (!executeQuery(statement)) {
+            return false;
+        }
+    }
+    
     return true;
 }
 
+bool KanjiDatabase::createReviewLogTable()
+{
+    // Append-only, one row per answer. Times are stored as integers and the
+    // local hour alongside, so analytics reads plain columns without parsing
+    // dates; readers page on the rowid, so no other index is needed.
+    QString createReviewLog = R"(
+        CREATE TABLE IF NOT EXISTS review_log (
+            id INTEGER PRIMARY KEY,
+            kanji_id INTEGER NOT NULL,
+            reviewed_at INTEGER NOT NULL,
+            hour_of_day INTEGER NOT NULL,
+            correct INTEGER NOT NULL,
+            srs_level INTEGER NOT NULL,
+            difficulty_level INTEGER NOT NULL,
+            elapsed_seconds INTEGER NOT NULL
+        )
+    )";
+    return executeQuery(createReviewLog);
+}
+
 bool KanjiDatabase::populateN5Kanji()
 {
     // N5 level kanji with meanings and readings
@@ -206,288 +529,1587 @@ bool KanjiDatabase::populateN5Kanji()
         {"古", "old", "こ", "ふる", "古い", "ふるい", "old", 2}
     };
     
-    QString insertQuery = R"(
-        INSERT INTO kanji (kanji, meaning, on_reading, kun_reading, example_word, 
-                          example_reading, example_meaning, difficulty_level)
+    return seedDeck(5, kanjiData);
+}
+
+bool KanjiDatabase::populateN4Kanji()
+{
+    // Starter set for N4; the full list can be loaded with importKanjiFile
+    QList<QVariantList> kanjiData = {
+        // People and society
+        {"会", "meet/meeting", "かい", "あ", "会社", "かいしゃ", "company", 2},
+        {"社", "company/shrine", "しゃ", "やしろ", "会社", "かいしゃ", "company", 2},
+        {"員", "member", "いん", "", "店員", "てんいん", "store clerk", 2},
+        {"者", "person", "しゃ", "もの", "医者", "いしゃ", "doctor", 3},
+        {"自", "oneself", "じ", "みずか", "自分", "じぶん", "oneself", 2},
+        {"親", "parent", "しん", "おや", "両親", "りょうしん", "parents", 3},
+        {"兄", "older brother", "きょう", "あに", "兄弟", "きょうだい", "siblings", 2},
+        {"弟", "younger brother", "だい", "おとうと", "兄弟", "きょうだい", "siblings", 2},
+        {"姉", "older sister", "し", "あね", "姉妹", "しまい", "sisters", 2},
+        {"妹", "younger sister", "まい", "いもうと", "姉妹", "しまい", "sisters", 2},
+        
+        // Time and seasons
+        {"朝", "morning", "ちょう", "あさ", "毎朝", "まいあさ", "every morning", 2},
+        {"昼", "noon/daytime", "ちゅう", "ひる", "昼ご飯", "ひるごはん", "lunch", 2},
+        {"夕", "evening", "せき", "ゆう", "夕方", "ゆうがた", "evening", 2},
+        {"夜", "night", "や", "よる", "今夜", "こんや", "tonight", 2},
+        {"春", "spring", "しゅん", "はる", "春休み", "はるやすみ", "spring break", 2},
+        {"夏", "summer", "か", "なつ", "夏休み", "なつやすみ", "summer vacation", 2},
+        {"秋", "autumn", "しゅう", "あき", "秋分", "しゅうぶん", "autumnal equinox", 2},
+        {"冬", "winter", "とう", "ふゆ", "冬休み", "ふゆやすみ", "winter break", 2},
+        {"早", "early/fast", "そう", "はや", "早い", "はやい", "early", 2},
+        
+        // Actions
+        {"歩", "walk", "ほ", "ある", "歩く", "あるく", "to walk", 2},
+        {"走", "run", "そう", "はし", "走る", "はしる", "to run", 2},
+        {"待", "wait", "たい", "ま", "待つ", "まつ", "to wait", 2},
+        {"送", "send", "そう", "おく", "送る", "おくる", "to send", 2},
+        {"持", "hold/have", "じ", "も", "持つ", "もつ", "to hold", 2},
+        {"思", "think", "し", "おも", "思う", "おもう", "to think", 2},
+        {"考", "consider", "こう", "かんが", "考える", "かんがえる", "to consider", 3},
+        {"知", "know", "ち", "し", "知る", "しる", "to know", 2},
+        {"言", "say", "げん", "い", "言う", "いう", "to say", 2},
+        {"教", "teach", "きょう", "おし", "教える", "おしえる", "to teach", 2},
+        {"習", "learn", "しゅう", "なら", "習う", "ならう", "to learn", 2},
+        {"始", "begin", "し", "はじ", "始まる", "はじまる", "to begin", 2},
+        {"終", "end", "しゅう", "お", "終わる", "おわる", "to end", 2},
+        {"使", "use", "し", "つか", "使う", "つかう", "to use", 2},
+        {"作", "make", "さく", "つく", "作る", "つくる", "to make", 2},
+        {"借", "borrow", "しゃく", "か", "借りる", "かりる", "to borrow", 3},
+        {"貸", "lend", "たい", "か", "貸す", "かす", "to lend", 3},
+        {"売", "sell", "ばい", "う", "売る", "うる", "to sell", 2},
+        {"開", "open", "かい", "あ", "開ける", "あける", "to open", 2},
+        {"動", "move", "どう", "うご", "動く", "うごく", "to move", 2},
+        
+        // Places
+        {"場", "place", "じょう", "ば", "場所", "ばしょ", "place", 2},
+        {"地", "ground", "ち", "", "地図", "ちず", "map", 2},
+        {"町", "town", "ちょう", "まち", "町長", "ちょうちょう", "mayor", 2},
+        {"村", "village", "そん", "むら", "村長", "そんちょう", "village head", 2},
+        {"駅", "station", "えき", "", "駅前", "えきまえ", "in front of the station", 2},
+        {"病", "illness", "びょう", "やまい", "病気", "びょうき", "illness", 3},
+        {"院", "institution", "いん", "", "病院", "びょういん", "hospital", 3},
+        {"医", "medicine", "い", "", "医者", "いしゃ", "doctor", 3},
+        {"館", "building/hall", "かん", "やかた", "図書館", "としょかん", "library", 3},
+        {"図", "drawing/map", "ず", "はか", "地図", "ちず", "map", 3},
+        
+        // Descriptions and things
+        {"同", "same", "どう", "おな", "同じ", "おなじ", "same", 2},
+        {"明", "bright", "めい", "あか", "明るい", "あかるい", "bright", 2},
+        {"近", "near", "きん", "ちか", "近い", "ちかい", "near", 2},
+        {"遠", "far", "えん", "とお", "遠い", "とおい", "far", 2},
+        {"重", "heavy", "じゅう", "おも", "重い", "おもい", "heavy", 3},
+        {"軽", "light (weight)", "けい", "かる", "軽い", "かるい", "light", 3},
+        {"強", "strong", "きょう", "つよ", "強い", "つよい", "strong", 2},
+        {"弱", "weak", "じゃく", "よわ", "弱い", "よわい", "weak", 2},
+        {"物", "thing", "ぶつ", "もの", "動物", "どうぶつ", "animal", 2},
+        {"事", "matter/thing", "じ", "こと", "仕事", "しごと", "job", 2},
+        {"問", "question", "もん", "と", "問題", "もんだい", "problem", 2},
+        {"字", "character", "じ", "あざ", "漢字", "かんじ", "kanji", 2},
+        {"音", "sound", "おん", "おと", "音楽", "おんがく", "music", 2},
+        {"楽", "fun/music", "がく", "たの", "楽しい", "たのしい", "fun", 2},
+        {"色", "color", "しょく", "いろ", "色々", "いろいろ", "various", 2},
+        {"写", "copy/photograph", "しゃ", "うつ", "写真", "しゃしん", "photograph", 2},
+        {"映", "reflect/project", "えい", "うつ", "映画", "えいが", "movie", 3},
+        {"画", "picture", "が", "", "映画", "えいが", "movie", 3}
+    };
+    
+    return seedDeck(4, kanjiData);
+}
+
+bool KanjiDatabase::seedDeck(int jlptLevel, const QList<QVariantList> &kanjiData)
+{
+    int deckId = deckIdForLevel(jlptLevel);
+    if (deckId == 0) {
+        lastError = QString("No deck for JLPT N%1").arg(jlptLevel);
+        return false;
+    }
+    
+    if (!db.transaction()) {
+        lastError = "Failed to start transaction: " + db.lastError().text();
+        return false;
+    }
+    
+    // Cards already in the table (from another deck or an import) keep their progress
+    QSqlQuery insert(db);
+    prepareQuery(insert, R"(
+        INSERT OR IGNORE INTO kanji (kanji, meaning, on_reading, kun_reading, example_word, 
+                                     example_reading, example_meaning, difficulty_level)
         VALUES (?, ?, ?, ?, ?, ?, ?, ?)
-    )";
+    )");
     
-    QSqlQuery query(db);
-    query.prepare(insertQuery);
+    QSqlQuery addToDeck(db);
+    prepareQuery(addToDeck, "INSERT OR IGNORE INTO kanji_decks (deck_id, kanji_id) SELECT ?, id FROM kanji WHERE kanji = ?");
     
+    QList<KanjiCard> imported;
+    int addedToDeck = 0;
     for (const auto& data : kanjiData) {
         for (int i = 0; i < data.size(); ++i) {
-            query.addBindValue(data[i]);
+            insert.addBindValue(data[i]);
         }
         
-        if (!query.exec()) {
-            lastError = "Failed to insert kanji: " + query.lastError().text();
+        if (!insert.exec()) {
+            lastError = "Failed to insert kanji: " + insert.lastError().text();
+            db.rollback();
+            return false;
+        }
+        
+        if (insert.numRowsAffected() > 0) {
+            KanjiCard card;
+            card.id = insert.lastInsertId().toInt();
+            card.on_reading = data[2].toString();
+            card.kun_reading = data[3].toString();
+            card.example_reading = data[5].toString();
+            imported.append(card);
+        }
+        
+        addToDeck.addBindValue(deckId);
+        addToDeck.addBindValue(data[0]);
+        if (!addToDeck.exec()) {
+            lastError = "Failed to add kanji to deck: " + addToDeck.lastError().text();
+            db.rollback();
             return false;
         }
+        addedToDeck += addToDeck.numRowsAffected();
+    }
+    
+    if (!db.commit()) {
+        lastError = "Failed to commit kanji: " + db.lastError().text();
+        return false;
+    }
+    
+    // Keep an already built reading index current without rescanning the table
+    if (readingIndex) {
+        readingIndex->addCards(imported);
+    }
+    
+    // Seeded cards are all new; which of them count depends on the active deck
+    int added = imported.size();
+    if (activeDeckId == deckId) {
+        added = addedToDeck;
+    } else if (activeDeckId != 0) {
+        added = 0;
+    }
+    
+    if (added > 0) {
+        KanjiChangeSet change;
+        change.kinds = KanjiChangeSet::CardsImported;
+        change.totalDelta = added;
+        change.newDelta = added;
+        changeNotifier->post(change);
+    }
+    
+    if (!imported.isEmpty() && !applyPendingProgress()) {
+        qDebug() << "Synced progress left pending:" << lastError;
     }
     
     return true;
 }
 
-bool KanjiDatabase::executeQuery(const QString &queryString, const QVariantList &values)
+bool KanjiDatabase::importKanjiFile(const QString &path, int *importedCount)
 {
-    QSqlQuery query(db);
-    query.prepare(queryString);
+    // Tab separated: kanji, meaning, on'yomi, kun'yomi, example word, example reading,
+    // example meaning, difficulty (1-5), JLPT level (1-5). Only the first two are required;
+    // lines starting with # are comments. Existing cards are updated, progress kept.
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        lastError = QString("Cannot open %1: %2").arg(path, file.errorString());
+        return false;
+    }
     
-    for (const auto& value : values) {
-        query.addBindValue(value);
+    QHash<int, int> deckIds;
+    for (int level = 1; level <= 5; ++level) {
+        deckIds.insert(level, deckIdForLevel(level));
     }
     
-    if (!query.exec()) {
-        lastError = query.lastError().text();
+    QVariantList columns[8];
+    QVariantList memberDecks;
+    QVariantList memberKanji;
+    int lineNumber = 0;
+    
+    QTextStream in(&file);
+    in.setEncoding(QStringConverter::Utf8);
+    while (!in.atEnd()) {
+        QString line = in.readLine();
+        ++lineNumber;
+        if (line.trimmed().isEmpty() || line.startsWith('#')) {
+            continue;
+        }
+        
+        QStringList fields = line.split('\t');
+        if (fields.size() < 2 || fields[0].trimmed().isEmpty()) {
+            lastError = QString("%1:%2: expected at least kanji and meaning").arg(path).arg(lineNumber);
+            return false;
+        }
+        
+        for (int i = 0; i < 7; ++i) {
+            columns[i].append(i < fields.size() ? fields[i].trimmed() : QString());
+        }
+        columns[7].append(fields.size() > 7 ? qBound(1, fields[7].toInt(), 5) : 1);
+        
+        int deckId = fields.size() > 8 ? deckIds.value(fields[8].trimmed().toInt()) : 0;
+        if (deckId != 0) {
+            memberDecks.append(deckId);
+            memberKanji.append(columns[0].last());
+        }
+    }
+    
+    if (columns[0].isEmpty()) {
+        lastError = QString("No kanji found in %1").arg(path);
+        return false;
+    }
+    
+    // Bulk write - capture scoped counts so listeners get exact deltas
+    int totalBefore = getTotalKanjiCount();
+    int learnedBefore = getLearnedKanjiCount();
+    int newBefore = getNewKanjiCount();
+    int dueBefore = getReviewDueCount();
+    
+    if (!db.transaction()) {
+        lastError = "Failed to start transaction: " + db.lastError().text();
         return false;
     }
     
-    return true;
-}
-
-QList<KanjiCard> KanjiDatabase::getNewKanji(int limit)
-{
-    QList<KanjiCard> cards;
     QSqlQuery query(db);
-    query.prepare("SELECT * FROM kanji WHERE is_learned = FALSE LIMIT ?");
-    query.addBindValue(limit);
+    prepareQuery(query, R"(
+        INSERT INTO kanji (kanji, meaning, on_reading, kun_reading, example_word,
+                           example_reading, example_meaning, difficulty_level)
+        VALUES (?, ?, ?, ?, ?, ?, ?, ?)
+        ON CONFLICT(kanji) DO UPDATE SET
+            meaning = excluded.meaning,
+            on_reading = excluded.on_reading,
+            kun_reading = excluded.kun_reading,
+            example_word = excluded.example_word,
+            example_reading = excluded.example_reading,
+            example_meaning = excluded.example_meaning,
+            difficulty_level = excluded.difficulty_level
+    )");
+    for (const QVariantList &column : columns) {
+        query.addBindValue(column);
+    }
+    if (!query.execBatch()) {
+        lastError = "Failed to import kanji: " + query.lastError().text();
+        db.rollback();
+        return false;
+    }
     
-    if (query.exec()) {
-        while (query.next()) {
-            KanjiCard card;
-            card.id = query.value("id").toInt();
-            card.kanji = query.value("kanji").toString();
-            card.meaning = query.value("meaning").toString();
-            card.on_reading = query.value("on_reading").toString();
-            card.kun_reading = query.value("kun_reading").toString();
-            card.example_word = query.value("example_word").toString();
-            card.example_reading = query.value("example_reading").toString();
-            card.example_meaning = query.value("example_meaning").toString();
-            card.difficulty_level = query.value("difficulty_level").toInt();
-            card.is_learned = query.value("is_learned").toBool();
-            card.srs_level = query.value("srs_level").toInt();
-            card.review_count = query.value("review_count").toInt();
-            cards.append(card);
+    if (!memberDecks.isEmpty()) {
+        prepareQuery(query, "INSERT OR IGNORE INTO kanji_decks (deck_id, kanji_id) SELECT ?, id FROM kanji WHERE kanji = ?");
+        query.addBindValue(memberDecks);
+        query.addBindValue(memberKanji);
+        if (!query.execBatch()) {
+            lastError = "Failed to add kanji to decks: " + query.lastError().text();
+            db.rollback();
+            return false;
         }
     }
     
-    return cards;
+    if (!db.commit()) {
+        lastError = "Failed to commit import: " + db.lastError().text();
+        return false;
+    }
+    
+    // Readings of existing cards may have changed; rebuild on the next lookup
+    delete readingIndex;
+    readingIndex = nullptr;
+    
+    if (importedCount) {
+        *importedCount = columns[0].size();
+    }
+    
+    KanjiChangeSet change;
+    change.kinds = KanjiChangeSet::CardsImported;
+    change.totalDelta = getTotalKanjiCount() - totalBefore;
+    change.learnedDelta = getLearnedKanjiCount() - learnedBefore;
+    change.newDelta = getNewKanjiCount() - newBefore;
+    change.reviewDueDelta = getReviewDueCount() - dueBefore;
+    changeNotifier->post(change);
+    
+    if (!applyPendingProgress()) {
+        qDebug() << "Synced progress left pending:" << lastError;
+    }
+    
+    return true;
 }
 
-QList<KanjiCard> KanjiDatabase::getReviewKanji()
+bool KanjiDatabase::exportCards(const QString &path, int *exportedCount)
 {
-    QList<KanjiCard> cards;
-    QSqlQuery query(db);
-    QDateTime now = QDateTime::currentDateTime();
-    query.prepare("SELECT * FROM kanji WHERE is_learned = TRUE AND next_review <= ? ORDER BY next_review");
-    query.addBindValue(now);
+    flushProgress();
     
-    qDebug() << "getReviewKanji: Current time is" << now.toString();
-    qDebug() << "getReviewKanji: Looking for learned kanji with next_review <=" << now.toString();
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        lastError = QString("Cannot create %1: %2").arg(path, file.errorString());
+        return false;
+    }
     
-    if (query.exec()) {
-        while (query.next()) {
-            KanjiCard card;
-            card.id = query.value("id").toInt();
-            card.kanji = query.value("kanji").toString();
-            card.meaning = query.value("meaning").toString();
-            card.on_reading = query.value("on_reading").toString();
-            card.kun_reading = query.value("kun_reading").toString();
-            card.example_word = query.value("example_word").toString();
-            card.example_reading = query.value("example_reading").toString();
-            card.example_meaning = query.value("example_meaning").toString();
-            card.difficulty_level = query.value("difficulty_level").toInt();
-            card.is_learned = query.value("is_learned").toBool();
-            card.last_reviewed = query.value("last_reviewed").toDateTime();
-            card.next_review = query.value("next_review").toDateTime();
-            card.srs_level = query.value("srs_level").toInt();
-            card.review_count = query.value("review_count").toInt();
-            cards.append(card);
-            
-            qDebug() << "getReviewKanji: Found kanji" << card.kanji 
-                     << "level" << card.srs_level 
-                     << "next_review" << card.next_review.toString()
-                     << "is_learned" << card.is_learned;
+    KanjiColumnWriter writer(&file);
+    if (!writer.begin()) {
+        lastError = writer.getLastError();
+        return false;
+    }
+    
+    // Positional columns: by-name lookups cost more than the encoding at 100k rows
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+    prepareQuery(query, R"(
+        SELECT id, kanji, meaning, on_reading, kun_reading, example_word, example_reading,
+               example_meaning, difficulty_level, is_learned, last_reviewed, next_review,
+               srs_level, review_count, priority,
+               (SELECT COALESCE(SUM(1 << decks.jlpt_level), 0) FROM kanji_decks
+                JOIN decks ON decks.id = kanji_decks.deck_id
+                WHERE kanji_decks.kanji_id = kanji.id)
+        FROM kanji ORDER BY id
+    )");
+    if (!query.exec()) {
+        lastError = "Failed to read kanji: " + query.lastError().text();
+        return false;
+    }
+    
+    while (query.next()) {
+        KanjiCard card;
+        card.id = query.value(0).toInt();
+        card.kanji = query.value(1).toString();
+        card.meaning = query.value(2).toString();
+        card.on_reading = query.value(3).toString();
+        card.kun_reading = query.value(4).toString();
+        card.example_word = query.value(5).toString();
+        card.example_reading = query.value(6).toString();
+        card.example_meaning = query.value(7).toString();
+        card.difficulty_level = query.value(8).toInt();
+        card.is_learned = query.value(9).toBool();
+        card.last_reviewed = query.value(10).toDateTime();
+        card.next_review = query.value(11).toDateTime();
+        card.srs_level = query.value(12).toInt();
+        card.review_count = query.value(13).toInt();
+        card.priority = query.value(14).toLongLong();
+        
+        if (!writer.append(card, query.value(15).toInt())) {
+            lastError = writer.getLastError();
+            return false;
         }
     }
     
-    qDebug() << "getReviewKanji: Returning" << cards.size() << "kanji for review";
-    return cards;
+    if (!writer.finish() || !file.commit()) {
+        lastError = writer.getLastError().isEmpty() ? "Cannot write " + path + ": " + file.errorString()
+                                                    : writer.getLastError();
+        return false;
+    }
+    
+    if (exportedCount) {
+        *exportedCount = int(writer.rowCount());
+    }
+    return true;
 }
 
-int KanjiDatabase::getTotalKanjiCount()
+bool KanjiDatabase::importCards(const QString &path, int *importedCount)
 {
-    QSqlQuery query(db);
-    query.prepare("SELECT COUNT(*) FROM kanji");
-    if (query.exec() && query.next()) {
-        return query.value(0).toInt();
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        lastError = QString("Cannot open %1: %2").arg(path, file.errorString());
+        return false;
+    }
+    
+    KanjiColumnReader reader(&file);
+    if (!reader.open()) {
+        lastError = reader.getLastError();
+        return false;
+    }
+    
+    // Pending answers would otherwise be flushed over the imported progress
+    if (!flushProgress()) {
+        return false;
+    }
+    
+    QHash<int, int> deckIds;
+    for (int level = 1; level <= 5; ++level) {
+        deckIds.insert(level, deckIdForLevel(level));
+    }
+    
+    // Bulk write - capture scoped counts so listeners get exact deltas
+    int totalBefore = getTotalKanjiCount();
+    int learnedBefore = getLearnedKanjiCount();
+    int newBefore = getNewKanjiCount();
+    int dueBefore = getReviewDueCount();
+    
+    if (!db.transaction()) {
+        lastError = "Failed to start transaction: " + db.lastError().text();
+        return false;
+    }
+    
+    QSqlQuery upsert(db);
+    prepareQuery(upsert, R"(
+        INSERT INTO kanji (kanji, meaning, on_reading, kun_reading, example_word, example_reading,
+                           example_meaning, difficulty_level, is_learned, last_reviewed, next_review,
+                           srs_level, review_count, priority)
+        VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)
+        ON CONFLICT(kanji) DO UPDATE SET
+            meaning = excluded.meaning,
+            on_reading = excluded.on_reading,
+            kun_reading = excluded.kun_reading,
+            example_word = excluded.example_word,
+            example_reading = excluded.example_reading,
+            example_meaning = excluded.example_meaning,
+            difficulty_level = excluded.difficulty_level,
+            is_learned = excluded.is_learned,
+            last_reviewed = excluded.last_reviewed,
+            next_review = excluded.next_review,
+            srs_level = excluded.srs_level,
+            review_count = excluded.review_count,
+            priority = excluded.priority
+    )");
+    QSqlQuery member(db);
+    prepareQuery(member, "INSERT OR IGNORE INTO kanji_decks (deck_id, kanji_id) SELECT ?, id FROM kanji WHERE kanji = ?");
+    
+    // One batch per row group; ids in the file are ignored since cards match by kanji
+    QList<KanjiCard> cards;
+    QList<int> levels;
+    while (reader.readRowGroup(cards, &levels)) {
+        QVariantList columns[14];
+        QVariantList memberDecks;
+        QVariantList memberKanji;
+        for (QVariantList &column : columns) {
+            column.reserve(cards.size());
+        }
+        
+        for (int row = 0; row < cards.size(); ++row) {
+            const KanjiCard &card = cards.at(row);
+            columns[0].append(card.kanji);
+            columns[1].append(card.meaning);
+            columns[2].append(card.on_reading);
+            columns[3].append(card.kun_reading);
+            columns[4].append(card.example_word);
+            columns[5].append(card.example_reading);
+            columns[6].append(card.example_meaning);
+            columns[7].append(card.difficulty_level);
+            columns[8].append(card.is_learned);
+            columns[9].append(card.last_reviewed.isValid() ? QVariant(card.last_reviewed) : QVariant());
+            columns[10].append(card.next_review.isValid() ? QVariant(card.next_review) : QVariant());
+            columns[11].append(card.srs_level);
+            columns[12].append(card.review_count);
+            columns[13].append(card.priority);
+            
+            for (int level = 1; level <= 5; ++level) {
+                if ((levels.at(row) & (1 << level)) && deckIds.value(level) != 0) {
+                    memberDecks.append(deckIds.value(level));
+                    memberKanji.append(card.kanji);
+                }
+            }
+        }
+        
+        for (const QVariantList &column : columns) {
+            upsert.addBindValue(column);
+        }
+        if (!upsert.execBatch()) {
+            lastError = "Failed to import kanji: " + upsert.lastError().text();
+            db.rollback();
+            return false;
+        }
+        
+        if (!memberDecks.isEmpty()) {
+            member.addBindValue(memberDecks);
+            member.addBindValue(memberKanji);
+            if (!member.execBatch()) {
+                lastError = "Failed to add kanji to decks: " + member.lastError().text();
+                db.rollback();
+                return false;
+            }
+        }
+    }
+    
+    if (!reader.atEnd()) {
+        lastError = path + ": " + reader.getLastError();
+        db.rollback();
+        return false;
+    }
+    
+    if (!db.commit()) {
+        lastError = "Failed to commit import: " + db.lastError().text();
+        return false;
+    }
+    
+    delete readingIndex;
+    readingIndex = nullptr;
+    
+    if (importedCount) {
+        *importedCount = int(reader.rowCount());
+    }
+    
+    KanjiChangeSet change;
+    change.kinds = KanjiChangeSet::CardsImported | KanjiChangeSet::CardsRescheduled;
+    change.totalDelta = getTotalKanjiCount() - totalBefore;
+    change.learnedDelta = getLearnedKanjiCount() - learnedBefore;
+    change.newDelta = getNewKanjiCount() - newBefore;
+    change.reviewDueDelta = getReviewDueCount() - dueBefore;
+    if (change.learnedDelta != 0) {
+        change.kinds |= KanjiChangeSet::CardsLearned;
+    }
+    change.earliestNextReview = getNextReviewTime();
+    changeNotifier->post(change);
+    
+    if (!applyPendingProgress()) {
+        qDebug() << "Synced progress left pending:" << lastError;
+    }
+    
+    return true;
+}
+
+int KanjiDatabase::deckIdForLevel(int jlptLevel)
+{
+    QSqlQuery query(db);
+    prepareQuery(query, "SELECT id FROM decks WHERE jlpt_level = ?");
+    query.addBindValue(jlptLevel);
+    if (query.exec() && query.next()) {
+        return query.value(0).toInt();
+    }
+    return 0;
+}
+
+QList<KanjiDeck> KanjiDatabase::getDecks()
+{
+    flushProgress();
+    QList<KanjiDeck> decks;
+    QSqlQuery query(db);
+    prepareQuery(query, "SELECT id, name, jlpt_level, card_count, learned_count FROM decks ORDER BY jlpt_level DESC, id");
+    
+    if (query.exec()) {
+        while (query.next()) {
+            KanjiDeck deck;
+            deck.id = query.value(0).toInt();
+            deck.name = query.value(1).toString();
+            deck.jlpt_level = query.value(2).toInt();
+            deck.card_count = query.value(3).toInt();
+            deck.learned_count = query.value(4).toInt();
+            decks.append(deck);
+        }
+    }
+    
+    return decks;
+}
+
+void KanjiDatabase::setActiveDeck(int deckId)
+{
+    if (deckId == activeDeckId) {
+        return;
+    }
+    activeDeckId = deckId;
+    
+    // Nothing was written, but every scoped count and queue just changed
+    KanjiChangeSet change;
+    change.kinds = KanjiChangeSet::ScopeChanged;
+    changeNotifier->post(change);
+}
+
+bool KanjiDatabase::isInActiveDeck(int id)
+{
+    if (activeDeckId == 0) {
+        return true;
+    }
+    
+    QSqlQuery query(db);
+    prepareQuery(query, "SELECT 1 FROM kanji_decks WHERE deck_id = ? AND kanji_id = ?");
+    query.addBindValue(activeDeckId);
+    query.addBindValue(id);
+    return query.exec() && query.next();
+}
+
+QString KanjiDatabase::scopedKanji() const
+{
+    if (activeDeckId == 0) {
+        return "kanji";
+    }
+    // Driven from the kanji_decks primary key, so cost follows the deck size
+    return QString("kanji_decks JOIN kanji ON kanji.id = kanji_decks.kanji_id AND kanji_decks.deck_id = %1")
+           .arg(activeDeckId);
+}
+
+bool KanjiDatabase::executeQuery(const QString &queryString, const QVariantList &values)
+{
+    QSqlQuery query(db);
+    prepareQuery(query, queryString);
+    
+    for (const auto& value : values) {
+        query.addBindValue(value);
+    }
+    
+    if (!query.exec()) {
+        lastError = query.lastError().text();
+        return false;
+    }
+    
+    return true;
+}
+
+QList<KanjiCard> KanjiDatabase::getNewKanji(int limit)
+{
+    flushProgress();
+    QList<KanjiCard> cards;
+    QSqlQuery query(db);
+    // Highest corpus frequency first, insertion order for ties - served by idx_kanji_new_priority
+    prepareQuery(query, QString("SELECT kanji.* FROM %1 WHERE is_learned = FALSE ORDER BY priority DESC, id LIMIT ?")
+                  .arg(scopedKanji()));
+    query.addBindValue(limit);
+    
+    if (query.exec()) {
+        while (query.next()) {
+            KanjiCard card;
+            card.id = query.value("id").toInt();
+            card.kanji = query.value("kanji").toString();
+            card.meaning = query.value("meaning").toString();
+            card.on_reading = query.value("on_reading").toString();
+            card.kun_reading = query.value("kun_reading").toString();
+            card.example_word = query.value("example_word").toString();
+            card.example_reading = query.value("example_reading").toString();
+            card.example_meaning = query.value("example_meaning").toString();
+            card.difficulty_level = query.value("difficulty_level").toInt();
+            card.is_learned = query.value("is_learned").toBool();
+            card.srs_level = query.value("srs_level").toInt();
+            card.review_count = query.value("review_count").toInt();
+            card.priority = query.value("priority").toLongLong();
+            cards.append(card);
+        }
+    }
+    
+    return cards;
+}
+
+QList<KanjiCard> KanjiDatabase::getReviewKanji()
+{
+    flushProgress();
+    QList<KanjiCard> cards;
+    QSqlQuery query(db);
+    QDateTime now = KanjiClock::now();
+    prepareQuery(query, QString("SELECT kanji.* FROM %1 WHERE is_learned = TRUE AND next_review <= ? ORDER BY next_review")
+                  .arg(scopedKanji()));
+    query.addBindValue(now);
+    
+    qDebug() << "getReviewKanji: Current time is" << now.toString();
+    qDebug() << "getReviewKanji: Looking for learned kanji with next_review <=" << now.toString();
+    
+    if (query.exec()) {
+        while (query.next()) {
+            KanjiCard card;
+            card.id = query.value("id").toInt();
+            card.kanji = query.value("kanji").toString();
+            card.meaning = query.value("meaning").toString();
+            card.on_reading = query.value("on_reading").toString();
+            card.kun_reading = query.value("kun_reading").toString();
+            card.example_word = query.value("example_word").toString();
+            card.example_reading = query.value("example_reading").toString();
+            card.example_meaning = query.value("example_meaning").toString();
+            card.difficulty_level = query.value("difficulty_level").toInt();
+            card.is_learned = query.value("is_learned").toBool();
+            card.last_reviewed = query.value("last_reviewed").toDateTime();
+            card.next_review = query.value("next_review").toDateTime();
+            card.srs_level = query.value("srs_level").toInt();
+            card.review_count = query.value("review_count").toInt();
+            card.priority = query.value("priority").toLongLong();
+            cards.append(card);
+            
+            qDebug() << "getReviewKanji: Found kanji" << card.kanji 
+                     << "level" << card.srs_level 
+                     << "next_review" << card.next_review.toString()
+                     << "is_learned" << card.is_learned;
+        }
+    }
+    
+    qDebug() << "getReviewKanji: Returning" << cards.size() << "kanji for review";
+    return cards;
+}
+
+int KanjiDatabase::getTotalKanjiCount()
+{
+    QSqlQuery query(db);
+    if (activeDeckId != 0) {
+        prepareQuery(query, "SELECT card_count FROM decks WHERE id = ?");
+        query.addBindValue(activeDeckId);
+    } else {
+        prepareQuery(query, "SELECT COUNT(*) FROM kanji");
+    }
+    if (query.exec() && query.next()) {
+        return query.value(0).toInt();
     }
     return 0;
 }
 
 int KanjiDatabase::getLearnedKanjiCount()
 {
+    flushProgress();
+    QSqlQuery query(db);
+    if (activeDeckId != 0) {
+        prepareQuery(query, "SELECT learned_count FROM decks WHERE id = ?");
+        query.addBindValue(activeDeckId);
+    } else {
+        prepareQuery(query, "SELECT COUNT(*) FROM kanji WHERE is_learned = TRUE");
+    }
+    if (query.exec() && query.next()) {
+        return query.value(0).toInt();
+    }
+    return 0;
+}
+
+int KanjiDatabase::getReviewDueCount()
+{
+    flushProgress();
+    QSqlQuery query(db);
+    QDateTime now = KanjiClock::now();
+    prepareQuery(query, QString("SELECT COUNT(*) FROM %1 WHERE is_learned = TRUE AND next_review <= ?").arg(scopedKanji()));
+    query.addBindValue(now);
+    
+    qDebug() << "getReviewDueCount: Current time is" << now.toString();
+    qDebug() << "getReviewDueCount: Looking for kanji with next_review <=" << now.toString();
+    
+    if (query.exec() && query.next()) {
+        int count = query.value(0).toInt();
+        qDebug() << "getReviewDueCount: Found" << count << "kanji due for review";
+        return count;
+    }
+    return 0;
+}
+
+int KanjiDatabase::getNewKanjiCount()
+{
+    flushProgress();
     QSqlQuery query(db);
-    query.prepare("SELECT COUNT(*) FROM kanji WHERE is_learned = TRUE");
+    if (activeDeckId != 0) {
+        prepareQuery(query, "SELECT card_count - learned_count FROM decks WHERE id = ?");
+        query.addBindValue(activeDeckId);
+    } else {
+        prepareQuery(query, "SELECT COUNT(*) FROM kanji WHERE is_learned = FALSE");
+    }
     if (query.exec() && query.next()) {
         return query.value(0).toInt();
     }
-    return 0;
+    return 0;
+}
+
+QDateTime KanjiDatabase::getNextReviewTime()
+{
+    flushProgress();
+    QSqlQuery query(db);
+    prepareQuery(query, QString("SELECT MIN(next_review) FROM %1 WHERE is_learned = TRUE AND next_review > ?").arg(scopedKanji()));
+    query.addBindValue(KanjiClock::now());
+    
+    if (query.exec() && query.next()) {
+        return query.value(0).toDateTime();
+    }
+    return QDateTime();
+}
+
+QMap<int, int> KanjiDatabase::getKanjiCountByLevel()
+{
+    flushProgress();
+    QMap<int, int> levelCounts;
+    
+    // Initialize all levels to 0
+    for (int i = 0; i <= 8; ++i) {
+        levelCounts[i] = 0;
+    }
+    
+    QSqlQuery query(db);
+    prepareQuery(query, QString("SELECT srs_level, COUNT(*) FROM %1 WHERE is_learned = TRUE GROUP BY srs_level").arg(scopedKanji()));
+    
+    if (query.exec()) {
+        while (query.next()) {
+            int level = query.value(0).toInt();
+            int count = query.value(1).toInt();
+            levelCounts[level] = count;
+        }
+    }
+    
+    // Also get unlearned kanji count (level 0)
+    levelCounts[0] = getNewKanjiCount();
+    
+    return levelCounts;
+}
+
+QList<QPair<QDateTime, int>> KanjiDatabase::getScheduledReviews(const QDateTime &before)
+{
+    flushProgress();
+    QList<QPair<QDateTime, int>> reviews;
+    
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+    prepareQuery(query, QString("SELECT kanji.next_review, kanji.srs_level FROM %1 "
+                                "WHERE is_learned = TRUE AND next_review < ?").arg(scopedKanji()));
+    query.addBindValue(before);
+    
+    if (!query.exec()) {
+        lastError = "Failed to read review schedule: " + query.lastError().text();
+        return reviews;
+    }
+    while (query.next()) {
+        reviews.append({query.value(0).toDateTime(), query.value(1).toInt()});
+    }
+    return reviews;
+}
+
+bool KanjiDatabase::readReviewLog(KanjiReviewColumns &columns)
+{
+    flushProgress();
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+    prepareQuery(query, R"(
+        SELECT id, kanji_id, reviewed_at, elapsed_seconds, correct, srs_level, difficulty_level, hour_of_day
+        FROM review_log WHERE id > ? ORDER BY id
+    )");
+    query.addBindValue(columns.lastLogId);
+    
+    if (!query.exec()) {
+        lastError = "Failed to read review log: " + query.lastError().text();
+        return false;
+    }
+    
+    // Narrowed and clamped once here, so aggregation can index by the values directly
+    while (query.next()) {
+        columns.lastLogId = query.value(0).toLongLong();
+        columns.kanjiId.append(query.value(1).toInt());
+        columns.reviewedAt.append(query.value(2).toLongLong());
+        columns.elapsedSeconds.append(qint32(qBound<qint64>(-1, query.value(3).toLongLong(), std::numeric_limits<qint32>::max())));
+        columns.correct.append(query.value(4).toInt() != 0 ? 1 : 0);
+        columns.srsLevel.append(quint8(qBound(0, query.value(5).toInt(), 8)));
+        columns.difficulty.append(quint8(qBound(1, query.value(6).toInt(), 5)));
+        columns.hourOfDay.append(quint8(qBound(0, query.value(7).toInt(), 23)));
+    }
+    return true;
+}
+
+bool KanjiDatabase::readCardStates(KanjiCardColumns &columns)
+{
+    flushProgress();
+    columns = KanjiCardColumns();
+    
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+    prepareQuery(query, QString("SELECT kanji.id, kanji.is_learned, kanji.srs_level, kanji.next_review FROM %1")
+                            .arg(scopedKanji()));
+    
+    if (!query.exec()) {
+        lastError = "Failed to read card states: " + query.lastError().text();
+        return false;
+    }
+    
+    while (query.next()) {
+        const QDateTime nextReview = query.value(3).toDateTime();
+        columns.id.append(query.value(0).toInt());
+        columns.learned.append(query.value(1).toBool() ? 1 : 0);
+        columns.srsLevel.append(quint8(qBound(0, query.value(2).toInt(), 8)));
+        columns.nextReview.append(nextReview.isValid() ? nextReview.toMSecsSinceEpoch() : qint64(-1));
+    }
+    return true;
+}
+
+bool KanjiDatabase::setKanjiPriorities(const QHash<QString, qint64> &counts)
+{
+    if (!db.transaction()) {
+        lastError = "Failed to start transaction: " + db.lastError().text();
+        return false;
+    }
+    
+    QSqlQuery query(db);
+    prepareQuery(query, "UPDATE kanji SET priority = 0 WHERE priority <> 0");
+    if (!query.exec()) {
+        lastError = "Failed to clear priorities: " + query.lastError().text();
+        db.rollback();
+        return false;
+    }
+    
+    // One batched statement, looked up through the UNIQUE index on kanji
+    QVariantList priorities;
+    QVariantList kanji;
+    for (auto it = counts.constBegin(); it != counts.constEnd(); ++it) {
+        priorities.append(it.value());
+        kanji.append(it.key());
+    }
+    
+    prepareQuery(query, "UPDATE kanji SET priority = ? WHERE kanji = ?");
+    query.addBindValue(priorities);
+    query.addBindValue(kanji);
+    
+    if (!query.execBatch()) {
+        lastError = "Failed to set priorities: " + query.lastError().text();
+        db.rollback();
+        return false;
+    }
+    
+    if (!db.commit()) {
+        lastError = "Failed to commit priorities: " + db.lastError().text();
+        return false;
+    }
+    
+    KanjiChangeSet change;
+    change.kinds = KanjiChangeSet::CardsReordered;
+    changeNotifier->post(change);
+    
+    return true;
+}
+
+QHash<QString, int> KanjiDatabase::getKanjiSrsLevels()
+{
+    flushProgress();
+    QHash<QString, int> levels;
+    QSqlQuery query(db);
+    prepareQuery(query, "SELECT kanji, CASE WHEN is_learned = TRUE THEN MAX(srs_level, 1) ELSE 0 END FROM kanji");
+    
+    if (query.exec()) {
+        while (query.next()) {
+            levels.insert(query.value(0).toString(), query.value(1).toInt());
+        }
+    }
+    
+    return levels;
+}
+
+int KanjiDatabase::srsIntervalSeconds(int level)
+{
+    // SRS intervals (in seconds for testing - very short for quick testing)
+    switch (level) {
+        case 1: return 10;      // 10 seconds
+        case 2: return 30;      // 30 seconds
+        case 3: return 60;      // 1 minute
+        case 4: return 120;     // 2 minutes
+        case 5: return 300;     // 5 minutes
+        case 6: return 600;     // 10 minutes
+        case 7: return 1800;    // 30 minutes
+        case 8: return 3600;    // 1 hour
+        default: return 10;
+    }
+}
+
+KanjiCard KanjiDatabase::scheduleAnswer(const KanjiCard &card, bool correct, const QDateTime &now)
+{
+    KanjiCard next = card;
+    
+    if (correct) {
+        // For unlearned kanji (level 0), start at level 1
+        // For already learned kanji, advance to next level (max level 8)
+        if (card.srs_level == 0 || !card.is_learned) {
+            next.srs_level = 1; // First time learning
+        } else {
+            next.srs_level = qMin(card.srs_level + 1, 8); // Advance level
+        }
+        next.is_learned = true;
+    } else {
+        // Lower level by 1 (minimum level 1)
+        next.srs_level = qMax(card.srs_level - 1, 1);
+    }
+    
+    next.last_reviewed = now;
+    next.next_review = now.addSecs(srsIntervalSeconds(next.srs_level));
+    next.review_count = card.review_count + 1;
+    return next;
+}
+
+bool KanjiDatabase::writeProgress(const QList<KanjiCard> &cards, const QList<KanjiReviewEvent> &reviews)
+{
+    if (cards.isEmpty() && reviews.isEmpty()) {
+        return true;
+    }
+    
+    if (!db.transaction()) {
+        lastError = "Failed to start transaction: " + db.lastError().text();
+        return false;
+    }
+    
+    QSqlQuery query(db);
+    prepareQuery(query, R"(
+        UPDATE kanji SET 
+            is_learned = ?,
+            last_reviewed = ?,
+            next_review = ?,
+            srs_level = ?,
+            review_count = ?
+        WHERE id = ?
+    )");
+    
+    for (const KanjiCard &card : cards) {
+        query.addBindValue(card.is_learned);
+        query.addBindValue(card.last_reviewed);
+        query.addBindValue(card.next_review);
+        query.addBindValue(card.srs_level);
+        query.addBindValue(card.review_count);
+        query.addBindValue(card.id);
+        
+        if (!query.exec()) {
+            lastError = "Failed to update kanji progress: " + query.lastError().text();
+            db.rollback();
+            return false;
+        }
+    }
+    
+    QSqlQuery logQuery(db);
+    if (!reviews.isEmpty()) {
+        prepareQuery(logQuery, R"(
+            INSERT INTO review_log (kanji_id, reviewed_at, hour_of_day, correct, srs_level, difficulty_level,
+                                    elapsed_seconds)
+            VALUES (?, ?, ?, ?, ?, ?, ?)
+        )");
+    }
+    for (const KanjiReviewEvent &review : reviews) {
+        logQuery.addBindValue(review.kanjiId);
+        logQuery.addBindValue(review.reviewedAt.toMSecsSinceEpoch());
+        logQuery.addBindValue(review.reviewedAt.time().hour());
+        logQuery.addBindValue(review.correct ? 1 : 0);
+        logQuery.addBindValue(review.srsLevel);
+        logQuery.addBindValue(review.difficulty);
+        logQuery.addBindValue(review.elapsedSeconds);
+        
+        if (!logQuery.exec()) {
+            lastError = "Failed to log review: " + logQuery.lastError().text();
+            db.rollback();
+            return false;
+        }
+    }
+    
+    if (!db.commit()) {
+        lastError = "Failed to commit kanji progress: " + db.lastError().text();
+        return false;
+    }
+    
+    return true;
+}
+
+bool KanjiDatabase::enableWriteBehind(int flushIntervalMs)
+{
+    if (progressBuffer) {
+        return true;
+    }
+    
+    ProgressWriteBuffer *buffer = new ProgressWriteBuffer(getJournalPath(), flushIntervalMs);
+    if (!buffer->open()) {
+        lastError = buffer->getLastError();
+        delete buffer;
+        return false;
+    }
+    
+    QObject::connect(buffer, &ProgressWriteBuffer::flushRequested, buffer, [this]() {
+        if (!flushProgress()) {
+            qDebug() << "Progress flush failed, kept in journal:" << lastError;
+        }
+    });
+    progressBuffer = buffer;
+    return true;
+}
+
+bool KanjiDatabase::flushProgress()
+{
+    if (!progressBuffer || progressBuffer->isEmpty()) {
+        return true;
+    }
+    
+    // On failure everything stays pending and journaled for the next attempt
+    if (!writeProgress(progressBuffer->pendingCards(), progressBuffer->pendingReviews())) {
+        return false;
+    }
+    progressBuffer->clear();
+    emit changeNotifier->progressFlushed();
+    return true;
+}
+
+bool KanjiDatabase::hasPendingProgress() const
+{
+    return progressBuffer && !progressBuffer->isEmpty();
+}
+
+bool KanjiDatabase::replayProgressJournal()
+{
+    QString path = getJournalPath();
+    if (!QFile::exists(path)) {
+        return true;
+    }
+    
+    // Answers go back into review_log along with the card states
+    QString error;
+    QList<KanjiCard> cards;
+    QList<KanjiReviewEvent> reviews;
+    if (!ProgressWriteBuffer::readJournal(path, cards, reviews, &error)) {
+        qDebug() << "Discarding unreadable progress journal:" << error;
+    } else if (!writeProgress(cards, reviews)) {
+        return false;
+    } else if (!cards.isEmpty()) {
+        qDebug() << "Recovered progress for" << cards.size() << "kanji from the journal";
+    }
+    
+    QFile::remove(path);
+    return true;
+}
+
+QString KanjiDatabase::getBackupDirectory()
+{
+    return dataLocation() + "/backups";
+}
+
+bool KanjiDatabase::backupTo(const QString &path, int pagesPerStep, const std::function<bool(int, int)> &progress)
+{
+    const QString partPath = path + ".part";
+    QFile::remove(partPath);
+    
+    // Only with the driver's own handle: backupTo runs on a connection of its
+    // own, and the API is built in only when the Qt driver links this same
+    // SQLite (see CMakeLists.txt). A second library copy or a second handle to
+    // the file would drop its POSIX locks on close and could remove the -wal.
+    sqlite3 *source = nullptr;
+#ifdef KANJICORE_HAVE_SQLITE3
+    const QVariant handle = db.driver()->handle();
+    if (handle.isValid() && qstrcmp(handle.typeName(), "sqlite3*") == 0) {
+        source = *static_cast<sqlite3 *const *>(handle.constData());
+    }
+#endif
+    
+    bool ok = false;
+    if (!source) {
+        // VACUUM INTO copies everything inside one read transaction on the Qt
+        // connection. WAL keeps writers going; there is no progress to report.
+        QSqlQuery query(db);
+        prepareQuery(query, "VACUUM INTO ?");
+        query.addBindValue(partPath);
+        ok = query.exec();
+        if (!ok) {
+            lastError = "Backup failed: " + query.lastError().text();
+        } else if (progress && !progress(1, 1)) {
+            lastError = "Backup cancelled";
+            ok = false;
+        }
+    }
+#ifdef KANJICORE_HAVE_SQLITE3
+    else {
+        // The source only holds a read lock for the length of one step
+        sqlite3 *target = nullptr;
+        sqlite3_backup *backup = nullptr;
+        if (sqlite3_open_v2(partPath.toUtf8().constData(), &target,
+                            SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE, nullptr) == SQLITE_OK) {
+            backup = sqlite3_backup_init(target, "main", source, "main");
+        }
+        if (!backup) {
+            lastError = QString("Backup failed: %1").arg(target ? sqlite3_errmsg(target) : "cannot create " + partPath);
+            sqlite3_close(target);
+            QFile::remove(partPath);
+            return false;
+        }
+        
+        // A write through another connection restarts the copy from the first page.
+        // After a few restarts finish in one step: in WAL mode that is a single read
+        // snapshot, which writers don't wait for either.
+        int step = pagesPerStep;
+        int restarts = 0;
+        int remaining = -1;
+        int rc = SQLITE_OK;
+        bool cancelled = false;
+        while (rc == SQLITE_OK || rc == SQLITE_BUSY || rc == SQLITE_LOCKED) {
+            rc = sqlite3_backup_step(backup, step);
+            
+            const int total = sqlite3_backup_pagecount(backup);
+            const int left = sqlite3_backup_remaining(backup);
+            if (remaining >= 0 && left > remaining && ++restarts >= MaxBackupRestarts) {
+                step = -1;
+            }
+            remaining = left;
+            
+            if (progress && !progress(total - left, total)) {
+                cancelled = true;
+                break;
+            }
+            if (rc != SQLITE_DONE) {
+                QThread::msleep(BackupStepPauseMs);
+            }
+        }
+        sqlite3_backup_finish(backup);
+        
+        ok = !cancelled && rc == SQLITE_DONE;
+        if (!ok) {
+            lastError = cancelled ? QString("Backup cancelled") : QString("Backup failed: %1").arg(sqlite3_errstr(rc));
+        }
+        sqlite3_close(target);
+    }
+#else
+    Q_UNUSED(pagesPerStep);
+#endif
+    
+    if (ok) {
+        QFile::remove(path);
+        ok = QFile::rename(partPath, path);
+        if (!ok) {
+            lastError = "Cannot move backup into place at " + path;
+        }
+    }
+    if (!ok) {
+        QFile::remove(partPath);
+    }
+    return ok;
+}
+
+QString KanjiDatabase::getSyncValue(const QString &key)
+{
+    QSqlQuery query(db);
+    prepareQuery(query, "SELECT value FROM sync_state WHERE key = ?");
+    query.addBindValue(key);
+    if (query.exec() && query.next()) {
+        return query.value(0).toString();
+    }
+    return QString();
+}
+
+bool KanjiDatabase::setSyncValue(const QString &key, const QString &value)
+{
+    return executeQuery("INSERT OR REPLACE INTO sync_state (key, value) VALUES (?, ?)", {key, value});
+}
+
+QString KanjiDatabase::getDeviceId()
+{
+    QString deviceId = getSyncValue("device_id");
+    if (deviceId.isEmpty()) {
+        deviceId = QUuid::createUuid().toString(QUuid::WithoutBraces);
+        setSyncValue("device_id", deviceId);
+    }
+    return deviceId;
+}
+
+QList<KanjiProgressRecord> KanjiDatabase::getProgressChangesSince(qint64 sequence, qint64 *lastSequence)
+{
+    flushProgress();
+    
+    QList<KanjiProgressRecord> records;
+    if (lastSequence) {
+        *lastSequence = sequence;
+    }
+    
+    QSqlQuery query(db);
+    prepareQuery(query, R"(
+        SELECT progress_changelog.seq, kanji.kanji, kanji.is_learned, kanji.srs_level,
+               kanji.review_count, kanji.last_reviewed, kanji.next_review
+        FROM progress_changelog JOIN kanji ON kanji.id = progress_changelog.kanji_id
+        WHERE progress_changelog.seq > ? AND progress_changelog.imported = 0
+        ORDER BY progress_changelog.seq
+    )");
+    query.addBindValue(sequence);
+    
+    if (!query.exec()) {
+        lastError = "Failed to read progress changes: " + query.lastError().text();
+        return records;
+    }
+    
+    while (query.next()) {
+        KanjiProgressRecord record;
+        record.kanji = query.value(1).toString();
+        record.is_learned = query.value(2).toBool();
+        record.srs_level = query.value(3).toInt();
+        record.review_count = query.value(4).toInt();
+        record.last_reviewed = query.value(5).toDateTime();
+        record.next_review = query.value(6).toDateTime();
+        records.append(record);
+        
+        if (lastSequence) {
+            *lastSequence = query.value(0).toLongLong();
+        }
+    }
+    
+    return records;
+}
+
+bool KanjiDatabase::remoteProgressWins(const KanjiProgressRecord &remote, const KanjiCard &local)
+{
+    // Most recent review wins; ties go to more reviews, then the higher level,
+    // so two devices exchanging the same pair always agree on the result
+    if (remote.last_reviewed.isValid() != local.last_reviewed.isValid()) {
+        return remote.last_reviewed.isValid();
+    }
+    if (remote.last_reviewed != local.last_reviewed) {
+        return remote.last_reviewed > local.last_reviewed;
+    }
+    if (remote.review_count != local.review_count) {
+        return remote.review_count > local.review_count;
+    }
+    return remote.srs_level > local.srs_level;
+}
+
+bool KanjiDatabase::applyProgressChanges(const QList<KanjiProgressRecord> &records, int *appliedCount)
+{
+    if (appliedCount) {
+        *appliedCount = 0;
+    }
+    
+    // Bulk write - capture scoped counts so listeners get exact deltas
+    int learnedBefore = getLearnedKanjiCount();
+    int newBefore = getNewKanjiCount();
+    int dueBefore = getReviewDueCount();
+    
+    if (!db.transaction()) {
+        lastError = "Failed to start transaction: " + db.lastError().text();
+        return false;
+    }
+    
+    QSqlQuery select(db);
+    prepareQuery(select, "SELECT * FROM kanji WHERE kanji = ?");
+    
+    // Only cards whose remote state wins are written
+    QList<KanjiCard> winners;
+    QList<KanjiReschedule> reschedules;
+    QList<KanjiProgressRecord> unmatched;
+    for (const KanjiProgressRecord &record : records) {
+        select.addBindValue(record.kanji);
+        if (!select.exec()) {
+            lastError = "Failed to read kanji: " + select.lastError().text();
+            db.rollback();
+            return false;
+        }
+        if (!select.next()) {
+            unmatched.append(record); // Card not in this deck yet
+            continue;
+        }
+        
+        KanjiCard local = readCard(select);
+        if (!remoteProgressWins(record, local)) {
+            continue;
+        }
+        
+        reschedules.append({local.id, local.is_learned, local.next_review, local.srs_level,
+                            record.is_learned, record.next_review, record.srs_level});
+        local.is_learned = record.is_learned;
+        local.srs_level = record.srs_level;
+        local.review_count = record.review_count;
+        local.last_reviewed = record.last_reviewed;
+        local.next_review = record.next_review;
+        winners.append(local);
+    }
+    select.finish();
+    
+    if (!keepPendingProgress(unmatched)) {
+        db.rollback();
+        return false;
+    }
+    
+    QSqlQuery update(db);
+    prepareQuery(update, R"(
+        UPDATE kanji SET is_learned = ?, last_reviewed = ?, next_review = ?, srs_level = ?, review_count = ?
+        WHERE id = ?
+    )");
+    // Changes that came from another device are not local changes to send back
+    QSqlQuery markImported(db);
+    prepareQuery(markImported, "UPDATE progress_changelog SET imported = 1 WHERE kanji_id = ?");
+    QList<int> cardIds;
+    QDateTime earliestNextReview;
+    for (const KanjiCard &card : winners) {
+        update.addBindValue(card.is_learned);
+        update.addBindValue(card.last_reviewed);
+        update.addBindValue(card.next_review);
+        update.addBindValue(card.srs_level);
+        update.addBindValue(card.review_count);
+        update.addBindValue(card.id);
+        if (!update.exec()) {
+            lastError = "Failed to apply progress: " + update.lastError().text();
+            db.rollback();
+            return false;
+        }
+        markImported.addBindValue(card.id);
+        if (!markImported.exec()) {
+            lastError = "Failed to update change log: " + markImported.lastError().text();
+            db.rollback();
+            return false;
+        }
+        
+        cardIds.append(card.id);
+        if (card.is_learned && card.next_review.isValid() &&
+            (!earliestNextReview.isValid() || card.next_review < earliestNextReview)) {
+            earliestNextReview = card.next_review;
+        }
+    }
+    
+    if (!db.commit()) {
+        lastError = "Failed to commit progress: " + db.lastError().text();
+        return false;
+    }
+    
+    if (appliedCount) {
+        *appliedCount = winners.size();
+    }
+    
+    if (!winners.isEmpty()) {
+        KanjiChangeSet change;
+        change.kinds = KanjiChangeSet::CardsRescheduled;
+        change.learnedDelta = getLearnedKanjiCount() - learnedBefore;
+        change.newDelta = getNewKanjiCount() - newBefore;
+        change.reviewDueDelta = getReviewDueCount() - dueBefore;
+        if (change.learnedDelta != 0) {
+            change.kinds |= KanjiChangeSet::CardsLearned;
+        }
+        change.cardIds = cardIds;
+        change.earliestNextReview = earliestNextReview;
+        for (const KanjiReschedule &reschedule : reschedules) {
+            if (isInActiveDeck(reschedule.cardId)) {
+                change.reschedules.append(reschedule);
+            }
+        }
+        changeNotifier->post(change);
+    }
+    
+    return true;
 }
 
-int KanjiDatabase::getReviewDueCount()
+bool KanjiDatabase::keepPendingProgress(const QList<KanjiProgressRecord> &records)
 {
-    QSqlQuery query(db);
-    QDateTime now = QDateTime::currentDateTime();
-    query.prepare("SELECT COUNT(*) FROM kanji WHERE is_learned = TRUE AND next_review <= ?");
-    query.addBindValue(now);
-    
-    qDebug() << "getReviewDueCount: Current time is" << now.toString();
-    qDebug() << "getReviewDueCount: Looking for kanji with next_review <=" << now.toString();
+    QSqlQuery select(db);
+    prepareQuery(select, R"(
+        SELECT is_learned, srs_level, review_count, last_reviewed, next_review
+        FROM pending_progress WHERE kanji = ?
+    )");
+    QSqlQuery keep(db);
+    prepareQuery(keep, R"(
+        INSERT OR REPLACE INTO pending_progress (kanji, is_learned, srs_level, review_count, last_reviewed, next_review)
+        VALUES (?, ?, ?, ?, ?, ?)
+    )");
     
-    if (query.exec() && query.next()) {
-        int count = query.value(0).toInt();
-        qDebug() << "getReviewDueCount: Found" << count << "kanji due for review";
-        return count;
+    // Two devices can send the same missing card; the usual rule picks which one waits
+    for (const KanjiProgressRecord &record : records) {
+        select.addBindValue(record.kanji);
+        if (!select.exec()) {
+            lastError = "Failed to read pending progress: " + select.lastError().text();
+            return false;
+        }
+        if (select.next()) {
+            KanjiCard held;
+            held.is_learned = select.value(0).toBool();
+            held.srs_level = select.value(1).toInt();
+            held.review_count = select.value(2).toInt();
+            held.last_reviewed = select.value(3).toDateTime();
+            held.next_review = select.value(4).toDateTime();
+            if (!remoteProgressWins(record, held)) {
+                continue;
+            }
+        }
+        
+        keep.addBindValue(record.kanji);
+        keep.addBindValue(record.is_learned);
+        keep.addBindValue(record.srs_level);
+        keep.addBindValue(record.review_count);
+        keep.addBindValue(record.last_reviewed.isValid() ? QVariant(record.last_reviewed) : QVariant());
+        keep.addBindValue(record.next_review.isValid() ? QVariant(record.next_review) : QVariant());
+        if (!keep.exec()) {
+            lastError = "Failed to keep pending progress: " + keep.lastError().text();
+            return false;
+        }
     }
-    return 0;
+    return true;
 }
 
-int KanjiDatabase::getNewKanjiCount()
+bool KanjiDatabase::applyPendingProgress()
 {
     QSqlQuery query(db);
-    query.prepare("SELECT COUNT(*) FROM kanji WHERE is_learned = FALSE");
-    if (query.exec() && query.next()) {
-        return query.value(0).toInt();
+    prepareQuery(query, R"(
+        SELECT pending_progress.kanji, pending_progress.is_learned, pending_progress.srs_level,
+               pending_progress.review_count, pending_progress.last_reviewed, pending_progress.next_review
+        FROM pending_progress JOIN kanji ON kanji.kanji = pending_progress.kanji
+    )");
+    if (!query.exec()) {
+        lastError = "Failed to read pending progress: " + query.lastError().text();
+        return false;
     }
-    return 0;
-}
-
-QMap<int, int> KanjiDatabase::getKanjiCountByLevel()
-{
-    QMap<int, int> levelCounts;
     
-    // Initialize all levels to 0
-    for (int i = 0; i <= 8; ++i) {
-        levelCounts[i] = 0;
+    QList<KanjiProgressRecord> records;
+    QVariantList matched;
+    while (query.next()) {
+        KanjiProgressRecord record;
+        record.kanji = query.value(0).toString();
+        record.is_learned = query.value(1).toBool();
+        record.srs_level = query.value(2).toInt();
+        record.review_count = query.value(3).toInt();
+        record.last_reviewed = query.value(4).toDateTime();
+        record.next_review = query.value(5).toDateTime();
+        records.append(record);
+        matched.append(record.kanji);
     }
+    query.finish();
     
-    QSqlQuery query(db);
-    query.prepare("SELECT srs_level, COUNT(*) FROM kanji WHERE is_learned = TRUE GROUP BY srs_level");
-    
-    if (query.exec()) {
-        while (query.next()) {
-            int level = query.value(0).toInt();
-            int count = query.value(1).toInt();
-            levelCounts[level] = count;
-        }
+    if (records.isEmpty()) {
+        return true;
     }
-    
-    // Also get unlearned kanji count (level 0)
-    query.prepare("SELECT COUNT(*) FROM kanji WHERE is_learned = FALSE");
-    if (query.exec() && query.next()) {
-        levelCounts[0] = query.value(0).toInt();
+    if (!applyProgressChanges(records)) {
+        return false;
     }
     
-    return levelCounts;
+    // Applying twice is harmless, so a failure here only retries on the next import
+    prepareQuery(query, "DELETE FROM pending_progress WHERE kanji = ?");
+    query.addBindValue(matched);
+    if (!query.execBatch()) {
+        lastError = "Failed to clear pending progress: " + query.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+QString KanjiDatabase::getJournalPath()
+{
+    return getDatabasePath() + "-progress";
 }
 
 bool KanjiDatabase::updateKanjiProgress(int id, bool correct, int difficulty)
 {
+    Q_UNUSED(difficulty);
+    
     try {
-        QSqlQuery query(db);
-        QDateTime now = QDateTime::currentDateTime();
+        QDateTime now = KanjiClock::now();
         
         // DEBUG: Check if datetime is working correctly
         qDebug() << "updateKanjiProgress: Current time:" << now.toString();
         qDebug() << "updateKanjiProgress: Unix timestamp:" << now.toSecsSinceEpoch();
         
-        // Get current kanji data
+        // Get current kanji data, including answers not yet flushed
         KanjiCard currentKanji = getKanjiById(id);
+        if (currentKanji.kanji.isEmpty()) {
+            throw std::runtime_error(QString("No kanji with id %1").arg(id).toStdString());
+        }
         
-        if (correct) {
-            // For unlearned kanji (level 0), start at level 1
-            // For already learned kanji, advance to next level (max level 8)
-            int newLevel;
-            if (currentKanji.srs_level == 0 || !currentKanji.is_learned) {
-                newLevel = 1; // First time learning
-            } else {
-                newLevel = qMin(currentKanji.srs_level + 1, 8); // Advance level
-            }
-            
-            // SRS intervals (in seconds for testing - very short for quick testing)
-            // Level 1: 10 sec, Level 2: 30 sec, Level 3: 60 sec, Level 4: 120 sec
-            // Level 5: 300 sec (5 min), Level 6: 600 sec (10 min), Level 7: 1800 sec (30 min), Level 8: 3600 sec (1 hour)
-            QDateTime nextReview;
-            switch (newLevel) {
-                case 1: nextReview = now.addSecs(10); break;     // 10 seconds
-                case 2: nextReview = now.addSecs(30); break;     // 30 seconds  
-                case 3: nextReview = now.addSecs(60); break;     // 1 minute
-                case 4: nextReview = now.addSecs(120); break;    // 2 minutes
-                case 5: nextReview = now.addSecs(300); break;    // 5 minutes
-                case 6: nextReview = now.addSecs(600); break;    // 10 minutes
-                case 7: nextReview = now.addSecs(1800); break;   // 30 minutes
-                case 8: nextReview = now.addSecs(3600); break;   // 1 hour
-                default: nextReview = now.addSecs(10); break;
-            }
-            
-            qDebug() << "Setting kanji" << currentKanji.kanji << "to level" << newLevel 
-                     << "with next review at" << nextReview.toString();
-            
-            query.prepare(R"(
-                UPDATE kanji SET 
-                    is_learned = TRUE,
-                    last_reviewed = ?,
-                    next_review = ?,
-                    srs_level = ?,
-                    review_count = review_count + 1
-                WHERE id = ?
-            )");
-            
-            query.addBindValue(now);
-            query.addBindValue(nextReview);
-            query.addBindValue(newLevel);
-            query.addBindValue(id);
-            
-        } else {
-            // Lower level by 1 (minimum level 1) and set review time based on new level
-            int newLevel = qMax(currentKanji.srs_level - 1, 1);
-            
-            QDateTime nextReview;
-            switch (newLevel) {
-                case 1: nextReview = now.addSecs(10); break;     // 10 seconds
-                case 2: nextReview = now.addSecs(30); break;     // 30 seconds  
-                case 3: nextReview = now.addSecs(60); break;     // 1 minute
-                case 4: nextReview = now.addSecs(120); break;    // 2 minutes
-                case 5: nextReview = now.addSecs(300); break;    // 5 minutes
-                case 6: nextReview = now.addSecs(600); break;    // 10 minutes
-                case 7: nextReview = now.addSecs(1800); break;   // 30 minutes
-                case 8: nextReview = now.addSecs(3600); break;   // 1 hour
-                default: nextReview = now.addSecs(10); break;
+        KanjiCard updated = scheduleAnswer(currentKanji, correct, now);
+        QDateTime scheduledReview = updated.next_review;
+        
+        qDebug() << (correct ? "Setting kanji" : "Lowering kanji") << currentKanji.kanji
+                 << "to level" << updated.srs_level << "with next review at" << scheduledReview.toString();
+        
+        KanjiReviewEvent review;
+        review.kanjiId = id;
+        review.reviewedAt = now;
+        review.correct = correct;
+        review.srsLevel = currentKanji.is_learned ? currentKanji.srs_level : 0;
+        review.difficulty = currentKanji.difficulty_level;
+        if (currentKanji.last_reviewed.isValid()) {
+            review.elapsedSeconds = qMax<qint64>(0, currentKanji.last_reviewed.secsTo(now));
+        }
+        
+        if (progressBuffer) {
+            // Write-behind: journaled now, committed with the next batch
+            if (!progressBuffer->append(updated, review)) {
+                throw std::runtime_error(progressBuffer->getLastError().toStdString());
             }
-            
-            qDebug() << "Lowering kanji" << currentKanji.kanji << "to level" << newLevel 
-                     << "with next review at" << nextReview.toString();
-            
-            query.prepare(R"(
-                UPDATE kanji SET 
-                    last_reviewed = ?,
-                    next_review = ?,
-                    srs_level = ?,
-                    review_count = review_count + 1
-                WHERE id = ?
-            )");
-            
-            query.addBindValue(now);
-            query.addBindValue(nextReview);
-            query.addBindValue(newLevel);
-            query.addBindValue(id);
+        } else if (!writeProgress({updated}, {review})) {
+            throw std::runtime_error(lastError.toStdString());
         }
         
-        if (!query.exec()) {
-            throw std::runtime_error(("Failed to update kanji progress: " + query.lastError().text()).toStdString());
+        // Counter deltas for listeners of notifier(); the card is never due right after an answer
+        bool wasDue = currentKanji.is_learned && currentKanji.next_review.isValid() &&
+                      currentKanji.next_review <= now;
+        bool becameLearned = correct && !currentKanji.is_learned;
+        
+        KanjiChangeSet change;
+        change.kinds = KanjiChangeSet::CardsRescheduled;
+        if (becameLearned) {
+            change.kinds |= KanjiChangeSet::CardsLearned;
+            change.learnedDelta = 1;
+            change.newDelta = -1;
         }
+        change.reviewDueDelta = wasDue ? -1 : 0;
+        change.cardIds.append(id);
+        if (currentKanji.is_learned || becameLearned) {
+            change.earliestNextReview = scheduledReview;
+        }
+        if (isInActiveDeck(id)) {
+            change.reschedules.append({id, currentKanji.is_learned, currentKanji.next_review, currentKanji.srs_level,
+                                       updated.is_learned, updated.next_review, updated.srs_level});
+        } else {
+            // Still reported so caches drop the card, but the scoped counters don't move
+            change.learnedDelta = 0;
+            change.newDelta = 0;
+            change.reviewDueDelta = 0;
+            change.earliestNextReview = QDateTime();
+        }
+        changeNotifier->post(change);
         
         return true;
     }
@@ -503,11 +2125,28 @@ bool KanjiDatabase::updateKanjiProgress(int id, bool correct, int difficulty)
     }
 }
 
+KanjiResultSet KanjiDatabase::getAllKanjiRows()
+{
+    flushProgress();
+    KanjiResultSet rows;
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+    prepareQuery(query, "SELECT * FROM kanji ORDER BY id");
+    
+    if (query.exec()) {
+        readRows(query, rows);
+    } else {
+        lastError = "Failed to load kanji: " + query.lastError().text();
+    }
+    return rows;
+}
+
 QList<KanjiCard> KanjiDatabase::getAllKanji()
 {
+    flushProgress();
     QList<KanjiCard> cards;
     QSqlQuery query(db);
-    query.prepare("SELECT * FROM kanji ORDER BY id");
+    prepareQuery(query, "SELECT * FROM kanji ORDER BY id");
     
     if (query.exec()) {
         while (query.next()) {
@@ -526,6 +2165,7 @@ QList<KanjiCard> KanjiDatabase::getAllKanji()
             card.next_review = query.value("next_review").toDateTime();
             card.srs_level = query.value("srs_level").toInt();
             card.review_count = query.value("review_count").toInt();
+            card.priority = query.value("priority").toLongLong();
             cards.append(card);
         }
     }
@@ -533,11 +2173,247 @@ QList<KanjiCard> KanjiDatabase::getAllKanji()
     return cards;
 }
 
+static QString browseSortColumn(KanjiBrowseQuery::SortKey sortKey)
+{
+    switch (sortKey) {
+        case KanjiBrowseQuery::SortByKanji: return "kanji";
+        case KanjiBrowseQuery::SortBySrsLevel: return "srs_level";
+        case KanjiBrowseQuery::SortByNextReview: return "next_review";
+        case KanjiBrowseQuery::SortByPriority: return "priority";
+        default: return "id";
+    }
+}
+
+QStringList KanjiDatabase::browseConditions(const KanjiBrowseQuery &browse, QVariantList &values)
+{
+    QStringList conditions;
+    
+    if (activeDeckId != 0) {
+        conditions.append("id IN (SELECT kanji_id FROM kanji_decks WHERE deck_id = ?)");
+        values.append(activeDeckId);
+    }
+    
+    switch (browse.status) {
+        case KanjiBrowseQuery::NewCards:
+            conditions.append("is_learned = FALSE");
+            break;
+        case KanjiBrowseQuery::LearnedCards:
+            conditions.append("is_learned = TRUE");
+            break;
+        case KanjiBrowseQuery::DueCards:
+            conditions.append("is_learned = TRUE AND next_review <= ?");
+            values.append(KanjiClock::now());
+            break;
+        default:
+            break;
+    }
+    
+    QString text = browse.text.trimmed();
+    if (text.isEmpty()) {
+        return conditions;
+    }
+    
+    if (searchIndex && searchIndex->isAvailable()) {
+        QString expression = KanjiSearchIndex::buildMatchExpression(text);
+        if (expression.isEmpty()) {
+            conditions.append("FALSE"); // Nothing searchable in the text
+        } else {
+            conditions.append("id IN (SELECT rowid FROM kanji_fts WHERE kanji_fts MATCH ?)");
+            values.append(expression);
+        }
+    } else {
+        conditions.append("(kanji LIKE ? OR meaning LIKE ? OR on_reading LIKE ? OR kun_reading LIKE ?)");
+        for (int i = 0; i < 4; ++i) {
+            values.append("%" + text + "%");
+        }
+    }
+    
+    return conditions;
+}
+
+QList<KanjiCard> KanjiDatabase::getKanjiPage(const KanjiBrowseQuery &browse, const KanjiPageCursor &after, int limit)
+{
+    QList<KanjiCard> cards;
+    QSqlQuery query(db);
+    if (execKanjiPage(query, browse, after, limit)) {
+        while (query.next()) {
+            cards.append(readCard(query));
+        }
+    }
+    return cards;
+}
+
+KanjiResultSet KanjiDatabase::getKanjiPageRows(const KanjiBrowseQuery &browse, const KanjiPageCursor &after, int limit)
+{
+    KanjiResultSet rows;
+    QSqlQuery query(db);
+    if (execKanjiPage(query, browse, after, limit)) {
+        readRows(query, rows);
+    }
+    return rows;
+}
+
+bool KanjiDatabase::execKanjiPage(QSqlQuery &query, const KanjiBrowseQuery &browse, const KanjiPageCursor &after,
+                                  int limit)
+{
+    flushProgress();
+    QVariantList values;
+    QStringList conditions = browseConditions(browse, values);
+    
+    const QString column = browseSortColumn(browse.sortKey);
+    const QString direction = browse.descending ? "DESC" : "ASC";
+    
+    // Seek past the cursor instead of OFFSET, so deep pages don't rescan the ones before.
+    // Only next_review can be NULL; SQLite sorts NULLs first, so they begin an
+    // ascending walk and end a descending one. A page that can cross between the
+    // two is read as two index ranges and merged: OR-ing them into one condition
+    // makes SQLite walk the index from the start of the deck.
+    QString seek;
+    QString tail; // Second range, after the seek's rows
+    QVariantList seekValues;
+    if (!after.atStart) {
+        const QString comparison = browse.descending ? "<" : ">";
+        if (browse.sortKey == KanjiBrowseQuery::SortById) {
+            seek = QString("id %1 ?").arg(comparison);
+            seekValues.append(after.id);
+        } else if (after.sortValue.isNull()) {
+            seek = QString("%1 IS NULL AND id %2 ?").arg(column, comparison);
+            if (!browse.descending) {
+                tail = QString("%1 IS NOT NULL").arg(column);
+            }
+            seekValues.append(after.id);
+        } else {
+            seek = QString("(%1, id) %2 (?, ?)").arg(column, comparison);
+            if (browse.descending && browse.sortKey == KanjiBrowseQuery::SortByNextReview) {
+                tail = QString("%1 IS NULL").arg(column);
+            }
+            seekValues.append(after.sortValue);
+            seekValues.append(after.id);
+        }
+    }
+    
+    auto select = [](const QStringList &where) {
+        return where.isEmpty() ? QString("SELECT * FROM kanji")
+                               : "SELECT * FROM kanji WHERE " + where.join(" AND ");
+    };
+    const QString order = browse.sortKey == KanjiBrowseQuery::SortById ?
+                          QString("ORDER BY id %1").arg(direction) :
+                          QString("ORDER BY %1 %2, id %2").arg(column, direction);
+    
+    QString sql;
+    if (tail.isEmpty()) {
+        QStringList where = conditions;
+        if (!seek.isEmpty()) {
+            where.append(seek);
+        }
+        sql = select(where) + " " + order + " LIMIT ?";
+        values.append(seekValues);
+    } else {
+        const QVariantList filterValues = values;
+        sql = QString("SELECT * FROM (%1 %3 LIMIT ?) UNION ALL SELECT * FROM (%2 %3 LIMIT ?) %3 LIMIT ?")
+              .arg(select(conditions + QStringList{seek}), select(conditions + QStringList{tail}), order);
+        values.append(seekValues);
+        values.append(limit);
+        values.append(filterValues);
+        values.append(limit);
+    }
+    values.append(limit);
+    
+    query.setForwardOnly(true);
+    prepareQuery(query, sql);
+    for (const QVariant &value : values) {
+        query.addBindValue(value);
+    }
+    
+    if (!query.exec()) {
+        lastError = "Failed to load kanji page: " + query.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+int KanjiDatabase::countKanji(const KanjiBrowseQuery &browse)
+{
+    flushProgress();
+    QVariantList values;
+    QStringList conditions = browseConditions(browse, values);
+    
+    QString sql = "SELECT COUNT(*) FROM kanji";
+    if (!conditions.isEmpty()) {
+        sql += " WHERE " + conditions.join(" AND ");
+    }
+    
+    QSqlQuery query(db);
+    prepareQuery(query, sql);
+    for (const QVariant &value : values) {
+        query.addBindValue(value);
+    }
+    
+    if (query.exec() && query.next()) {
+        return query.value(0).toInt();
+    }
+    return 0;
+}
+
+KanjiPageCursor KanjiDatabase::cursorAfter(const KanjiCard &card, KanjiBrowseQuery::SortKey sortKey)
+{
+    KanjiPageCursor cursor;
+    cursor.atStart = false;
+    cursor.id = card.id;
+    
+    switch (sortKey) {
+        case KanjiBrowseQuery::SortByKanji:
+            cursor.sortValue = card.kanji;
+            break;
+        case KanjiBrowseQuery::SortBySrsLevel:
+            cursor.sortValue = card.srs_level;
+            break;
+        case KanjiBrowseQuery::SortByNextReview:
+            cursor.sortValue = card.next_review.isValid() ? QVariant(card.next_review) : QVariant();
+            break;
+        case KanjiBrowseQuery::SortByPriority:
+            cursor.sortValue = card.priority;
+            break;
+        default:
+            cursor.sortValue = card.id;
+            break;
+    }
+    
+    return cursor;
+}
+
+KanjiPageCursor KanjiDatabase::cursorAfter(const KanjiCardRow &row, KanjiBrowseQuery::SortKey sortKey)
+{
+    KanjiPageCursor cursor;
+    cursor.atStart = false;
+    cursor.id = row.id;
+    
+    switch (sortKey) {
+        case KanjiBrowseQuery::SortByKanji:
+            cursor.sortValue = row.kanji.toString();
+            break;
+        case KanjiBrowseQuery::SortBySrsLevel:
+            cursor.sortValue = row.srs_level;
+            break;
+        case KanjiBrowseQuery::SortByNextReview:
+            cursor.sortValue = row.next_review_ms >= 0 ? QVariant(row.nextReview()) : QVariant();
+            break;
+        case KanjiBrowseQuery::SortByPriority:
+            cursor.sortValue = row.priority;
+            break;
+        default:
+            cursor.sortValue = row.id;
+            break;
+    }
+    
+    return cursor;
+}
+
 KanjiCard KanjiDatabase::getKanjiById(int id)
 {
     KanjiCard card;
     QSqlQuery query(db);
-    query.prepare("SELECT * FROM kanji WHERE id = ?");
+    prepareQuery(query, "SELECT * FROM kanji WHERE id = ?");
     query.addBindValue(id);
     
     if (query.exec() && query.next()) {
@@ -555,17 +2431,229 @@ KanjiCard KanjiDatabase::getKanjiById(int id)
         card.next_review = query.value("next_review").toDateTime();
         card.srs_level = query.value("srs_level").toInt();
         card.review_count = query.value("review_count").toInt();
+        card.priority = query.value("priority").toLongLong();
+        
+        if (progressBuffer) {
+            progressBuffer->overlay(card);
+        }
+    }
+    
+    return card;
+}
+
+QList<KanjiCard> KanjiDatabase::searchKanji(const QString &text, int limit)
+{
+    flushProgress();
+    QList<KanjiCard> cards;
+    QSqlQuery query(db);
+    
+    if (searchIndex && searchIndex->isAvailable()) {
+        QString expression = KanjiSearchIndex::buildMatchExpression(text);
+        if (expression.isEmpty()) {
+            return cards;
+        }
+        
+        prepareQuery(query, R"(
+            SELECT kanji.* FROM kanji_fts
+            JOIN kanji ON kanji.id = kanji_fts.rowid
+            WHERE kanji_fts MATCH ?
+            ORDER BY kanji_fts.rank
+            LIMIT ?
+        )");
+        query.addBindValue(expression);
+    } else {
+        QString pattern = text.trimmed();
+        if (pattern.isEmpty()) {
+            return cards;
+        }
+        pattern = "%" + pattern + "%";
+        
+        prepareQuery(query, R"(
+            SELECT * FROM kanji
+            WHERE kanji LIKE ? OR meaning LIKE ? OR on_reading LIKE ? OR kun_reading LIKE ?
+               OR example_word LIKE ? OR example_meaning LIKE ?
+            ORDER BY id
+            LIMIT ?
+        )");
+        for (int i = 0; i < 6; ++i) {
+            query.addBindValue(pattern);
+        }
+    }
+    query.addBindValue(limit);
+    
+    if (!query.exec()) {
+        lastError = "Search failed: " + query.lastError().text();
+        return cards;
     }
     
+    while (query.next()) {
+        cards.append(readCard(query));
+    }
+    
+    return cards;
+}
+
+QList<KanjiCard> KanjiDatabase::findKanjiByReading(const QString &reading, bool prefix, int limit)
+{
+    ensureReadingIndex();
+    
+    QList<ReadingPosting> postings = prefix ? readingIndex->findPrefix(reading, limit)
+                                            : readingIndex->find(reading);
+    
+    QList<int> ids;
+    for (const ReadingPosting &posting : postings) {
+        if (ids.size() >= limit) {
+            break;
+        }
+        ids.append(posting.cardId);
+    }
+    
+    return getKanjiByIds(ids);
+}
+
+void KanjiDatabase::ensureReadingIndex()
+{
+    if (readingIndex) {
+        return;
+    }
+    
+    readingIndex = new KanjiReadingIndex();
+    
+    // Only the reading columns are needed to build the index
+    QList<KanjiCard> cards;
+    QSqlQuery query(db);
+    prepareQuery(query, "SELECT id, on_reading, kun_reading, example_reading FROM kanji");
+    
+    if (query.exec()) {
+        while (query.next()) {
+            KanjiCard card;
+            card.id = query.value(0).toInt();
+            card.on_reading = query.value(1).toString();
+            card.kun_reading = query.value(2).toString();
+            card.example_reading = query.value(3).toString();
+            cards.append(card);
+        }
+    }
+    
+    readingIndex->build(cards);
+}
+
+QList<KanjiCard> KanjiDatabase::getKanjiByIds(const QList<int> &ids)
+{
+    flushProgress();
+    QList<KanjiCard> cards;
+    if (ids.isEmpty()) {
+        return cards;
+    }
+    
+    QStringList placeholders;
+    for (int i = 0; i < ids.size(); ++i) {
+        placeholders.append("?");
+    }
+    
+    QSqlQuery query(db);
+    prepareQuery(query, QString("SELECT * FROM kanji WHERE id IN (%1)").arg(placeholders.join(", ")));
+    for (int id : ids) {
+        query.addBindValue(id);
+    }
+    
+    if (!query.exec()) {
+        lastError = "Failed to load kanji: " + query.lastError().text();
+        return cards;
+    }
+    
+    // Return cards in the order of the requested ids
+    QMap<int, KanjiCard> byId;
+    while (query.next()) {
+        KanjiCard card = readCard(query);
+        byId.insert(card.id, card);
+    }
+    for (int id : ids) {
+        if (byId.contains(id)) {
+            cards.append(byId.value(id));
+        }
+    }
+    
+    return cards;
+}
+
+void KanjiDatabase::readRows(QSqlQuery &query, KanjiResultSet &rows)
+{
+    // Column positions once per query rather than a name lookup per field.
+    // The driver still hands each text value over as a temporary QString;
+    // only the copy kept in the arena outlives the row.
+    const QSqlRecord record = query.record();
+    const int id = record.indexOf("id");
+    const int kanji = record.indexOf("kanji");
+    const int meaning = record.indexOf("meaning");
+    const int onReading = record.indexOf("on_reading");
+    const int kunReading = record.indexOf("kun_reading");
+    const int exampleWord = record.indexOf("example_word");
+    const int exampleReading = record.indexOf("example_reading");
+    const int exampleMeaning = record.indexOf("example_meaning");
+    const int difficulty = record.indexOf("difficulty_level");
+    const int learned = record.indexOf("is_learned");
+    const int lastReviewed = record.indexOf("last_reviewed");
+    const int nextReview = record.indexOf("next_review");
+    const int srsLevel = record.indexOf("srs_level");
+    const int reviewCount = record.indexOf("review_count");
+    const int priority = record.indexOf("priority");
+    
+    auto msecs = [&query](int column) {
+        const QDateTime time = query.value(column).toDateTime();
+        return time.isValid() ? time.toMSecsSinceEpoch() : qint64(-1);
+    };
+    
+    while (query.next()) {
+        KanjiCardRow &row = rows.append();
+        row.id = query.value(id).toInt();
+        row.kanji = rows.store(query.value(kanji).toString());
+        row.meaning = rows.store(query.value(meaning).toString());
+        row.on_reading = rows.store(query.value(onReading).toString());
+        row.kun_reading = rows.store(query.value(kunReading).toString());
+        row.example_word = rows.store(query.value(exampleWord).toString());
+        row.example_reading = rows.store(query.value(exampleReading).toString());
+        row.example_meaning = rows.store(query.value(exampleMeaning).toString());
+        row.difficulty_level = query.value(difficulty).toInt();
+        row.is_learned = query.value(learned).toBool();
+        row.last_reviewed_ms = msecs(lastReviewed);
+        row.next_review_ms = msecs(nextReview);
+        row.srs_level = query.value(srsLevel).toInt();
+        row.review_count = query.value(reviewCount).toInt();
+        row.priority = query.value(priority).toLongLong();
+    }
+}
+
+KanjiCard KanjiDatabase::readCard(const QSqlQuery &query)
+{
+    KanjiCard card;
+    card.id = query.value("id").toInt();
+    card.kanji = query.value("kanji").toString();
+    card.meaning = query.value("meaning").toString();
+    card.on_reading = query.value("on_reading").toString();
+    card.kun_reading = query.value("kun_reading").toString();
+    card.example_word = query.value("example_word").toString();
+    card.example_reading = query.value("example_reading").toString();
+    card.example_meaning = query.value("example_meaning").toString();
+    card.difficulty_level = query.value("difficulty_level").toInt();
+    card.is_learned = query.value("is_learned").toBool();
+    card.last_reviewed = query.value("last_reviewed").toDateTime();
+    card.next_review = query.value("next_review").toDateTime();
+    card.srs_level = query.value("srs_level").toInt();
+    card.review_count = query.value("review_count").toInt();
+    card.priority = query.value("priority").toLongLong();
     return card;
 }
 
 bool KanjiDatabase::setImmediateReviewTime(int id, int secondsFromNow)
 {
+    flushProgress();
     QSqlQuery query(db);
-    QDateTime reviewTime = QDateTime::currentDateTime().addSecs(secondsFromNow);
+    QDateTime now = KanjiClock::now();
+    QDateTime reviewTime = now.addSecs(secondsFromNow);
+    KanjiCard currentKanji = getKanjiById(id);
     
-    query.prepare("UPDATE kanji SET next_review = ? WHERE id = ?");
+    prepareQuery(query, "UPDATE kanji SET next_review = ? WHERE id = ?");
     query.addBindValue(reviewTime);
     query.addBindValue(id);
     
@@ -574,13 +2662,34 @@ bool KanjiDatabase::setImmediateReviewTime(int id, int secondsFromNow)
         return false;
     }
     
+    if (currentKanji.is_learned) {
+        bool wasDue = currentKanji.next_review.isValid() && currentKanji.next_review <= now;
+        bool isDue = reviewTime <= now;
+        
+        KanjiChangeSet change;
+        change.kinds = KanjiChangeSet::CardsRescheduled;
+        change.cardIds.append(id);
+        if (isInActiveDeck(id)) {
+            change.reviewDueDelta = int(isDue) - int(wasDue);
+            change.earliestNextReview = isDue ? QDateTime() : reviewTime;
+            change.reschedules.append({id, true, currentKanji.next_review, currentKanji.srs_level,
+                                       true, reviewTime, currentKanji.srs_level});
+        }
+        changeNotifier->post(change);
+    }
+    
     return true;
 }
 
 bool KanjiDatabase::resetAllKanjiToUnlearned()
 {
+    flushProgress(); // Otherwise a later flush would bring the wiped progress back
+    // Bulk update - capture the counts it wipes so listeners get exact deltas
+    int learnedBefore = getLearnedKanjiCount();
+    int dueBefore = getReviewDueCount();
+    
     QSqlQuery query(db);
-    query.prepare(R"(
+    prepareQuery(query, R"(
         UPDATE kanji SET 
             is_learned = FALSE,
             last_reviewed = NULL,
@@ -596,14 +2705,23 @@ bool KanjiDatabase::resetAllKanjiToUnlearned()
     }
     
     qDebug() << "Successfully reset all kanji to unlearned state";
+    
+    KanjiChangeSet change;
+    change.kinds = KanjiChangeSet::CardsReset;
+    change.learnedDelta = -learnedBefore;
+    change.newDelta = learnedBefore;
+    change.reviewDueDelta = -dueBefore;
+    changeNotifier->post(change);
+    
     return true;
 }
 
 void KanjiDatabase::debugShowAllLearnedKanji()
 {
+    flushProgress();
     QSqlQuery query(db);
-    QDateTime now = QDateTime::currentDateTime();
-    query.prepare("SELECT * FROM kanji WHERE is_learned = TRUE ORDER BY next_review");
+    QDateTime now = KanjiClock::now();
+    prepareQuery(query, "SELECT * FROM kanji WHERE is_learned = TRUE ORDER BY next_review");
     
     qDebug() << "=== DEBUG: All Learned Kanji ===";
     qDebug() << "Current time:" << now.toString();
@@ -20,11 +20,22 @@
 #include <QDateTime>
 #include <QString>
 #include <QList>
+#include <QStringList>
 #include <QVariant>
 #include <QMap>
+#include <QHash>
+#include <QPair>
+#include <QVector>
 #include <QDebug>
 #include <stdexcept>
 #include <exception>
+#include <functional>
+#include "kanji_result_set.h"
+
+class KanjiSearchIndex;
+class KanjiReadingIndex;
+class KanjiChangeNotifier;
+class ProgressWriteBuffer;
 
 struct KANJICORE_API KanjiCard {
     int id;
@@ -41,31 +52,199 @@ struct KANJICORE_API KanjiCard {
     QDateTime next_review;
     int srs_level;         // SRS level (1-8)
     int review_count;
+    qint64 priority;       // Corpus frequency, higher is studied first
+};
+
+// Progress of one card as exchanged between devices. Cards are matched by
+// kanji since ids differ between databases that were filled differently.
+struct KANJICORE_API KanjiProgressRecord {
+    QString kanji;
+    bool is_learned;
+    int srs_level;
+    int review_count;
+    QDateTime last_reviewed;
+    QDateTime next_review;
+};
+
+// JLPT level deck; a card can belong to more than one deck
+struct KANJICORE_API KanjiDeck {
+    int id;
+    QString name;
+    int jlpt_level;      // 5 (N5) down to 1 (N1)
+    int card_count;      // Kept current by triggers on kanji_decks and kanji
+    int learned_count;
+};
+
+// Filter and order for browsing the deck a page at a time. Every sort key is
+// backed by an index so a page costs the same anywhere in the deck.
+struct KANJICORE_API KanjiBrowseQuery {
+    enum Status {
+        AllCards,
+        NewCards,
+        LearnedCards,
+        DueCards
+    };
+
+    enum SortKey {
+        SortById,         // Insertion order
+        SortByKanji,
+        SortBySrsLevel,
+        SortByNextReview, // Unscheduled cards sort first ascending, last descending
+        SortByPriority
+    };
+
+    Status status = AllCards;
+    QString text;             // Matched like searchKanji, empty for no text filter
+    SortKey sortKey = SortById;
+    bool descending = false;
+};
+
+// Keyset position: the sort value and id of the last row already read
+struct KANJICORE_API KanjiPageCursor {
+    bool atStart = true;
+    QVariant sortValue;
+    int id = 0;
+};
+
+// One answer as kept in review_log, the history KanjiAnalytics aggregates
+struct KANJICORE_API KanjiReviewEvent {
+    int kanjiId = 0;
+    QDateTime reviewedAt;
+    bool correct = false;
+    int srsLevel = 0;           // Level the card was answered at, 0 while unlearned
+    int difficulty = 1;
+    qint64 elapsedSeconds = -1; // Since the card's previous review, -1 for its first
+};
+
+// review_log as parallel arrays, one index per answer in log order. Appended
+// to by KanjiDatabase::readReviewLog, so a reader only fetches new answers.
+struct KANJICORE_API KanjiReviewColumns {
+    qint64 lastLogId = 0;           // Highest review_log id read so far
+    QVector<int> kanjiId;
+    QVector<qint64> reviewedAt;     // Milliseconds since the epoch
+    QVector<qint32> elapsedSeconds; // -1 for a card's first review, capped at INT_MAX
+    QVector<quint8> correct;        // 0 or 1
+    QVector<quint8> srsLevel;
+    QVector<quint8> difficulty;
+    QVector<quint8> hourOfDay;      // Local time of the answer
+
+    int size() const { return int(kanjiId.size()); }
+};
+
+// Current progress of the cards in the active deck as parallel arrays
+struct KANJICORE_API KanjiCardColumns {
+    QVector<int> id;
+    QVector<quint8> learned;     // 0 or 1
+    QVector<quint8> srsLevel;
+    QVector<qint64> nextReview;  // Milliseconds since the epoch, -1 if not scheduled
+
+    int size() const { return int(id.size()); }
 };
 
 class KANJICORE_API KanjiDatabase
 {
 public:
-    KanjiDatabase();
+    // Each instance owns one named SQLite connection, usable only from the thread
+    // that opens it. The default name keeps the Qt default connection.
+    explicit KanjiDatabase(const QString &connectionName = QString());
     ~KanjiDatabase();
+    
+    // Directory holding the database for every instance; defaults to the app
+    // data location. Set before the first instance opens (tools, soak runs).
+    static void setDataLocation(const QString &directory);
+    
+    // Called with the text of every statement any instance prepares, on the
+    // preparing thread. For auditing query plans (KanjiPlanAudit); set it
+    // before the first instance opens and leave it unset in the app.
+    static void setStatementObserver(const std::function<void(const QString &)> &observer);
 
-    bool initialize();
+    bool initialize(); // Open, create/migrate schema and seed an empty database
+    bool open();       // Open only - schema already set up by initialize() on another connection
     bool createTables();
     bool populateN5Kanji();
+    bool populateN4Kanji();
+    bool importKanjiFile(const QString &path, int *importedCount = nullptr); // TSV, one card per line
+    
+    // Every card with its progress and JLPT decks as a .kcol file (see
+    // KanjiColumnWriter). Import matches cards by kanji: existing cards take
+    // the file's content and progress, new ones are added.
+    bool exportCards(const QString &path, int *exportedCount = nullptr);
+    bool importCards(const QString &path, int *importedCount = nullptr);
+    
+    // Decks. The active deck scopes the study queues and statistics below;
+    // 0 means every card regardless of deck.
+    QList<KanjiDeck> getDecks();
+    void setActiveDeck(int deckId);
+    int activeDeck() const { return activeDeckId; }
     
     // Card operations
     QList<KanjiCard> getNewKanji(int limit = 10);
     QList<KanjiCard> getReviewKanji();
     QList<KanjiCard> getAllKanji();
+    KanjiResultSet getAllKanjiRows(); // Same rows, arena-backed (see KanjiResultSet)
     KanjiCard getKanjiById(int id);
+    QList<KanjiCard> searchKanji(const QString &text, int limit = 20); // Ranked prefix search
+    QList<KanjiCard> findKanjiByReading(const QString &reading, bool prefix = false, int limit = 100);
     bool updateKanjiProgress(int id, bool correct, int difficulty);
     
+    // SRS scheduling: the card's progress after one answer
+    static KanjiCard scheduleAnswer(const KanjiCard &card, bool correct, const QDateTime &now);
+    static int srsIntervalSeconds(int level);
+    
+    // Write-behind progress (see ProgressWriteBuffer): answers are journaled and
+    // committed in batches. Reads that go to SQL flush first, so they never see
+    // stale progress. Only for the connection the answers are written through.
+    bool enableWriteBehind(int flushIntervalMs = 2000);
+    bool flushProgress();
+    bool hasPendingProgress() const; // Answers not committed yet, see notifier()->progressFlushed()
+    
+    // Change tracking for sync (see ProgressSync). Every progress write stamps
+    // the card with a new, increasing sequence number in progress_changelog.
+    // Applied records for cards not in the table yet are kept in pending_progress
+    // and applied when an import or seed adds the card.
+    QString getDeviceId(); // Created on first use
+    QList<KanjiProgressRecord> getProgressChangesSince(qint64 sequence, qint64 *lastSequence = nullptr);
+    bool applyProgressChanges(const QList<KanjiProgressRecord> &records, int *appliedCount = nullptr);
+    static bool remoteProgressWins(const KanjiProgressRecord &remote, const KanjiCard &local);
+    QString getSyncValue(const QString &key);
+    bool setSyncValue(const QString &key, const QString &value);
+    
+    // Online backup of committed data (see DatabaseBackup), for a worker thread
+    // with its own instance. Copies pagesPerStep pages per step where the SQLite
+    // backup API is available, else in one VACUUM INTO; progress is called after
+    // each step with the pages copied and the total, and returning false from it
+    // cancels. Written to path.part and renamed when complete.
+    bool backupTo(const QString &path, int pagesPerStep = 256,
+                  const std::function<bool(int, int)> &progress = {});
+    QString getBackupDirectory(); // Default place for snapshots
+    
+    // Deck browsing: keyset paging, filter and order evaluated in SQL
+    QList<KanjiCard> getKanjiPage(const KanjiBrowseQuery &browse, const KanjiPageCursor &after, int limit);
+    KanjiResultSet getKanjiPageRows(const KanjiBrowseQuery &browse, const KanjiPageCursor &after, int limit);
+    int countKanji(const KanjiBrowseQuery &browse);
+    static KanjiPageCursor cursorAfter(const KanjiCard &card, KanjiBrowseQuery::SortKey sortKey);
+    static KanjiPageCursor cursorAfter(const KanjiCardRow &row, KanjiBrowseQuery::SortKey sortKey);
+    
     // Statistics
     int getTotalKanjiCount();
     int getLearnedKanjiCount();
     int getReviewDueCount();
     int getNewKanjiCount();
+    QDateTime getNextReviewTime(); // Soonest next_review still in the future, invalid if none
     QMap<int, int> getKanjiCountByLevel(); // Get count of kanji at each SRS level
+    // next_review and srs_level of learned cards due before the given time, one
+    // range of idx_kanji_review (see KanjiForecast)
+    QList<QPair<QDateTime, int>> getScheduledReviews(const QDateTime &before);
+    QHash<QString, int> getKanjiSrsLevels(); // Kanji -> SRS level, 0 if not learned yet
+    
+    // Columnar reads for KanjiAnalytics. Review history is appended from after
+    // columns.lastLogId, across every deck and kept through resets; card state
+    // replaces the columns' contents and follows the active deck.
+    bool readReviewLog(KanjiReviewColumns &columns);
+    bool readCardStates(KanjiCardColumns &columns);
+    
+    // New-card ordering: kanji -> corpus occurrences (see KanjiFrequencyBuilder)
+    bool setKanjiPriorities(const QHash<QString, qint64> &counts);
     
     // Testing utilities
     bool setImmediateReviewTime(int id, int secondsFromNow);
@@ -73,13 +252,46 @@ public:
     void debugShowAllLearnedKanji(); // Debug: show all learned kanji and their times
     
     QString getLastError() const { return lastError; }
+    
+    // Emits coalesced counter deltas for every write made through this object
+    KanjiChangeNotifier *notifier() const { return changeNotifier; }
 
 private:
+    static constexpr int MaxBackupRestarts = 3;
+    static constexpr int BackupStepPauseMs = 10; // Lets the GUI connection write between steps
+    
     QSqlDatabase db;
+    QString connectionName;
     QString lastError;
+    KanjiSearchIndex *searchIndex;
+    KanjiReadingIndex *readingIndex; // Built on first reading lookup
+    KanjiChangeNotifier *changeNotifier;
+    int activeDeckId;
+    ProgressWriteBuffer *progressBuffer; // Null unless enableWriteBehind() was called
     
+    static KanjiCard readCard(const QSqlQuery &query);
+    static void readRows(QSqlQuery &query, KanjiResultSet &rows);
+    bool openConnection();
+    bool createDeckTables();
+    bool createSyncTables();
+    bool createReviewLogTable();
+    bool writeProgress(const QList<KanjiCard> &cards, const QList<KanjiReviewEvent> &reviews = {});
+    bool replayProgressJournal();
+    bool keepPendingProgress(const QList<KanjiProgressRecord> &records);
+    bool applyPendingProgress();
+    QString getJournalPath();
+    bool seedDeck(int jlptLevel, const QList<QVariantList> &kanjiData);
+    int deckIdForLevel(int jlptLevel);
+    QString scopedKanji() const;
+    bool isInActiveDeck(int id);
+    void ensureReadingIndex();
+    QList<KanjiCard> getKanjiByIds(const QList<int> &ids);
+    QStringList browseConditions(const KanjiBrowseQuery &browse, QVariantList &values);
+    bool execKanjiPage(QSqlQuery &query, const KanjiBrowseQuery &browse, const KanjiPageCursor &after, int limit);
     bool executeQuery(const QString &query, const QVariantList &values = QVariantList());
+    static bool prepareQuery(QSqlQuery &query, const QString &sql); // Every statement goes through here
     QString getDatabasePath();
+    static QString dataLocation();
 };
 
 #endif // KANJI_DATABASE_H 
\ No newline at end of file
@@ -0,0 +1,102 @@
+#include "kanji_document_analyzer.h"
+#include <QElapsedTimer>
+
+KanjiDocumentAnalyzer::KanjiDocumentAnalyzer(const QHash<QString, int> &srsLevels)
+    : learningOrderLimit(100), threadCount(0)
+{
+    for (auto it = srsLevels.constBegin(); it != srsLevels.constEnd(); ++it) {
+        const QString &kanji = it.key();
+        if (kanji.isEmpty()) {
+            continue;
+        }
+        char32_t codePoint = kanji.at(0).unicode();
+        if (kanji.at(0).isHighSurrogate() && kanji.size() > 1) {
+            codePoint = QChar::surrogateToUcs4(kanji.at(0), kanji.at(1));
+        }
+        levels.insert(codePoint, it.value());
+    }
+}
+
+bool KanjiDocumentAnalyzer::analyzeFile(const QString &path, DocumentAnalysis &result)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    result = DocumentAnalysis();
+    KanjiHistogram histogram;
+    KanjiTextScanner scanner(threadCount);
+
+    if (!scanner.scanFile(path, histogram, &result.stats)) {
+        lastError = scanner.getLastError();
+        return false;
+    }
+
+    classify(histogram, result);
+    result.elapsedMs = timer.elapsed();
+    return true;
+}
+
+DocumentAnalysis KanjiDocumentAnalyzer::analyzeText(const QString &text)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    DocumentAnalysis result;
+    KanjiHistogram histogram;
+    KanjiTextScanner scanner(1);
+    scanner.scanText(text, histogram, &result.stats);
+
+    classify(histogram, result);
+    result.elapsedMs = timer.elapsed();
+    return result;
+}
+
+void KanjiDocumentAnalyzer::classify(const KanjiHistogram &histogram, DocumentAnalysis &result) const
+{
+    QList<KanjiFrequency> notInDeck;
+
+    const auto entries = histogram.entries(); // Most frequent first
+    for (const auto &entry : entries) {
+        const char32_t codePoint = entry.first;
+        const qint64 count = entry.second;
+
+        auto found = levels.constFind(codePoint);
+        const bool inDeck = found != levels.constEnd();
+        const int level = inDeck ? found.value() : 0;
+
+        result.totalKanji += count;
+        ++result.distinctKanji;
+
+        if (level > 0) {
+            result.knownKanji += count;
+            ++result.distinctKnown;
+            continue;
+        }
+
+        KanjiFrequency frequency;
+        frequency.kanji = QString::fromUcs4(&codePoint, 1);
+        frequency.count = count;
+        frequency.inDeck = inDeck;
+        frequency.srsLevel = level;
+        result.unknownKanji.append(frequency);
+
+        // Kanji with a card come first since they can be studied right away,
+        // each group ordered by how much of the text it would unlock
+        if (inDeck) {
+            if (result.learningOrder.size() < learningOrderLimit) {
+                result.learningOrder.append(frequency);
+            }
+        } else if (notInDeck.size() < learningOrderLimit) {
+            notInDeck.append(frequency);
+        }
+    }
+
+    for (const KanjiFrequency &frequency : notInDeck) {
+        if (result.learningOrder.size() >= learningOrderLimit) {
+            break;
+        }
+        result.learningOrder.append(frequency);
+    }
+
+    result.coverage = result.totalKanji > 0 ? (result.knownKanji * 100.0) / result.totalKanji : 100.0;
+}
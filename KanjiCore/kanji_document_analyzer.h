@@ -0,0 +1,65 @@
+#ifndef KANJI_DOCUMENT_ANALYZER_H
+#define KANJI_DOCUMENT_ANALYZER_H
+
+// DLL Export/Import macros
+#ifdef _WIN32
+    #ifdef KANJICORE_EXPORTS
+        #define KANJICORE_API __declspec(dllexport)
+    #else
+        #define KANJICORE_API __declspec(dllimport)
+    #endif
+#else
+    #define KANJICORE_API
+#endif
+
+#include <QString>
+#include <QList>
+#include <QHash>
+#include "kanji_text_scanner.h"
+
+struct KANJICORE_API KanjiFrequency {
+    QString kanji;
+    qint64 count;
+    bool inDeck;    // Card exists and can be studied right away
+    int srsLevel;   // 0 when not learned yet
+};
+
+struct KANJICORE_API DocumentAnalysis {
+    qint64 totalKanji = 0;       // Kanji occurrences in the text
+    qint64 knownKanji = 0;       // Occurrences of kanji the learner has learned
+    int distinctKanji = 0;
+    int distinctKnown = 0;
+    double coverage = 0.0;       // Percent of kanji occurrences already known
+    QList<KanjiFrequency> unknownKanji;   // Most frequent first
+    QList<KanjiFrequency> learningOrder;  // Suggested next kanji to study
+    TextScanStats stats;
+    qint64 elapsedMs = 0;
+};
+
+// Classifies the kanji of an arbitrary text against the learner's SRS state.
+// The text is scanned by KanjiTextScanner; lookups run once per distinct
+// kanji after the per-thread histograms are merged, not per occurrence.
+class KANJICORE_API KanjiDocumentAnalyzer
+{
+public:
+    // Kanji -> SRS level as returned by KanjiDatabase::getKanjiSrsLevels()
+    explicit KanjiDocumentAnalyzer(const QHash<QString, int> &srsLevels);
+
+    bool analyzeFile(const QString &path, DocumentAnalysis &result);
+    DocumentAnalysis analyzeText(const QString &text);
+
+    void setLearningOrderLimit(int limit) { learningOrderLimit = limit; }
+    void setThreadCount(int threads) { threadCount = threads; }
+
+    QString getLastError() const { return lastError; }
+
+private:
+    void classify(const KanjiHistogram &histogram, DocumentAnalysis &result) const;
+
+    QHash<char32_t, int> levels; // Keyed by code point for the merge step
+    int learningOrderLimit;
+    int threadCount;
+    QString lastError;
+};
+
+#endif // KANJI_DOCUMENT_ANALYZER_H
@@ -0,0 +1,204 @@
+#include "kanji_forecast.h"
+#include "kanji_database.h"
+#include "kanji_clock.h"
+#include <cmath>
+
+// Hourly values from the current bucket on, summed per local day from today
+template <typename T>
+static QVector<T> foldDaily(const QVector<T> &hourly, const QDateTime &firstHour, int days)
+{
+    QVector<T> daily(days, T());
+    const QDate today = KanjiClock::now().date();
+    for (int i = 0; i < hourly.size(); ++i) {
+        const qint64 day = today.daysTo(firstHour.addSecs(qint64(i) * KanjiForecast::BucketSeconds).date());
+        if (day >= 0 && day < days) {
+            daily[int(day)] += hourly[i];
+        }
+    }
+    return daily;
+}
+
+KanjiForecast::KanjiForecast(KanjiDatabase *database, int horizonDays, QObject *parent)
+    : QObject(parent), database(database), horizon(qMax(1, horizonDays)), stale(true)
+{
+    connect(database->notifier(), &KanjiChangeNotifier::changed, this, &KanjiForecast::applyChange);
+}
+
+void KanjiForecast::rebuild()
+{
+    const QDateTime now = KanjiClock::now();
+    origin = QDateTime(now.date(), QTime(now.time().hour(), 0));
+    counts.fill(0, bucketCount() * LevelCount);
+
+    const QDateTime end = origin.addSecs(qint64(bucketCount()) * BucketSeconds);
+    for (const QPair<QDateTime, int> &review : database->getScheduledReviews(end)) {
+        adjust(review.first, review.second, 1);
+    }
+    stale = false;
+}
+
+void KanjiForecast::ensureCurrent()
+{
+    // The slack lets the window slide a week before the far end needs a re-read
+    if (stale || currentBucket() + horizon * 24 > bucketCount()) {
+        rebuild();
+    }
+}
+
+int KanjiForecast::currentBucket() const
+{
+    return int(qMax<qint64>(0, origin.secsTo(KanjiClock::now()) / BucketSeconds));
+}
+
+int KanjiForecast::bucketFor(const QDateTime &time) const
+{
+    if (!time.isValid()) {
+        return -1;
+    }
+    // Anything overdue when the histogram was built shares the first bucket
+    const qint64 bucket = qMax<qint64>(0, origin.secsTo(time) / BucketSeconds);
+    return bucket < bucketCount() ? int(bucket) : -1;
+}
+
+void KanjiForecast::adjust(const QDateTime &time, int level, int delta)
+{
+    const int bucket = bucketFor(time);
+    if (bucket < 0) {
+        return;
+    }
+    int &count = counts[bucket * LevelCount + qBound(0, level, LevelCount - 1)];
+    count = qMax(0, count + delta);
+}
+
+void KanjiForecast::applyChange(const KanjiChangeSet &change)
+{
+    if (change.kinds & (KanjiChangeSet::CardsReset | KanjiChangeSet::CardsImported | KanjiChangeSet::ScopeChanged)) {
+        stale = true;
+        emit forecastChanged();
+        return;
+    }
+    if (stale || change.reschedules.isEmpty()) {
+        return;
+    }
+
+    // Each answer moves one card between buckets
+    for (const KanjiReschedule &reschedule : change.reschedules) {
+        if (reschedule.wasLearned) {
+            adjust(reschedule.fromReview, reschedule.fromLevel, -1);
+        }
+        if (reschedule.isLearned) {
+            adjust(reschedule.toReview, reschedule.toLevel, 1);
+        }
+    }
+    emit forecastChanged();
+}
+
+QVector<int> KanjiForecast::hourlyDue(int hours)
+{
+    ensureCurrent();
+    hours = qBound(0, hours, horizon * 24);
+    QVector<int> due(hours, 0);
+    if (hours == 0) {
+        return due;
+    }
+
+    const int first = currentBucket();
+    for (int bucket = 0; bucket < first + hours && bucket < bucketCount(); ++bucket) {
+        int total = 0;
+        for (int level = 0; level < LevelCount; ++level) {
+            total += counts[bucket * LevelCount + level];
+        }
+        due[qMax(0, bucket - first)] += total;
+    }
+    return due;
+}
+
+QVector<int> KanjiForecast::dailyDue(int days)
+{
+    days = qBound(0, days, horizon);
+    const QVector<int> hourly = hourlyDue(days * 24 + 1); // One spare hour for a DST day
+    return foldDaily(hourly, origin.addSecs(qint64(currentBucket()) * BucketSeconds), days);
+}
+
+QVector<double> KanjiForecast::simulateHourly(int hours, double accuracy, int newCardsPerDay)
+{
+    ensureCurrent();
+    hours = qBound(0, hours, horizon * 24);
+    accuracy = qBound(0.0, accuracy, 1.0);
+    QVector<double> reviews(hours, 0.0);
+    if (hours == 0) {
+        return reviews;
+    }
+
+    // Steps no longer than the shortest interval, so each follow-up review
+    // falls in a later step than the one it came from
+    int step = BucketSeconds;
+    for (int level = 1; level < LevelCount; ++level) {
+        step = qMin(step, KanjiDatabase::srsIntervalSeconds(level));
+    }
+    step = qMax(1, step);
+    auto stepsFor = [step](int level) {
+        return qMax<qint64>(1, qRound64(double(KanjiDatabase::srsIntervalSeconds(level)) / step));
+    };
+    qint64 longest = 0;
+    for (int level = 1; level < LevelCount; ++level) {
+        longest = qMax(longest, stepsFor(level));
+    }
+
+    // Expected cards per level coming due in each step, in a ring long
+    // enough for the longest interval
+    const qint64 totalSteps = (qint64(hours) * BucketSeconds + step - 1) / step;
+    const qint64 ringSteps = qMin(longest, totalSteps) + 1;
+    QVector<double> ring(int(ringSteps) * LevelCount, 0.0);
+    auto schedule = [&](qint64 at, int level, double cards) {
+        if (at < totalSteps) {
+            ring[int(at % ringSteps) * LevelCount + level] += cards;
+        }
+    };
+
+    const int first = currentBucket();
+    const QDateTime firstHour = origin.addSecs(qint64(first) * BucketSeconds);
+    int hour = -1;
+    for (qint64 at = 0; at < totalSteps; ++at) {
+        const int stepHour = int(at * step / BucketSeconds);
+        if (stepHour != hour) {
+            // Cards already scheduled in this hour, everything overdue with the first
+            hour = stepHour;
+            const int bucket = first + hour;
+            for (int from = hour == 0 ? 0 : bucket; from <= bucket && from < bucketCount(); ++from) {
+                for (int level = 0; level < LevelCount; ++level) {
+                    schedule(at, level, counts[from * LevelCount + level]);
+                }
+            }
+            const QDate date = firstHour.addSecs(qint64(hour) * BucketSeconds).date();
+            if (newCardsPerDay > 0 && hour > 0 &&
+                date != firstHour.addSecs(qint64(hour - 1) * BucketSeconds).date()) {
+                schedule(at + stepsFor(1), 1, newCardsPerDay);
+            }
+        }
+
+        double *due = &ring[int(at % ringSteps) * LevelCount];
+        for (int level = 0; level < LevelCount; ++level) {
+            const double cards = due[level];
+            if (cards == 0.0) {
+                continue;
+            }
+            due[level] = 0.0;
+            reviews[hour] += cards;
+
+            // As scheduleAnswer: up a level when right, down to at least 1 when wrong
+            const int up = level == 0 ? 1 : qMin(level + 1, LevelCount - 1);
+            const int down = qMax(level - 1, 1);
+            schedule(at + stepsFor(up), up, cards * accuracy);
+            schedule(at + stepsFor(down), down, cards * (1.0 - accuracy));
+        }
+    }
+    return reviews;
+}
+
+QVector<double> KanjiForecast::simulateDaily(int days, double accuracy, int newCardsPerDay)
+{
+    days = qBound(0, days, horizon);
+    const QVector<double> hourly = simulateHourly(days * 24 + 1, accuracy, newCardsPerDay);
+    return foldDaily(hourly, origin.addSecs(qint64(currentBucket()) * BucketSeconds), days);
+}
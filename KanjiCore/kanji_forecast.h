@@ -0,0 +1,75 @@
+#ifndef KANJI_FORECAST_H
+#define KANJI_FORECAST_H
+
+// DLL Export/Import macros
+#ifdef _WIN32
+    #ifdef KANJICORE_EXPORTS
+        #define KANJICORE_API __declspec(dllexport)
+    #else
+        #define KANJICORE_API __declspec(dllimport)
+    #endif
+#else
+    #define KANJICORE_API
+#endif
+
+#include <QObject>
+#include <QDateTime>
+#include <QVector>
+#include "kanji_change_notifier.h"
+
+class KanjiDatabase;
+
+// Review load for the coming days in the active deck: learned cards counted
+// per hour of next_review and SRS level. Built in one indexed read, then kept
+// current from the database's change notifications, so reading the forecast
+// only touches the histogram. Rebuilt after bulk changes and when the window
+// has slid past the slack read beyond the horizon. GUI thread only, on the
+// database's own connection.
+class KANJICORE_API KanjiForecast : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr int BucketSeconds = 3600;
+    static constexpr int DefaultHorizonDays = 30;
+    static constexpr int SlackDays = 7;
+    static constexpr int LevelCount = 9; // SRS levels 0-8
+
+    explicit KanjiForecast(KanjiDatabase *database, int horizonDays = DefaultHorizonDays, QObject *parent = nullptr);
+
+    int horizonDays() const { return horizon; }
+
+    // Reviews already scheduled, from the current hour or today on. The first
+    // entry includes everything overdue.
+    QVector<int> hourlyDue(int hours);
+    QVector<int> dailyDue(int days);
+
+    // Expected reviews per hour or day when every due card is answered at its
+    // due time with the given accuracy and rescheduled with the active SRS
+    // intervals, plus newCardsPerDay learned at the start of each day
+    QVector<double> simulateHourly(int hours, double accuracy, int newCardsPerDay = 0);
+    QVector<double> simulateDaily(int days, double accuracy, int newCardsPerDay = 0);
+
+    void rebuild(); // One read of the schedule; done on demand when stale
+
+signals:
+    void forecastChanged();
+
+private slots:
+    void applyChange(const KanjiChangeSet &change);
+
+private:
+    void ensureCurrent();
+    int currentBucket() const;
+    int bucketFor(const QDateTime &time) const; // -1 when past the histogram
+    void adjust(const QDateTime &time, int level, int delta);
+    int bucketCount() const { return (horizon + SlackDays) * 24; }
+
+    KanjiDatabase *database;
+    int horizon;
+    bool stale;
+    QDateTime origin;      // Start of the first bucket, a whole local hour
+    QVector<int> counts;   // bucket * LevelCount + level
+};
+
+#endif // KANJI_FORECAST_H
@@ -0,0 +1,106 @@
+#include "kanji_frequency_builder.h"
+#include <QDirIterator>
+#include <QFileInfo>
+#include <QThread>
+#include <QThreadPool>
+#include <QAtomicInt>
+#include <QMutex>
+#include <QVector>
+
+KanjiFrequencyBuilder::KanjiFrequencyBuilder(int threads)
+    : threadCount(threads > 0 ? threads : qMax(1, QThread::idealThreadCount()))
+{
+}
+
+void KanjiFrequencyBuilder::addFile(const QString &path)
+{
+    files.append(path);
+}
+
+void KanjiFrequencyBuilder::addDirectory(const QString &path, const QStringList &nameFilters)
+{
+    QDirIterator it(path, nameFilters, QDir::Files | QDir::Readable, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        files.append(it.next());
+    }
+}
+
+bool KanjiFrequencyBuilder::build()
+{
+    merged.clear();
+    scanStats = TextScanStats();
+    failures.clear();
+
+    if (files.isEmpty()) {
+        lastError = "No text files to scan";
+        return false;
+    }
+
+    QStringList smallFiles;
+    QStringList largeFiles;
+    for (const QString &path : files) {
+        if (QFileInfo(path).size() >= LargeFileSize) {
+            largeFiles.append(path);
+        } else {
+            smallFiles.append(path);
+        }
+    }
+
+    // Large files already use every core through chunking, scan them one by one
+    KanjiTextScanner chunkedScanner(threadCount);
+    for (const QString &path : largeFiles) {
+        if (!chunkedScanner.scanFile(path, merged, &scanStats)) {
+            failures.append(path);
+        }
+    }
+
+    // Small files: one task per worker thread, each pulling the next file
+    const int workerCount = qMax(1, qMin(threadCount, int(smallFiles.size())));
+    QVector<KanjiHistogram> workerHistograms(workerCount);
+    QVector<TextScanStats> workerStats(workerCount);
+    KanjiHistogram *histogramSlots = workerHistograms.data();
+    TextScanStats *statsSlots = workerStats.data();
+    const QStringList pending = smallFiles;
+    QAtomicInt nextFile(0);
+    QMutex failureMutex;
+    QStringList &failureList = failures;
+
+    QThreadPool pool;
+    pool.setMaxThreadCount(workerCount);
+    for (int worker = 0; worker < workerCount && !pending.isEmpty(); ++worker) {
+        pool.start([=, &nextFile, &failureMutex, &failureList]() {
+            KanjiTextScanner scanner(1);
+            for (int index = nextFile.fetchAndAddRelaxed(1); index < pending.size();
+                 index = nextFile.fetchAndAddRelaxed(1)) {
+                if (!scanner.scanFile(pending.at(index), histogramSlots[worker], &statsSlots[worker])) {
+                    QMutexLocker locker(&failureMutex);
+                    failureList.append(pending.at(index));
+                }
+            }
+        });
+    }
+    pool.waitForDone();
+
+    for (int worker = 0; worker < workerCount; ++worker) {
+        merged.merge(workerHistograms[worker]);
+        scanStats.merge(workerStats[worker]);
+    }
+
+    if (failures.size() == files.size()) {
+        lastError = "None of the text files could be read";
+        return false;
+    }
+
+    return true;
+}
+
+QHash<QString, qint64> KanjiFrequencyBuilder::counts() const
+{
+    QHash<QString, qint64> result;
+    const auto entries = merged.entries();
+    result.reserve(entries.size());
+    for (const auto &entry : entries) {
+        result.insert(QString::fromUcs4(&entry.first, 1), entry.second);
+    }
+    return result;
+}
@@ -0,0 +1,53 @@
+#ifndef KANJI_FREQUENCY_BUILDER_H
+#define KANJI_FREQUENCY_BUILDER_H
+
+// DLL Export/Import macros
+#ifdef _WIN32
+    #ifdef KANJICORE_EXPORTS
+        #define KANJICORE_API __declspec(dllexport)
+    #else
+        #define KANJICORE_API __declspec(dllimport)
+    #endif
+#else
+    #define KANJICORE_API
+#endif
+
+#include <QString>
+#include <QStringList>
+#include <QHash>
+#include "kanji_text_scanner.h"
+
+// Counts kanji occurrences over a set of local text files to rank new cards.
+// Small files are spread across a thread pool, one file per task, with a
+// histogram per worker thread; large files are chunked by KanjiTextScanner
+// instead. All histograms are merged once at the end.
+class KANJICORE_API KanjiFrequencyBuilder
+{
+public:
+    explicit KanjiFrequencyBuilder(int threadCount = 0); // 0 = ideal thread count
+
+    void addFile(const QString &path);
+    void addDirectory(const QString &path, const QStringList &nameFilters = {"*.txt"});
+    int getFileCount() const { return files.size(); }
+
+    bool build();
+
+    const KanjiHistogram &histogram() const { return merged; }
+    const TextScanStats &stats() const { return scanStats; }
+    QHash<QString, qint64> counts() const; // Kanji -> occurrences, input for setKanjiPriorities
+    QStringList failedFiles() const { return failures; }
+
+    QString getLastError() const { return lastError; }
+
+private:
+    static constexpr qint64 LargeFileSize = 64 * 1024 * 1024;
+
+    int threadCount;
+    QStringList files;
+    KanjiHistogram merged;
+    TextScanStats scanStats;
+    QStringList failures;
+    QString lastError;
+};
+
+#endif // KANJI_FREQUENCY_BUILDER_H
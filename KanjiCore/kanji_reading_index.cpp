@@ -0,0 +1,348 @@
+#include "kanji_reading_index.h"
+#include "kanji_database.h"
+#include "japanese_text_utils.h"
+#include <QRegularExpression>
+#include <QHash>
+#include <QSet>
+#include <algorithm>
+
+namespace {
+
+struct ReadingEntry {
+    QString key;
+    ReadingPosting posting;
+};
+
+void collectReadings(QVector<ReadingEntry> &entries, int cardId, const QString &readings, quint8 source)
+{
+    // A field may list several readings, e.g. "ひと/ひとつ" or "にち、じつ"
+    static const QRegularExpression separators("[/,;\\x{3001}\\x{30FB}\\s]+");
+
+    const QStringList parts = readings.split(separators, Qt::SkipEmptyParts);
+    for (const QString &part : parts) {
+        QString key = KanjiReadingIndex::normalizeKey(part);
+        if (!key.isEmpty()) {
+            entries.append({key, {cardId, source}});
+        }
+    }
+}
+
+// Merges b into a, both sorted by card id, combining sources of equal ids
+QVector<ReadingPosting> mergePostings(const QVector<ReadingPosting> &a, const QVector<ReadingPosting> &b)
+{
+    QVector<ReadingPosting> merged;
+    merged.reserve(a.size() + b.size());
+
+    int i = 0;
+    int j = 0;
+    while (i < a.size() || j < b.size()) {
+        if (j >= b.size() || (i < a.size() && a[i].cardId < b[j].cardId)) {
+            merged.append(a[i++]);
+        } else if (i >= a.size() || b[j].cardId < a[i].cardId) {
+            merged.append(b[j++]);
+        } else {
+            merged.append({a[i].cardId, quint8(a[i].sources | b[j].sources)});
+            ++i;
+            ++j;
+        }
+    }
+
+    return merged;
+}
+
+} // namespace
+
+KanjiReadingIndex::KanjiReadingIndex()
+{
+}
+
+void KanjiReadingIndex::clear()
+{
+    keyData.clear();
+    records.clear();
+    postings.clear();
+}
+
+void KanjiReadingIndex::build(const QList<KanjiCard> &cards)
+{
+    clear();
+    addCards(cards);
+}
+
+void KanjiReadingIndex::addCards(const QList<KanjiCard> &cards)
+{
+    if (cards.isEmpty()) {
+        return;
+    }
+
+    QVector<ReadingEntry> entries;
+    QSet<int> incomingIds;
+    for (const KanjiCard &card : cards) {
+        incomingIds.insert(card.id);
+        collectReadings(entries, card.id, card.on_reading, OnReading);
+        collectReadings(entries, card.id, card.kun_reading, KunReading);
+        collectReadings(entries, card.id, card.example_reading, ExampleReading);
+    }
+
+    std::sort(entries.begin(), entries.end(), [](const ReadingEntry &a, const ReadingEntry &b) {
+        int order = QString::compare(a.key, b.key);
+        return order < 0 || (order == 0 && a.posting.cardId < b.posting.cardId);
+    });
+
+    // Group the new entries by key
+    QVector<KeyPostings> incoming;
+    for (const ReadingEntry &entry : entries) {
+        if (incoming.isEmpty() || incoming.last().key != entry.key) {
+            incoming.append({entry.key, {}});
+        }
+        QVector<ReadingPosting> &list = incoming.last().postings;
+        if (!list.isEmpty() && list.last().cardId == entry.posting.cardId) {
+            list.last().sources |= entry.posting.sources;
+        } else {
+            list.append(entry.posting);
+        }
+    }
+
+    // Drop stale postings of re-imported cards from the current index
+    QVector<KeyPostings> existing = decodeAll();
+    for (KeyPostings &keyPostings : existing) {
+        keyPostings.postings.erase(
+            std::remove_if(keyPostings.postings.begin(), keyPostings.postings.end(),
+                           [&incomingIds](const ReadingPosting &posting) {
+                               return incomingIds.contains(posting.cardId);
+                           }),
+            keyPostings.postings.end());
+    }
+
+    // Linear merge of two sorted key lists
+    QVector<KeyPostings> merged;
+    merged.reserve(existing.size() + incoming.size());
+    int i = 0;
+    int j = 0;
+    while (i < existing.size() || j < incoming.size()) {
+        int order;
+        if (i >= existing.size()) {
+            order = 1;
+        } else if (j >= incoming.size()) {
+            order = -1;
+        } else {
+            order = QString::compare(existing[i].key, incoming[j].key);
+        }
+
+        if (order < 0) {
+            if (!existing[i].postings.isEmpty()) {
+                merged.append(existing[i]);
+            }
+            ++i;
+        } else if (order > 0) {
+            merged.append(incoming[j++]);
+        } else {
+            merged.append({incoming[j].key, mergePostings(existing[i].postings, incoming[j].postings)});
+            ++i;
+            ++j;
+        }
+    }
+
+    encode(merged);
+}
+
+QList<ReadingPosting> KanjiReadingIndex::find(const QString &reading) const
+{
+    QList<ReadingPosting> result;
+    QString key = normalizeKey(reading);
+    if (key.isEmpty()) {
+        return result;
+    }
+
+    int index = lowerBound(key);
+    if (index < records.size() && keyAt(index) == key) {
+        const KeyRecord &record = records[index];
+        for (quint32 p = 0; p < record.postingCount; ++p) {
+            result.append(postings[record.postingOffset + p]);
+        }
+    }
+
+    return result;
+}
+
+QList<ReadingPosting> KanjiReadingIndex::findPrefix(const QString &prefix, int limit) const
+{
+    QList<ReadingPosting> result;
+    QString key = normalizeKey(prefix);
+    if (key.isEmpty()) {
+        return result;
+    }
+
+    // Shorter keys sort first, so exact and near matches come out ahead
+    QHash<int, int> positions; // card id -> index in result
+    int index = lowerBound(key);
+    QString current = index < records.size() ? keyAt(index) : QString();
+
+    while (index < records.size() && current.startsWith(key)) {
+        const KeyRecord &record = records[index];
+        for (quint32 p = 0; p < record.postingCount; ++p) {
+            const ReadingPosting &posting = postings[record.postingOffset + p];
+            auto found = positions.constFind(posting.cardId);
+            if (found != positions.constEnd()) {
+                result[found.value()].sources |= posting.sources;
+                continue;
+            }
+            if (limit >= 0 && result.size() >= limit) {
+                return result;
+            }
+            positions.insert(posting.cardId, result.size());
+            result.append(posting);
+        }
+
+        if (++index < records.size()) {
+            stepKey(index, current);
+        }
+    }
+
+    return result;
+}
+
+QStringList KanjiReadingIndex::keysWithPrefix(const QString &prefix, int limit) const
+{
+    QStringList keys;
+    QString key = normalizeKey(prefix);
+    if (key.isEmpty()) {
+        return keys;
+    }
+
+    int index = lowerBound(key);
+    QString current = index < records.size() ? keyAt(index) : QString();
+
+    while (index < records.size() && current.startsWith(key) && keys.size() < limit) {
+        keys.append(current);
+        if (++index < records.size()) {
+            stepKey(index, current);
+        }
+    }
+
+    return keys;
+}
+
+QString KanjiReadingIndex::normalizeKey(const QString &reading)
+{
+    QString key;
+    key.reserve(reading.size());
+
+    for (QChar ch : reading) {
+        char16_t c = JapaneseTextUtils::toHiragana(ch.unicode());
+        if ((c >= 0x3041 && c <= 0x3096) || c == 0x30FC) {
+            key.append(QChar(c));
+        }
+    }
+
+    return key;
+}
+
+QStringView KanjiReadingIndex::suffix(int index) const
+{
+    const KeyRecord &record = records[index];
+    return QStringView(keyData).mid(record.suffixOffset, record.suffixLength);
+}
+
+void KanjiReadingIndex::stepKey(int index, QString &key) const
+{
+    // Turns the key at index - 1 into the key at index
+    key.truncate(records[index].sharedLength);
+    key.append(suffix(index));
+}
+
+QString KanjiReadingIndex::keyAt(int index) const
+{
+    int restart = index - index % BlockSize;
+    QString key = suffix(restart).toString();
+    for (int i = restart + 1; i <= index; ++i) {
+        stepKey(i, key);
+    }
+    return key;
+}
+
+int KanjiReadingIndex::lowerBound(QStringView target) const
+{
+    // Find the last restart point whose key is <= target
+    const int blockCount = (records.size() + BlockSize - 1) / BlockSize;
+    int low = 0;
+    int high = blockCount;
+    while (low < high) {
+        int middle = (low + high) / 2;
+        if (suffix(middle * BlockSize).compare(target) <= 0) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+
+    if (low == 0) {
+        return 0;
+    }
+
+    // Decode the block sequentially until a key reaches target
+    const int begin = (low - 1) * BlockSize;
+    const int end = qMin(begin + BlockSize, int(records.size()));
+    QString key = suffix(begin).toString();
+    for (int i = begin; i < end; ++i) {
+        if (i > begin) {
+            stepKey(i, key);
+        }
+        if (QStringView(key).compare(target) >= 0) {
+            return i;
+        }
+    }
+
+    return end;
+}
+
+QVector<KanjiReadingIndex::KeyPostings> KanjiReadingIndex::decodeAll() const
+{
+    QVector<KeyPostings> keys;
+    keys.reserve(records.size());
+
+    QString key;
+    for (int i = 0; i < records.size(); ++i) {
+        stepKey(i, key);
+        const KeyRecord &record = records[i];
+        keys.append({key, QVector<ReadingPosting>(postings.cbegin() + record.postingOffset,
+                                                  postings.cbegin() + record.postingOffset + record.postingCount)});
+    }
+
+    return keys;
+}
+
+void KanjiReadingIndex::encode(const QVector<KeyPostings> &keys)
+{
+    clear();
+    records.reserve(keys.size());
+
+    const QString *previous = nullptr;
+    for (int i = 0; i < keys.size(); ++i) {
+        const QString &key = keys[i].key;
+
+        int shared = 0;
+        if (i % BlockSize != 0 && previous) {
+            const int limit = qMin(qMin(previous->size(), key.size()), qsizetype(0xFFFF));
+            while (shared < limit && previous->at(shared) == key.at(shared)) {
+                ++shared;
+            }
+        }
+
+        KeyRecord record;
+        record.suffixOffset = quint32(keyData.size());
+        record.sharedLength = quint16(shared);
+        record.suffixLength = quint16(qMin(key.size() - shared, qsizetype(0xFFFF)));
+        record.postingOffset = quint32(postings.size());
+        record.postingCount = quint32(keys[i].postings.size());
+
+        keyData.append(QStringView(key).mid(shared, record.suffixLength));
+        postings.append(keys[i].postings);
+        records.append(record);
+        previous = &key;
+    }
+
+    keyData.squeeze();
+    records.squeeze();
+    postings.squeeze();
+}
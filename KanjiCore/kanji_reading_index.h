@@ -0,0 +1,90 @@
+#ifndef KANJI_READING_INDEX_H
+#define KANJI_READING_INDEX_H
+
+// DLL Export/Import macros
+#ifdef _WIN32
+    #ifdef KANJICORE_EXPORTS
+        #define KANJICORE_API __declspec(dllexport)
+    #else
+        #define KANJICORE_API __declspec(dllimport)
+    #endif
+#else
+    #define KANJICORE_API
+#endif
+
+#include <QString>
+#include <QStringList>
+#include <QStringView>
+#include <QVector>
+#include <QList>
+
+struct KanjiCard;
+
+struct KANJICORE_API ReadingPosting {
+    int cardId;
+    quint8 sources; // KanjiReadingIndex::Source flags that produced the match
+};
+
+// In-memory inverted index from normalized hiragana readings to card ids.
+// Keys live in one sorted, front-coded array: every BlockSize-th key is a
+// restart point stored in full, the rest only store what differs from the
+// previous key. Lookups binary search the restart points and decode at most
+// one block, prefix enumeration walks forward from there.
+class KANJICORE_API KanjiReadingIndex
+{
+public:
+    enum Source : quint8 {
+        OnReading = 1,
+        KunReading = 2,
+        ExampleReading = 4
+    };
+
+    KanjiReadingIndex();
+
+    void clear();
+    void build(const QList<KanjiCard> &cards);
+
+    // Merges imported cards into the existing arrays without touching the
+    // database. Cards that are already indexed have their postings replaced.
+    void addCards(const QList<KanjiCard> &cards);
+
+    QList<ReadingPosting> find(const QString &reading) const;
+    QList<ReadingPosting> findPrefix(const QString &prefix, int limit = -1) const;
+    QStringList keysWithPrefix(const QString &prefix, int limit = 50) const;
+
+    int keyCount() const { return records.size(); }
+    int postingCount() const { return postings.size(); }
+    bool isEmpty() const { return records.isEmpty(); }
+
+    // Katakana folded to hiragana, everything but kana and "ー" dropped
+    static QString normalizeKey(const QString &reading);
+
+private:
+    static constexpr int BlockSize = 16;
+
+    struct KeyRecord {
+        quint32 suffixOffset;  // Into keyData
+        quint16 sharedLength;  // Characters shared with the previous key, 0 at restarts
+        quint16 suffixLength;
+        quint32 postingOffset; // Into postings, sorted by card id
+        quint32 postingCount;
+    };
+
+    struct KeyPostings {
+        QString key;
+        QVector<ReadingPosting> postings;
+    };
+
+    QStringView suffix(int index) const;
+    QString keyAt(int index) const;
+    void stepKey(int index, QString &key) const;
+    int lowerBound(QStringView target) const;
+    QVector<KeyPostings> decodeAll() const;
+    void encode(const QVector<KeyPostings> &keys);
+
+    QString keyData;               // Concatenated key suffixes
+    QVector<KeyRecord> records;    // One per distinct key, sorted
+    QVector<ReadingPosting> postings;
+};
+
+#endif // KANJI_READING_INDEX_H
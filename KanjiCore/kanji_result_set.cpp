@@ -0,0 +1,150 @@
+#include "kanji_result_set.h"
+#include "kanji_database.h"
+#include <cstring>
+#include <new>
+#include <type_traits>
+
+// The arena never runs destructors
+static_assert(std::is_trivially_destructible_v<KanjiCardRow>, "KanjiCardRow must not own memory");
+
+KanjiArena::KanjiArena(qsizetype blockSize)
+    : blockSize(blockSize), cursor(nullptr), limit(nullptr), reserved(0), used(0)
+{
+}
+
+KanjiArena::~KanjiArena()
+{
+    for (char *block : blocks) {
+        ::operator delete(block);
+    }
+}
+
+void *KanjiArena::allocate(qsizetype size, qsizetype alignment)
+{
+    quintptr address = (quintptr(cursor) + quintptr(alignment - 1)) & ~quintptr(alignment - 1);
+    if (!cursor || address + quintptr(size) > quintptr(limit)) {
+        // Oversized requests get a block of their own size
+        const qsizetype capacity = qMax(blockSize, size + alignment);
+        char *block = static_cast<char *>(::operator new(size_t(capacity)));
+        blocks.append(block);
+        reserved += capacity;
+        cursor = block;
+        limit = block + capacity;
+        address = (quintptr(cursor) + quintptr(alignment - 1)) & ~quintptr(alignment - 1);
+    }
+
+    cursor = reinterpret_cast<char *>(address + quintptr(size));
+    used += size;
+    return reinterpret_cast<void *>(address);
+}
+
+QStringView KanjiArena::copy(QStringView text)
+{
+    if (text.isEmpty()) {
+        return QStringView();
+    }
+    auto *data = static_cast<char16_t *>(allocate(text.size() * qsizetype(sizeof(char16_t)), alignof(char16_t)));
+    memcpy(data, text.utf16(), size_t(text.size()) * sizeof(char16_t));
+    return QStringView(data, text.size());
+}
+
+QDateTime KanjiCardRow::lastReviewed() const
+{
+    return last_reviewed_ms >= 0 ? QDateTime::fromMSecsSinceEpoch(last_reviewed_ms) : QDateTime();
+}
+
+QDateTime KanjiCardRow::nextReview() const
+{
+    return next_review_ms >= 0 ? QDateTime::fromMSecsSinceEpoch(next_review_ms) : QDateTime();
+}
+
+KanjiCard KanjiCardRow::toCard() const
+{
+    KanjiCard card;
+    card.id = id;
+    card.kanji = kanji.toString();
+    card.meaning = meaning.toString();
+    card.on_reading = on_reading.toString();
+    card.kun_reading = kun_reading.toString();
+    card.example_word = example_word.toString();
+    card.example_reading = example_reading.toString();
+    card.example_meaning = example_meaning.toString();
+    card.difficulty_level = difficulty_level;
+    card.is_learned = is_learned;
+    card.last_reviewed = lastReviewed();
+    card.next_review = nextReview();
+    card.srs_level = srs_level;
+    card.review_count = review_count;
+    card.priority = priority;
+    return card;
+}
+
+KanjiResultSet::KanjiResultSet()
+    : arena(new KanjiArena()), rowCount(0), strings(0)
+{
+}
+
+KanjiResultSet::~KanjiResultSet() = default;
+
+KanjiResultSet::KanjiResultSet(KanjiResultSet &&other) noexcept
+    : arena(std::move(other.arena)), chunks(std::move(other.chunks)),
+      rowCount(other.rowCount), strings(other.strings)
+{
+    other.rowCount = 0;
+    other.strings = 0;
+}
+
+KanjiResultSet &KanjiResultSet::operator=(KanjiResultSet &&other) noexcept
+{
+    if (this != &other) {
+        arena = std::move(other.arena);
+        chunks = std::move(other.chunks);
+        rowCount = other.rowCount;
+        strings = other.strings;
+        other.chunks.clear();
+        other.rowCount = 0;
+        other.strings = 0;
+    }
+    return *this;
+}
+
+KanjiCardRow &KanjiResultSet::append()
+{
+    if (!arena) {
+        arena.reset(new KanjiArena()); // Moved from earlier
+    }
+    if (rowCount % RowsPerChunk == 0) {
+        void *chunk = arena->allocate(RowsPerChunk * qsizetype(sizeof(KanjiCardRow)), alignof(KanjiCardRow));
+        chunks.append(static_cast<KanjiCardRow *>(chunk));
+    }
+
+    KanjiCardRow *row = new (&chunks.last()[rowCount % RowsPerChunk]) KanjiCardRow();
+    ++rowCount;
+    return *row;
+}
+
+QStringView KanjiResultSet::store(const QString &text)
+{
+    if (text.isEmpty()) {
+        return QStringView();
+    }
+    if (!arena) {
+        arena.reset(new KanjiArena());
+    }
+    ++strings;
+    return arena->copy(text);
+}
+
+KanjiResultSet::Stats KanjiResultSet::stats() const
+{
+    Stats result;
+    result.rows = rowCount;
+    if (arena) {
+        result.heapAllocations = arena->blockCount();
+        result.bytesReserved = arena->bytesReserved();
+        result.bytesUsed = arena->bytesUsed();
+    }
+    result.heapAllocations += chunks.capacity() > 0 ? 1 : 0;
+    result.stringAllocations = strings;
+    return result;
+}
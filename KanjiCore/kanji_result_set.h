@@ -0,0 +1,118 @@
+#ifndef KANJI_RESULT_SET_H
+#define KANJI_RESULT_SET_H
+
+// DLL Export/Import macros
+#ifdef _WIN32
+    #ifdef KANJICORE_EXPORTS
+        #define KANJICORE_API __declspec(dllexport)
+    #else
+        #define KANJICORE_API __declspec(dllimport)
+    #endif
+#else
+    #define KANJICORE_API
+#endif
+
+#include <QStringView>
+#include <QString>
+#include <QDateTime>
+#include <QVector>
+#include <memory>
+#include <cstddef>
+
+struct KanjiCard;
+
+// Bump allocator: memory comes from large blocks and is only released all at
+// once when the arena is destroyed. Nothing allocated here has a destructor run.
+class KANJICORE_API KanjiArena
+{
+public:
+    static constexpr qsizetype DefaultBlockSize = 64 * 1024;
+
+    explicit KanjiArena(qsizetype blockSize = DefaultBlockSize);
+    ~KanjiArena();
+    KanjiArena(const KanjiArena &) = delete;
+    KanjiArena &operator=(const KanjiArena &) = delete;
+
+    void *allocate(qsizetype size, qsizetype alignment = alignof(std::max_align_t));
+    QStringView copy(QStringView text); // UTF-16 copy, empty text takes no space
+
+    qsizetype blockCount() const { return blocks.size(); }
+    qsizetype bytesReserved() const { return reserved; }
+    qsizetype bytesUsed() const { return used; }
+
+private:
+    qsizetype blockSize;
+    QVector<char *> blocks;
+    char *cursor;
+    char *limit;
+    qsizetype reserved;
+    qsizetype used;
+};
+
+// One card as stored in a KanjiResultSet. Text fields point into the result
+// set's arena and are only valid as long as the result set is.
+struct KANJICORE_API KanjiCardRow {
+    int id;
+    QStringView kanji;
+    QStringView meaning;
+    QStringView on_reading;
+    QStringView kun_reading;
+    QStringView example_word;
+    QStringView example_reading;
+    QStringView example_meaning;
+    int difficulty_level;
+    bool is_learned;
+    qint64 last_reviewed_ms; // Milliseconds since the epoch, -1 if never
+    qint64 next_review_ms;   // -1 if not scheduled
+    int srs_level;
+    int review_count;
+    qint64 priority;
+
+    QDateTime lastReviewed() const;
+    QDateTime nextReview() const;
+    KanjiCard toCard() const; // Deep copy with owned strings
+};
+
+// Opt-in alternative to QList<KanjiCard> for large reads. Rows and their text
+// come from one arena owned by the result set, so a 10k-card read costs a few
+// dozen allocations instead of one per string. Move-only.
+class KANJICORE_API KanjiResultSet
+{
+public:
+    // Retained heap allocations against what the same rows as KanjiCards would
+    // hold. heapAllocations is counted; stringAllocations is an estimate, not
+    // a measurement: one block per non-empty string, as a QString would take.
+    struct Stats {
+        qsizetype rows = 0;
+        qsizetype heapAllocations = 0;  // Arena blocks plus the row chunk index
+        qsizetype bytesReserved = 0;
+        qsizetype bytesUsed = 0;
+        qsizetype stringAllocations = 0; // Estimate: non-empty strings stored
+    };
+
+    KanjiResultSet();
+    ~KanjiResultSet();
+    KanjiResultSet(KanjiResultSet &&other) noexcept;
+    KanjiResultSet &operator=(KanjiResultSet &&other) noexcept;
+
+    int size() const { return rowCount; }
+    bool isEmpty() const { return rowCount == 0; }
+    const KanjiCardRow &at(int index) const { return chunks[index / RowsPerChunk][index % RowsPerChunk]; }
+    const KanjiCardRow &last() const { return at(rowCount - 1); }
+
+    // Filling, for KanjiDatabase: append a zeroed row, then store its text
+    KanjiCardRow &append();
+    QStringView store(const QString &text);
+
+    Stats stats() const;
+
+private:
+    static constexpr int RowsPerChunk = 256;
+
+    std::unique_ptr<KanjiArena> arena;
+    QVector<KanjiCardRow *> chunks;
+    int rowCount;
+    qsizetype strings;
+};
+
+#endif // KANJI_RESULT_SET_H
@@ -0,0 +1,140 @@
+#include "kanji_search_index.h"
+#include <QSqlError>
+#include <QStringList>
+#include <QVariant>
+#include <QDebug>
+
+KanjiSearchIndex::KanjiSearchIndex(const QSqlDatabase &database)
+    : db(database), available(false)
+{
+}
+
+bool KanjiSearchIndex::initialize()
+{
+    QSqlQuery query(db);
+
+    // Remember whether the index exists so a fresh one gets filled from kanji
+    bool existed = false;
+    query.prepare("SELECT 1 FROM sqlite_master WHERE type = 'table' AND name = 'kanji_fts'");
+    if (query.exec() && query.next()) {
+        existed = true;
+    }
+
+    // Column order matches the bm25() weights used for ranking below
+    QString createIndex = R"(
+        CREATE VIRTUAL TABLE IF NOT EXISTS kanji_fts USING fts5(
+            kanji, meaning, on_reading, kun_reading,
+            example_word, example_reading, example_meaning,
+            content = 'kanji',
+            content_rowid = 'id',
+            tokenize = 'unicode61 remove_diacritics 2',
+            prefix = '2 3'
+        )
+    )";
+
+    if (!query.exec(createIndex)) {
+        // SQLite built without FTS5 - searching falls back to LIKE in KanjiDatabase
+        lastError = "Full-text search unavailable: " + query.lastError().text();
+        qDebug() << lastError;
+        available = false;
+        return false;
+    }
+
+    QStringList triggers = {
+        R"(
+        CREATE TRIGGER IF NOT EXISTS kanji_fts_insert AFTER INSERT ON kanji BEGIN
+            INSERT INTO kanji_fts(rowid, kanji, meaning, on_reading, kun_reading,
+                                  example_word, example_reading, example_meaning)
+            VALUES (new.id, new.kanji, new.meaning, new.on_reading, new.kun_reading,
+                    new.example_word, new.example_reading, new.example_meaning);
+        END
+        )",
+        R"(
+        CREATE TRIGGER IF NOT EXISTS kanji_fts_delete AFTER DELETE ON kanji BEGIN
+            INSERT INTO kanji_fts(kanji_fts, rowid, kanji, meaning, on_reading, kun_reading,
+                                  example_word, example_reading, example_meaning)
+            VALUES ('delete', old.id, old.kanji, old.meaning, old.on_reading, old.kun_reading,
+                    old.example_word, old.example_reading, old.example_meaning);
+        END
+        )",
+        // Only content columns - progress updates must not touch the index
+        R"(
+        CREATE TRIGGER IF NOT EXISTS kanji_fts_update
+        AFTER UPDATE OF kanji, meaning, on_reading, kun_reading,
+                        example_word, example_reading, example_meaning ON kanji BEGIN
+            INSERT INTO kanji_fts(kanji_fts, rowid, kanji, meaning, on_reading, kun_reading,
+                                  example_word, example_reading, example_meaning)
+            VALUES ('delete', old.id, old.kanji, old.meaning, old.on_reading, old.kun_reading,
+                    old.example_word, old.example_reading, old.example_meaning);
+            INSERT INTO kanji_fts(rowid, kanji, meaning, on_reading, kun_reading,
+                                  example_word, example_reading, example_meaning)
+            VALUES (new.id, new.kanji, new.meaning, new.on_reading, new.kun_reading,
+                    new.example_word, new.example_reading, new.example_meaning);
+        END
+        )"
+    };
+
+    for (const QString &trigger : triggers) {
+        if (!query.exec(trigger)) {
+            lastError = "Failed to create search trigger: " + query.lastError().text();
+            return false;
+        }
+    }
+
+    // Persist the column weights so ORDER BY rank is bm25 with meaning/kanji first
+    query.exec("INSERT INTO kanji_fts(kanji_fts, rank) "
+               "VALUES ('rank', 'bm25(10.0, 5.0, 3.0, 3.0, 2.0, 2.0, 1.0)')");
+
+    available = true;
+
+    if (!existed) {
+        return rebuild();
+    }
+
+    return true;
+}
+
+bool KanjiSearchIndex::attach()
+{
+    QSqlQuery query(db);
+    query.prepare("SELECT 1 FROM sqlite_master WHERE type = 'table' AND name = 'kanji_fts'");
+    available = query.exec() && query.next();
+
+    if (!available) {
+        lastError = "Full-text search index has not been created";
+        return false;
+    }
+
+    return true;
+}
+
+bool KanjiSearchIndex::rebuild()
+{
+    if (!available) {
+        return false;
+    }
+
+    QSqlQuery query(db);
+    if (!query.exec("INSERT INTO kanji_fts(kanji_fts) VALUES ('rebuild')")) {
+        lastError = "Failed to rebuild search index: " + query.lastError().text();
+        return false;
+    }
+
+    return true;
+}
+
+QString KanjiSearchIndex::buildMatchExpression(const QString &text)
+{
+    QStringList terms;
+    const QStringList words = text.simplified().split(QChar(' '), Qt::SkipEmptyParts);
+
+    for (QString word : words) {
+        // Quotes are the only special character inside an FTS5 string
+        word.remove(QChar('"'));
+        if (!word.isEmpty()) {
+            terms.append(QString("\"%1\"*").arg(word));
+        }
+    }
+
+    return terms.join(' ');
+}
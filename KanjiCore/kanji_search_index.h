@@ -0,0 +1,47 @@
+#ifndef KANJI_SEARCH_INDEX_H
+#define KANJI_SEARCH_INDEX_H
+
+// DLL Export/Import macros
+#ifdef _WIN32
+    #ifdef KANJICORE_EXPORTS
+        #define KANJICORE_API __declspec(dllexport)
+    #else
+        #define KANJICORE_API __declspec(dllimport)
+    #endif
+#else
+    #define KANJICORE_API
+#endif
+
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QString>
+#include <QList>
+
+// Full-text index over the kanji table backed by an external-content FTS5
+// table. Triggers keep it in sync with every INSERT/UPDATE/DELETE on kanji,
+// so callers never have to reindex by hand. Queries against it are built by
+// KanjiDatabase (searchKanji, browse filters) from buildMatchExpression(), and
+// ORDER BY rank there is bm25 with the column weights set in initialize().
+class KANJICORE_API KanjiSearchIndex
+{
+public:
+    explicit KanjiSearchIndex(const QSqlDatabase &database);
+
+    bool initialize();        // Create table and triggers, rebuild if new
+    bool attach();            // Use an index another connection already initialized
+    bool rebuild();           // Reindex every row from the kanji table
+    bool isAvailable() const { return available; }
+
+    // Turns free text into an FTS5 MATCH expression: every word becomes a
+    // quoted prefix term, so user input can never inject query syntax
+    static QString buildMatchExpression(const QString &text);
+
+    QString getLastError() const { return lastError; }
+
+private:
+    QSqlDatabase db;
+    bool available;
+    QString lastError;
+};
+
+#endif // KANJI_SEARCH_INDEX_H
@@ -0,0 +1,382 @@
+#include "kanji_text_scanner.h"
+#include <QFile>
+#include <QThread>
+#include <QThreadPool>
+#include <QAtomicInt>
+#include <QByteArray>
+#include <QSysInfo>
+#include <algorithm>
+
+namespace {
+
+// Accounts one decoded character; previousScript tracks segment boundaries
+inline void accountCharacter(char32_t codePoint, int &previousScript,
+                             KanjiHistogram &histogram, TextScanStats &stats)
+{
+    const TextScanStats::Script script = KanjiTextScanner::classify(codePoint);
+    ++stats.characters;
+    ++stats.scriptCharacters[script];
+    if (script != previousScript) {
+        ++stats.scriptSegments[script];
+        previousScript = script;
+    }
+    if (script == TextScanStats::Kanji) {
+        histogram.add(codePoint);
+    }
+}
+
+inline char16_t readUnit(const uchar *data, bool bigEndian)
+{
+    return bigEndian ? char16_t((data[0] << 8) | data[1]) : char16_t(data[0] | (data[1] << 8));
+}
+
+} // namespace
+
+KanjiHistogram::KanjiHistogram()
+    : totalCount(0)
+{
+}
+
+void KanjiHistogram::merge(const KanjiHistogram &other)
+{
+    if (!other.dense.isEmpty()) {
+        if (dense.isEmpty()) {
+            dense = other.dense;
+        } else {
+            qint64 *target = dense.data();
+            const qint64 *source = other.dense.constData();
+            const int size = int(dense.size());
+            for (int i = 0; i < size; ++i) {
+                target[i] += source[i];
+            }
+        }
+    }
+
+    for (auto it = other.sparse.constBegin(); it != other.sparse.constEnd(); ++it) {
+        sparse[it.key()] += it.value();
+    }
+
+    totalCount += other.totalCount;
+}
+
+void KanjiHistogram::clear()
+{
+    dense.clear();
+    sparse.clear();
+    totalCount = 0;
+}
+
+qint64 KanjiHistogram::count(char32_t codePoint) const
+{
+    if (codePoint >= DenseBegin && codePoint <= DenseEnd) {
+        return dense.isEmpty() ? 0 : dense[codePoint - DenseBegin];
+    }
+    return sparse.value(codePoint, 0);
+}
+
+int KanjiHistogram::distinct() const
+{
+    int result = 0;
+    for (qint64 value : dense) {
+        if (value > 0) {
+            ++result;
+        }
+    }
+    return result + int(sparse.size());
+}
+
+QVector<QPair<char32_t, qint64>> KanjiHistogram::entries() const
+{
+    QVector<QPair<char32_t, qint64>> result;
+
+    for (int i = 0; i < dense.size(); ++i) {
+        if (dense[i] > 0) {
+            result.append(qMakePair(char32_t(DenseBegin + i), dense[i]));
+        }
+    }
+    for (auto it = sparse.constBegin(); it != sparse.constEnd(); ++it) {
+        if (it.value() > 0) {
+            result.append(qMakePair(it.key(), it.value()));
+        }
+    }
+
+    std::sort(result.begin(), result.end(), [](const QPair<char32_t, qint64> &a, const QPair<char32_t, qint64> &b) {
+        return a.second > b.second || (a.second == b.second && a.first < b.first);
+    });
+
+    return result;
+}
+
+void TextScanStats::merge(const TextScanStats &other)
+{
+    bytes += other.bytes;
+    characters += other.characters;
+    for (int i = 0; i < ScriptCount; ++i) {
+        scriptCharacters[i] += other.scriptCharacters[i];
+        scriptSegments[i] += other.scriptSegments[i];
+    }
+}
+
+KanjiTextScanner::KanjiTextScanner(int threads)
+    : threadCount(threads > 0 ? threads : qMax(1, QThread::idealThreadCount())),
+      chunkSize(8 * 1024 * 1024)
+{
+}
+
+bool KanjiTextScanner::scanFile(const QString &path, KanjiHistogram &histogram, TextScanStats *stats)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        lastError = "Cannot open " + path + ": " + file.errorString();
+        return false;
+    }
+
+    const qint64 size = file.size();
+    if (size == 0) {
+        return true;
+    }
+
+    // Map the whole file; fall back to reading it when mapping is not possible
+    QByteArray fallback;
+    const uchar *data = file.map(0, size);
+    const bool mapped = data != nullptr;
+    if (!mapped) {
+        fallback = file.readAll();
+        if (fallback.size() != size) {
+            lastError = "Cannot read " + path + ": " + file.errorString();
+            return false;
+        }
+        data = reinterpret_cast<const uchar *>(fallback.constData());
+    }
+
+    int bomLength = 0;
+    const Encoding encoding = detectEncoding(data, size, &bomLength);
+
+    // Chunk boundaries never split a character
+    QVector<qint64> bounds;
+    bounds.append(bomLength);
+    qint64 offset = bomLength;
+    while (offset < size) {
+        qint64 next = qMin(offset + chunkSize, size);
+        if (next < size) {
+            next = alignChunkBoundary(data, size, next, encoding);
+        }
+        bounds.append(next);
+        offset = next;
+    }
+
+    const int chunkCount = int(bounds.size()) - 1;
+    const int workerCount = qMax(1, qMin(threadCount, chunkCount));
+
+    QVector<KanjiHistogram> workerHistograms(workerCount);
+    QVector<TextScanStats> workerStats(workerCount);
+    KanjiHistogram *histogramSlots = workerHistograms.data();
+    TextScanStats *statsSlots = workerStats.data();
+    const qint64 *boundsData = bounds.constData();
+    QAtomicInt nextChunk(0);
+
+    QThreadPool pool;
+    pool.setMaxThreadCount(workerCount);
+    for (int worker = 0; worker < workerCount; ++worker) {
+        pool.start([=, &nextChunk]() {
+            // Workers pull chunks until none are left, so uneven chunks balance out
+            for (int chunk = nextChunk.fetchAndAddRelaxed(1); chunk < chunkCount;
+                 chunk = nextChunk.fetchAndAddRelaxed(1)) {
+                const uchar *begin = data + boundsData[chunk];
+                const qint64 length = boundsData[chunk + 1] - boundsData[chunk];
+                if (encoding == Encoding::Utf8) {
+                    scanUtf8(begin, length, histogramSlots[worker], statsSlots[worker]);
+                } else {
+                    scanUtf16(begin, length, encoding == Encoding::Utf16BE,
+                              histogramSlots[worker], statsSlots[worker]);
+                }
+            }
+        });
+    }
+    pool.waitForDone();
+
+    for (int worker = 0; worker < workerCount; ++worker) {
+        histogram.merge(workerHistograms[worker]);
+        if (stats) {
+            stats->merge(workerStats[worker]);
+        }
+    }
+    if (stats) {
+        stats->bytes += size;
+    }
+
+    if (mapped) {
+        file.unmap(const_cast<uchar *>(data));
+    }
+
+    return true;
+}
+
+void KanjiTextScanner::scanText(const QString &text, KanjiHistogram &histogram, TextScanStats *stats)
+{
+    TextScanStats local;
+    scanUtf16(reinterpret_cast<const uchar *>(text.utf16()), text.size() * 2,
+              QSysInfo::ByteOrder == QSysInfo::BigEndian, histogram, local);
+    local.bytes = text.size() * 2;
+    if (stats) {
+        stats->merge(local);
+    }
+}
+
+KanjiTextScanner::Encoding KanjiTextScanner::detectEncoding(const uchar *data, qint64 size, int *bomLength)
+{
+    if (bomLength) {
+        *bomLength = 0;
+    }
+
+    if (size >= 3 && data[0] == 0xEF && data[1] == 0xBB && data[2] == 0xBF) {
+        if (bomLength) *bomLength = 3;
+        return Encoding::Utf8;
+    }
+    if (size >= 2 && data[0] == 0xFF && data[1] == 0xFE) {
+        if (bomLength) *bomLength = 2;
+        return Encoding::Utf16LE;
+    }
+    if (size >= 2 && data[0] == 0xFE && data[1] == 0xFF) {
+        if (bomLength) *bomLength = 2;
+        return Encoding::Utf16BE;
+    }
+
+    // ASCII in UTF-16 leaves zero bytes on one side of every unit
+    const qint64 sample = qMin<qint64>(size, 4096) & ~qint64(1);
+    qint64 evenZeros = 0;
+    qint64 oddZeros = 0;
+    for (qint64 i = 0; i < sample; i += 2) {
+        evenZeros += data[i] == 0;
+        oddZeros += data[i + 1] == 0;
+    }
+    if (oddZeros > sample / 8 && evenZeros == 0) {
+        return Encoding::Utf16LE;
+    }
+    if (evenZeros > sample / 8 && oddZeros == 0) {
+        return Encoding::Utf16BE;
+    }
+
+    // Pure Japanese UTF-16 has no zero bytes, but is almost never valid UTF-8
+    qint64 i = 0;
+    while (i < sample) {
+        const uchar b = data[i];
+        int length = b < 0x80 ? 1 : (b & 0xE0) == 0xC0 ? 2 : (b & 0xF0) == 0xE0 ? 3 : (b & 0xF8) == 0xF0 ? 4 : 0;
+        if (length == 0) {
+            return Encoding::Utf16LE;
+        }
+        for (int k = 1; k < length && i + k < sample; ++k) {
+            if ((data[i + k] & 0xC0) != 0x80) {
+                return Encoding::Utf16LE;
+            }
+        }
+        i += length;
+    }
+
+    return Encoding::Utf8;
+}
+
+TextScanStats::Script KanjiTextScanner::classify(char32_t codePoint)
+{
+    if (codePoint < 0x80) {
+        if ((codePoint | 0x20) >= 'a' && (codePoint | 0x20) <= 'z') return TextScanStats::Latin;
+        if (codePoint >= '0' && codePoint <= '9') return TextScanStats::Digit;
+        return TextScanStats::Other;
+    }
+    if (isKanjiCodePoint(codePoint)) return TextScanStats::Kanji;
+    if (codePoint >= 0x3041 && codePoint <= 0x309F) return TextScanStats::Hiragana;
+    if ((codePoint >= 0x30A0 && codePoint <= 0x30FF) || (codePoint >= 0x31F0 && codePoint <= 0x31FF) ||
+        (codePoint >= 0xFF66 && codePoint <= 0xFF9F)) {
+        return TextScanStats::Katakana;
+    }
+    if ((codePoint >= 0xFF21 && codePoint <= 0xFF3A) || (codePoint >= 0xFF41 && codePoint <= 0xFF5A) ||
+        (codePoint >= 0x00C0 && codePoint <= 0x024F && codePoint != 0xD7 && codePoint != 0xF7)) {
+        return TextScanStats::Latin;
+    }
+    if (codePoint >= 0xFF10 && codePoint <= 0xFF19) return TextScanStats::Digit;
+    return TextScanStats::Other;
+}
+
+bool KanjiTextScanner::isKanjiCodePoint(char32_t codePoint)
+{
+    return (codePoint >= 0x4E00 && codePoint <= 0x9FFF) ||    // CJK Unified Ideographs
+           (codePoint >= 0x3400 && codePoint <= 0x4DBF) ||    // Extension A
+           (codePoint >= 0xF900 && codePoint <= 0xFAFF) ||    // Compatibility Ideographs
+           (codePoint >= 0x20000 && codePoint <= 0x323AF);    // Extensions B-H
+}
+
+void KanjiTextScanner::scanUtf8(const uchar *data, qint64 size, KanjiHistogram &histogram, TextScanStats &stats)
+{
+    int previousScript = -1;
+    qint64 i = 0;
+
+    while (i < size) {
+        const uchar b = data[i];
+        char32_t codePoint;
+
+        if (b < 0x80) {
+            codePoint = b;
+            i += 1;
+        } else if ((b & 0xE0) == 0xC0 && i + 1 < size) {
+            codePoint = (char32_t(b & 0x1F) << 6) | (data[i + 1] & 0x3F);
+            i += 2;
+        } else if ((b & 0xF0) == 0xE0 && i + 2 < size) {
+            codePoint = (char32_t(b & 0x0F) << 12) | (char32_t(data[i + 1] & 0x3F) << 6) | (data[i + 2] & 0x3F);
+            i += 3;
+        } else if ((b & 0xF8) == 0xF0 && i + 3 < size) {
+            codePoint = (char32_t(b & 0x07) << 18) | (char32_t(data[i + 1] & 0x3F) << 12) |
+                        (char32_t(data[i + 2] & 0x3F) << 6) | (data[i + 3] & 0x3F);
+            i += 4;
+        } else {
+            // Invalid or truncated sequence - skip the byte
+            ++i;
+            continue;
+        }
+
+        accountCharacter(codePoint, previousScript, histogram, stats);
+    }
+}
+
+void KanjiTextScanner::scanUtf16(const uchar *data, qint64 size, bool bigEndian,
+                                 KanjiHistogram &histogram, TextScanStats &stats)
+{
+    int previousScript = -1;
+    const qint64 units = size / 2;
+    qint64 i = 0;
+
+    while (i < units) {
+        char32_t codePoint = readUnit(data + i * 2, bigEndian);
+        ++i;
+
+        if (codePoint >= 0xD800 && codePoint <= 0xDBFF && i < units) {
+            const char16_t low = readUnit(data + i * 2, bigEndian);
+            if (low >= 0xDC00 && low <= 0xDFFF) {
+                codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+                ++i;
+            }
+        }
+
+        accountCharacter(codePoint, previousScript, histogram, stats);
+    }
+}
+
+qint64 KanjiTextScanner::alignChunkBoundary(const uchar *data, qint64 size, qint64 offset, Encoding encoding)
+{
+    if (encoding == Encoding::Utf8) {
+        // Never start a chunk on a continuation byte
+        while (offset < size && (data[offset] & 0xC0) == 0x80) {
+            ++offset;
+        }
+        return offset;
+    }
+
+    // Keep code units whole and surrogate pairs together
+    offset &= ~qint64(1);
+    if (offset + 1 < size) {
+        const char16_t unit = readUnit(data + offset, encoding == Encoding::Utf16BE);
+        if (unit >= 0xDC00 && unit <= 0xDFFF) {
+            offset += 2;
+        }
+    }
+    return qMin(offset, size);
+}
@@ -0,0 +1,115 @@
+#ifndef KANJI_TEXT_SCANNER_H
+#define KANJI_TEXT_SCANNER_H
+
+// DLL Export/Import macros
+#ifdef _WIN32
+    #ifdef KANJICORE_EXPORTS
+        #define KANJICORE_API __declspec(dllexport)
+    #else
+        #define KANJICORE_API __declspec(dllimport)
+    #endif
+#else
+    #define KANJICORE_API
+#endif
+
+#include <QString>
+#include <QVector>
+#include <QHash>
+#include <QPair>
+
+// Occurrence counts per kanji code point. The CJK Unified Ideographs block
+// is a dense array so the scan loop never hashes, rarer blocks use a hash.
+class KANJICORE_API KanjiHistogram
+{
+public:
+    KanjiHistogram();
+
+    void add(char32_t codePoint, qint64 count = 1)
+    {
+        if (codePoint >= DenseBegin && codePoint <= DenseEnd) {
+            if (dense.isEmpty()) {
+                dense.fill(0, DenseEnd - DenseBegin + 1);
+            }
+            dense[codePoint - DenseBegin] += count;
+        } else {
+            sparse[codePoint] += count;
+        }
+        totalCount += count;
+    }
+
+    void merge(const KanjiHistogram &other);
+    void clear();
+
+    qint64 count(char32_t codePoint) const;
+    qint64 total() const { return totalCount; }
+    int distinct() const;
+
+    // Non-zero entries, most frequent first
+    QVector<QPair<char32_t, qint64>> entries() const;
+
+private:
+    static constexpr char32_t DenseBegin = 0x4E00;
+    static constexpr char32_t DenseEnd = 0x9FFF;
+
+    QVector<qint64> dense;
+    QHash<char32_t, qint64> sparse;
+    qint64 totalCount;
+};
+
+struct KANJICORE_API TextScanStats {
+    enum Script {
+        Kanji,
+        Hiragana,
+        Katakana,
+        Latin,
+        Digit,
+        Other,
+        ScriptCount
+    };
+
+    qint64 bytes = 0;
+    qint64 characters = 0;
+    qint64 scriptCharacters[ScriptCount] = {};
+    qint64 scriptSegments[ScriptCount] = {};   // Runs of consecutive characters of one script
+
+    void merge(const TextScanStats &other);
+};
+
+// Memory-maps a UTF-8 or UTF-16 text file, splits it into chunks on
+// character boundaries and scans them on a thread pool. Every worker keeps
+// its own histogram and statistics, they are merged once at the end.
+class KANJICORE_API KanjiTextScanner
+{
+public:
+    enum class Encoding {
+        Utf8,
+        Utf16LE,
+        Utf16BE
+    };
+
+    explicit KanjiTextScanner(int threadCount = 0); // 0 = ideal thread count
+
+    bool scanFile(const QString &path, KanjiHistogram &histogram, TextScanStats *stats = nullptr);
+    void scanText(const QString &text, KanjiHistogram &histogram, TextScanStats *stats = nullptr);
+
+    void setChunkSize(qint64 bytes) { chunkSize = qMax<qint64>(bytes, 4096); }
+    int getThreadCount() const { return threadCount; }
+
+    // BOM first, otherwise guessed from the position of zero bytes
+    static Encoding detectEncoding(const uchar *data, qint64 size, int *bomLength = nullptr);
+    static TextScanStats::Script classify(char32_t codePoint);
+    static bool isKanjiCodePoint(char32_t codePoint);
+
+    QString getLastError() const { return lastError; }
+
+private:
+    static void scanUtf8(const uchar *data, qint64 size, KanjiHistogram &histogram, TextScanStats &stats);
+    static void scanUtf16(const uchar *data, qint64 size, bool bigEndian, KanjiHistogram &histogram, TextScanStats &stats);
+    static qint64 alignChunkBoundary(const uchar *data, qint64 size, qint64 offset, Encoding encoding);
+
+    int threadCount;
+    qint64 chunkSize;
+    QString lastError;
+};
+
+#endif // KANJI_TEXT_SCANNER_H
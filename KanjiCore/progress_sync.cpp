@@ -0,0 +1,184 @@
+#include "progress_sync.h"
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+#include <QSet>
+#include <QUuid>
+#include <QDebug>
+
+ProgressSync::ProgressSync(KanjiDatabase *database, const QString &folder)
+    : database(database), folder(folder)
+{
+}
+
+bool ProgressSync::sync()
+{
+    syncStats = SyncStats();
+    return exportChanges() && importChanges();
+}
+
+bool ProgressSync::exportChanges()
+{
+    if (!QDir().mkpath(folder)) {
+        lastError = "Cannot create sync folder " + folder;
+        return false;
+    }
+
+    const QString deviceId = database->getDeviceId();
+    const qint64 exported = database->getSyncValue("exported_seq").toLongLong();
+
+    qint64 lastSequence = exported;
+    QList<KanjiProgressRecord> records = database->getProgressChangesSince(exported, &lastSequence);
+    if (records.isEmpty()) {
+        return true;
+    }
+
+    QByteArray data = encodeDelta(deviceId, exported, lastSequence, records);
+
+    // Zero-padded so a directory listing sorts one device's files in order
+    QString name = QString("%1-%2.kdelta").arg(deviceId).arg(lastSequence, 12, 10, QChar('0'));
+    QSaveFile file(QDir(folder).filePath(name));
+    if (!file.open(QIODevice::WriteOnly) || file.write(data) != data.size() || !file.commit()) {
+        lastError = QString("Cannot write %1: %2").arg(name, file.errorString());
+        return false;
+    }
+
+    if (!database->setSyncValue("exported_seq", QString::number(lastSequence))) {
+        lastError = database->getLastError();
+        return false;
+    }
+
+    syncStats.exportedRecords += records.size();
+    syncStats.bytesWritten += data.size();
+    return true;
+}
+
+bool ProgressSync::importChanges()
+{
+    const QString ownId = database->getDeviceId();
+    QDir dir(folder);
+    const QStringList names = dir.entryList({"*.kdelta"}, QDir::Files, QDir::Name);
+
+    // Names sort one device's files in sequence order. Each file continues from
+    // where the previous one ended (or earlier, after an export that was
+    // written but not recorded; applying a record twice is harmless). A device
+    // whose next file is missing or unreadable waits until it shows up, so no
+    // file is ever skipped.
+    QSet<QString> waiting;
+    for (const QString &name : names) {
+        // Skip our own files and anything older than what was read from that device
+        const QString deviceId = name.section('-', 0, -2);
+        const qint64 sequence = name.section('-', -1).section('.', 0, 0).toLongLong();
+        const qint64 watermark = database->getSyncValue("peer:" + deviceId).toLongLong();
+        if (deviceId == ownId || waiting.contains(deviceId) || sequence <= watermark) {
+            continue;
+        }
+
+        QFile file(dir.filePath(name));
+        if (!file.open(QIODevice::ReadOnly)) {
+            lastError = QString("Cannot read %1: %2").arg(name, file.errorString());
+            return false;
+        }
+        QByteArray data = file.readAll();
+
+        QString sender;
+        qint64 fromSequence = 0;
+        qint64 toSequence = 0;
+        QList<KanjiProgressRecord> records;
+        if (!decodeDelta(data, sender, fromSequence, toSequence, records) || sender != deviceId) {
+            qDebug() << "Unreadable sync file" << name << "- waiting for a good copy";
+            waiting.insert(deviceId);
+            continue;
+        }
+        if (fromSequence > watermark) {
+            qDebug() << "Sync file" << name << "starts at" << fromSequence << "but" << watermark
+                     << "was read last - waiting for the files in between";
+            waiting.insert(deviceId);
+            continue;
+        }
+
+        int applied = 0;
+        if (!database->applyProgressChanges(records, &applied)) {
+            lastError = database->getLastError();
+            return false;
+        }
+        // Records for cards missing here were kept by the database, so the file is done
+        database->setSyncValue("peer:" + sender, QString::number(toSequence));
+
+        ++syncStats.importedFiles;
+        syncStats.receivedRecords += records.size();
+        syncStats.appliedRecords += applied;
+        syncStats.bytesRead += data.size();
+    }
+
+    syncStats.waitingDevices = waiting.size();
+    return true;
+}
+
+QByteArray ProgressSync::encodeDelta(const QString &deviceId, qint64 fromSequence, qint64 toSequence,
+                                     const QList<KanjiProgressRecord> &records)
+{
+    QByteArray payload;
+    QDataStream body(&payload, QIODevice::WriteOnly);
+    body.setVersion(QDataStream::Qt_6_0);
+    body << quint32(records.size());
+    for (const KanjiProgressRecord &record : records) {
+        body << record.kanji
+             << quint8(record.is_learned ? 1 : 0)
+             << qint32(record.srs_level)
+             << qint32(record.review_count)
+             << qint64(record.last_reviewed.isValid() ? record.last_reviewed.toMSecsSinceEpoch() : -1)
+             << qint64(record.next_review.isValid() ? record.next_review.toMSecsSinceEpoch() : -1);
+    }
+
+    QByteArray header;
+    QDataStream out(&header, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_6_0);
+    out << QUuid::fromString(deviceId) << fromSequence << toSequence << qCompress(payload);
+    return QByteArray(Magic, sizeof(Magic)) + header;
+}
+
+bool ProgressSync::decodeDelta(const QByteArray &data, QString &deviceId, qint64 &fromSequence, qint64 &toSequence,
+                               QList<KanjiProgressRecord> &records)
+{
+    if (!data.startsWith(QByteArray(Magic, sizeof(Magic)))) {
+        return false;
+    }
+
+    QDataStream in(data.mid(sizeof(Magic)));
+    in.setVersion(QDataStream::Qt_6_0);
+    QUuid device;
+    QByteArray compressed;
+    in >> device >> fromSequence >> toSequence >> compressed;
+    if (in.status() != QDataStream::Ok) {
+        return false;
+    }
+    deviceId = device.toString(QUuid::WithoutBraces);
+
+    QByteArray payload = qUncompress(compressed);
+    QDataStream body(payload);
+    body.setVersion(QDataStream::Qt_6_0);
+    quint32 count = 0;
+    body >> count;
+
+    records.clear();
+    for (quint32 i = 0; i < count && body.status() == QDataStream::Ok; ++i) {
+        KanjiProgressRecord record;
+        quint8 learned;
+        qint32 level;
+        qint32 reviews;
+        qint64 lastReviewed;
+        qint64 nextReview;
+        body >> record.kanji >> learned >> level >> reviews >> lastReviewed >> nextReview;
+
+        record.is_learned = learned != 0;
+        record.srs_level = level;
+        record.review_count = reviews;
+        record.last_reviewed = lastReviewed >= 0 ? QDateTime::fromMSecsSinceEpoch(lastReviewed) : QDateTime();
+        record.next_review = nextReview >= 0 ? QDateTime::fromMSecsSinceEpoch(nextReview) : QDateTime();
+        records.append(record);
+    }
+
+    return body.status() == QDataStream::Ok;
+}
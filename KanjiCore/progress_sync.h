@@ -0,0 +1,64 @@
+#ifndef PROGRESS_SYNC_H
+#define PROGRESS_SYNC_H
+
+// DLL Export/Import macros
+#ifdef _WIN32
+    #ifdef KANJICORE_EXPORTS
+        #define KANJICORE_API __declspec(dllexport)
+    #else
+        #define KANJICORE_API __declspec(dllimport)
+    #endif
+#else
+    #define KANJICORE_API
+#endif
+
+#include <QString>
+#include <QList>
+#include <QByteArray>
+#include "kanji_database.h"
+
+struct KANJICORE_API SyncStats {
+    int exportedRecords = 0;
+    qint64 bytesWritten = 0;
+    int importedFiles = 0;
+    int receivedRecords = 0;
+    int appliedRecords = 0; // Received records that won over local progress
+    qint64 bytesRead = 0;
+    int waitingDevices = 0; // Devices with a missing or unreadable file, not read past it
+};
+
+// Exchanges progress deltas through a shared folder (a USB stick, a synced
+// cloud directory). Each device writes the cards it changed since its last
+// export to <device id>-<sequence>.kdelta and applies other devices' files
+// in sequence order, each only if it starts no later than where the last one
+// read ended. Nothing is ever rewritten in place, so devices can sync against
+// the folder in any order.
+class KANJICORE_API ProgressSync
+{
+public:
+    ProgressSync(KanjiDatabase *database, const QString &folder);
+
+    bool sync(); // Export, then import
+    bool exportChanges();
+    bool importChanges();
+
+    const SyncStats &stats() const { return syncStats; }
+    QString getLastError() const { return lastError; }
+
+    // Delta file: "KSY1", then a QDataStream with the sender's device id, the
+    // sequence range covered and the zlib-compressed records
+    static QByteArray encodeDelta(const QString &deviceId, qint64 fromSequence, qint64 toSequence,
+                                  const QList<KanjiProgressRecord> &records);
+    static bool decodeDelta(const QByteArray &data, QString &deviceId, qint64 &fromSequence, qint64 &toSequence,
+                            QList<KanjiProgressRecord> &records);
+
+private:
+    static constexpr char Magic[4] = {'K', 'S', 'Y', '1'};
+
+    KanjiDatabase *database;
+    QString folder;
+    SyncStats syncStats;
+    QString lastError;
+};
+
+#endif // PROGRESS_SYNC_H
@@ -0,0 +1,167 @@
+#include "progress_write_buffer.h"
+#include <QDataStream>
+#include <QDebug>
+
+ProgressWriteBuffer::ProgressWriteBuffer(const QString &journalPath, int flushIntervalMs, QObject *parent)
+    : QObject(parent), journal(journalPath)
+{
+    flushTimer = new QTimer(this);
+    flushTimer->setSingleShot(true);
+    flushTimer->setInterval(flushIntervalMs);
+    connect(flushTimer, &QTimer::timeout, this, &ProgressWriteBuffer::flushRequested);
+}
+
+bool ProgressWriteBuffer::open()
+{
+    // Unbuffered so every append reaches the OS before the answer is shown
+    if (!journal.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Unbuffered)) {
+        lastError = "Cannot open progress journal: " + journal.errorString();
+        return false;
+    }
+    if (journal.write(Magic, sizeof(Magic)) != qint64(sizeof(Magic))) {
+        lastError = "Cannot write progress journal: " + journal.errorString();
+        return false;
+    }
+    return true;
+}
+
+QByteArray ProgressWriteBuffer::encode(const KanjiCard &card, const KanjiReviewEvent &review)
+{
+    QByteArray record;
+    QDataStream out(&record, QIODevice::WriteOnly);
+    out << qint32(card.id)
+        << quint8(card.is_learned ? 1 : 0)
+        << qint32(card.srs_level)
+        << qint32(card.review_count)
+        << qint64(card.last_reviewed.isValid() ? card.last_reviewed.toMSecsSinceEpoch() : -1)
+        << qint64(card.next_review.isValid() ? card.next_review.toMSecsSinceEpoch() : -1);
+    // The answer's time is the card's last_reviewed
+    out << quint8(review.correct ? 1 : 0)
+        << qint32(review.srsLevel)
+        << quint8(review.difficulty)
+        << qint64(review.elapsedSeconds);
+    out << qChecksum(QByteArrayView(record));
+    return record;
+}
+
+bool ProgressWriteBuffer::append(const KanjiCard &card, const KanjiReviewEvent &review)
+{
+    QByteArray record = encode(card, review);
+    if (journal.write(record) != record.size()) {
+        lastError = "Cannot write progress journal: " + journal.errorString();
+        return false;
+    }
+
+    cards.insert(card.id, card);
+    reviews.append(review);
+    if (!flushTimer->isActive()) {
+        flushTimer->start();
+    }
+    return true;
+}
+
+void ProgressWriteBuffer::overlay(KanjiCard &card) const
+{
+    auto pending = cards.constFind(card.id);
+    if (pending == cards.constEnd()) {
+        return;
+    }
+    card.is_learned = pending->is_learned;
+    card.srs_level = pending->srs_level;
+    card.review_count = pending->review_count;
+    card.last_reviewed = pending->last_reviewed;
+    card.next_review = pending->next_review;
+}
+
+void ProgressWriteBuffer::clear()
+{
+    cards.clear();
+    reviews.clear();
+    flushTimer->stop();
+
+    // Back to just the header; the records are in the database now
+    journal.resize(sizeof(Magic));
+    journal.seek(sizeof(Magic));
+}
+
+bool ProgressWriteBuffer::readJournal(const QString &path, QList<KanjiCard> &cards,
+                                      QList<KanjiReviewEvent> &reviews, QString *error)
+{
+    cards.clear();
+    reviews.clear();
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        if (error) {
+            *error = file.errorString();
+        }
+        return false;
+    }
+
+    QByteArray data = file.readAll();
+    const bool withReviews = data.startsWith(QByteArray(Magic, sizeof(Magic)));
+    if (!withReviews && !data.startsWith(QByteArray(CardsOnlyMagic, sizeof(CardsOnlyMagic)))) {
+        if (error) {
+            *error = "Not a progress journal";
+        }
+        return false;
+    }
+    const int recordSize = withReviews ? RecordSize : CardsOnlyRecordSize;
+
+    QHash<int, int> positions; // Card id -> index in cards, later records win
+    for (qsizetype offset = sizeof(Magic); offset + recordSize <= data.size(); offset += recordSize) {
+        QByteArrayView record(data.constData() + offset, recordSize);
+        QDataStream in(data.mid(offset, recordSize));
+
+        qint32 id;
+        quint8 learned;
+        qint32 level;
+        qint32 count;
+        qint64 lastReviewed;
+        qint64 nextReview;
+        in >> id >> learned >> level >> count >> lastReviewed >> nextReview;
+
+        quint8 correct = 0;
+        qint32 answeredLevel = 0;
+        quint8 difficulty = 1;
+        qint64 elapsedSeconds = -1;
+        if (withReviews) {
+            in >> correct >> answeredLevel >> difficulty >> elapsedSeconds;
+        }
+        quint16 checksum;
+        in >> checksum;
+
+        // A crash mid-append leaves a partial or garbled last record
+        if (checksum != qChecksum(record.first(recordSize - 2))) {
+            qDebug() << "Progress journal: ignoring corrupt record at offset" << offset;
+            break;
+        }
+
+        KanjiCard card;
+        card.id = id;
+        card.is_learned = learned != 0;
+        card.srs_level = level;
+        card.review_count = count;
+        card.last_reviewed = lastReviewed >= 0 ? QDateTime::fromMSecsSinceEpoch(lastReviewed) : QDateTime();
+        card.next_review = nextReview >= 0 ? QDateTime::fromMSecsSinceEpoch(nextReview) : QDateTime();
+
+        if (positions.contains(id)) {
+            cards[positions.value(id)] = card;
+        } else {
+            positions.insert(id, cards.size());
+            cards.append(card);
+        }
+
+        if (withReviews) {
+            KanjiReviewEvent review;
+            review.kanjiId = id;
+            review.reviewedAt = card.last_reviewed;
+            review.correct = correct != 0;
+            review.srsLevel = answeredLevel;
+            review.difficulty = difficulty;
+            review.elapsedSeconds = elapsedSeconds;
+            reviews.append(review);
+        }
+    }
+
+    return true;
+}
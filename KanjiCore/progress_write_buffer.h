@@ -0,0 +1,78 @@
+#ifndef PROGRESS_WRITE_BUFFER_H
+#define PROGRESS_WRITE_BUFFER_H
+
+// DLL Export/Import macros
+#ifdef _WIN32
+    #ifdef KANJICORE_EXPORTS
+        #define KANJICORE_API __declspec(dllexport)
+    #else
+        #define KANJICORE_API __declspec(dllimport)
+    #endif
+#else
+    #define KANJICORE_API
+#endif
+
+#include <QObject>
+#include <QFile>
+#include <QHash>
+#include <QList>
+#include <QTimer>
+#include "kanji_database.h"
+
+// Write-behind store for answer progress, owned by KanjiDatabase once
+// enableWriteBehind() is called. Each answer's resulting card state and its
+// review_log event are kept in memory and appended to a journal file as one
+// record with a plain write - no fsync, so
+// it survives the app crashing but not necessarily the machine losing power.
+// flushRequested() fires FlushIntervalMs after the first pending answer; the
+// database then commits everything in one transaction and calls clear().
+class KANJICORE_API ProgressWriteBuffer : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr int DefaultFlushIntervalMs = 2000;
+
+    explicit ProgressWriteBuffer(const QString &journalPath, int flushIntervalMs = DefaultFlushIntervalMs,
+                                 QObject *parent = nullptr);
+
+    bool open(); // Start an empty journal, replacing whatever was there
+
+    // Journal the card's new progress with the answer that produced it and keep both pending
+    bool append(const KanjiCard &card, const KanjiReviewEvent &review);
+    void overlay(KanjiCard &card) const;    // Replace progress fields with the pending state, if any
+    bool isEmpty() const { return cards.isEmpty(); }
+    QList<KanjiCard> pendingCards() const { return cards.values(); }
+    const QList<KanjiReviewEvent> &pendingReviews() const { return reviews; }
+    void clear();                           // Pending state is committed; empty the journal
+
+    // Last journaled state per card and every journaled answer in order,
+    // stopping at a torn or corrupt tail. Journals from before answers were
+    // journaled (KPJ1) give cards only.
+    static bool readJournal(const QString &path, QList<KanjiCard> &cards, QList<KanjiReviewEvent> &reviews,
+                            QString *error = nullptr);
+
+    QString getLastError() const { return lastError; }
+
+signals:
+    void flushRequested();
+
+private:
+    static constexpr char Magic[4] = {'K', 'P', 'J', '2'};
+    static constexpr char CardsOnlyMagic[4] = {'K', 'P', 'J', '1'};
+    // id, learned, level, count, two timestamps; then correct, level answered
+    // at, difficulty, elapsed seconds; checksum. KPJ1 records stop at the card.
+    static constexpr int CardSize = 29;
+    static constexpr int RecordSize = CardSize + 14 + 2;
+    static constexpr int CardsOnlyRecordSize = CardSize + 2;
+
+    static QByteArray encode(const KanjiCard &card, const KanjiReviewEvent &review);
+
+    QFile journal;
+    QHash<int, KanjiCard> cards;
+    QList<KanjiReviewEvent> reviews;
+    QTimer *flushTimer;
+    QString lastError;
+};
+
+#endif // PROGRESS_WRITE_BUFFER_H
@@ -0,0 +1,135 @@
+#include "quiz_session.h"
+
+QuizSession::QuizSession()
+    : mode(Mode::Learning), currentState(State::Finished), currentQuestion(0), mistakes(0)
+{
+}
+
+QuizSession::QuizSession(const QList<KanjiCard> &cards, Mode mode)
+    : cards(cards), mode(mode), currentState(State::Finished), currentQuestion(0), mistakes(0)
+{
+    // Normalize accepted answers once per session instead of on every submission
+    meaningMatchers.reserve(cards.size());
+    readingMatchers.reserve(cards.size());
+    for (const KanjiCard &card : cards) {
+        meaningMatchers.append(AnswerMatcher::forMeaning(card));
+        readingMatchers.append(AnswerMatcher::forReading(card));
+    }
+    restart();
+}
+
+void QuizSession::restart()
+{
+    currentQuestion = 0;
+    mistakes = 0;
+    results.fill(false, questionCount());
+    leveledUpIds.clear();
+    finalResult = QuizCompletion();
+    currentState = State::AwaitingAnswer;
+
+    if (cards.isEmpty()) {
+        finish();
+    }
+}
+
+QuizSession::QuestionType QuizSession::currentType() const
+{
+    return (currentQuestion % 2 == 0) ? QuestionType::Meaning : QuestionType::Reading;
+}
+
+QString QuizSession::expectedAnswer() const
+{
+    if (currentState == State::Finished) {
+        return QString();
+    }
+
+    const KanjiCard &card = currentCard();
+    if (currentType() == QuestionType::Meaning) {
+        return card.meaning;
+    }
+    return card.on_reading.isEmpty() ? card.kun_reading : card.on_reading;
+}
+
+QuizAnswerOutcome QuizSession::submitAnswer(const QString &answer)
+{
+    QuizAnswerOutcome outcome;
+    if (currentState != State::AwaitingAnswer || answer.trimmed().isEmpty()) {
+        return outcome;
+    }
+
+    const int cardIndex = currentCardIndex();
+    const KanjiCard &card = cards[cardIndex];
+
+    // Meanings tolerate small typos, readings accept long vowel / small kana variants
+    const AnswerMatcher &matcher = (currentType() == QuestionType::Meaning) ?
+                                   meaningMatchers[cardIndex] : readingMatchers[cardIndex];
+    outcome.match = matcher.match(answer);
+    outcome.expected = expectedAnswer();
+
+    if (outcome.match == AnswerMatcher::Match::None) {
+        outcome.result = QuizAnswerOutcome::Incorrect;
+        ++mistakes;
+
+        // Reviews lower the level on every wrong answer
+        if (mode == Mode::Review) {
+            outcome.progressUpdates.append({card.id, false});
+        }
+
+        currentState = State::AwaitingRetry;
+        return outcome;
+    }
+
+    outcome.result = QuizAnswerOutcome::Correct;
+    results[currentQuestion] = true;
+
+    // Reviews level a card up once, when both its meaning and reading are right
+    if (mode == Mode::Review && results[cardIndex * 2] && results[cardIndex * 2 + 1] &&
+        !leveledUpIds.contains(card.id)) {
+        leveledUpIds.insert(card.id);
+        outcome.progressUpdates.append({card.id, true});
+    }
+
+    currentState = State::AwaitingAdvance;
+    return outcome;
+}
+
+void QuizSession::retry()
+{
+    if (currentState == State::AwaitingRetry) {
+        currentState = State::AwaitingAnswer;
+    }
+}
+
+bool QuizSession::advance()
+{
+    if (currentState != State::AwaitingAdvance) {
+        return currentState == State::Finished;
+    }
+
+    ++currentQuestion;
+    if (currentQuestion >= questionCount()) {
+        finish();
+        return true;
+    }
+
+    currentState = State::AwaitingAnswer;
+    return false;
+}
+
+void QuizSession::finish()
+{
+    currentState = State::Finished;
+
+    finalResult = QuizCompletion();
+    finalResult.questionCount = questionCount();
+    finalResult.mistakes = mistakes;
+    finalResult.allCorrect = !results.contains(false);
+
+    // Learning sessions mark every card learned once the whole quiz is passed;
+    // review progress was already reported per answer
+    if (mode == Mode::Learning && finalResult.allCorrect) {
+        for (const KanjiCard &card : cards) {
+            finalResult.progressUpdates.append({card.id, true});
+        }
+    }
+}
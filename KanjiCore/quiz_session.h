@@ -0,0 +1,107 @@
+#ifndef QUIZ_SESSION_H
+#define QUIZ_SESSION_H
+
+// DLL Export/Import macros
+#ifdef _WIN32
+    #ifdef KANJICORE_EXPORTS
+        #define KANJICORE_API __declspec(dllexport)
+    #else
+        #define KANJICORE_API __declspec(dllimport)
+    #endif
+#else
+    #define KANJICORE_API
+#endif
+
+#include <QString>
+#include <QList>
+#include <QSet>
+#include "kanji_database.h"
+#include "answer_matcher.h"
+
+// Progress the caller should write with KanjiDatabase::updateKanjiProgress
+struct KANJICORE_API QuizProgressUpdate {
+    int cardId;
+    bool correct;
+};
+
+struct KANJICORE_API QuizAnswerOutcome {
+    enum Result {
+        Ignored,   // Empty answer, or no question is waiting for one
+        Correct,
+        Incorrect
+    };
+
+    Result result = Ignored;
+    AnswerMatcher::Match match = AnswerMatcher::Match::None;
+    QString expected; // Answer to show the user
+    QList<QuizProgressUpdate> progressUpdates;
+};
+
+struct KANJICORE_API QuizCompletion {
+    bool allCorrect = false;
+    int questionCount = 0;
+    int mistakes = 0; // Wrong submissions, including ones corrected on retry
+    QList<QuizProgressUpdate> progressUpdates;
+};
+
+// The quiz state machine: a meaning and a reading question per card, retry
+// after a wrong answer, review level-ups once both answers for a card are
+// right, and marking cards learned at the end of a learning session.
+// Answers are checked and outcomes returned synchronously; there are no
+// widgets, timers or database calls, so sessions can be simulated headless.
+class KANJICORE_API QuizSession
+{
+public:
+    enum class Mode {
+        Learning,
+        Review
+    };
+
+    enum class QuestionType {
+        Meaning,
+        Reading
+    };
+
+    enum class State {
+        AwaitingAnswer,
+        AwaitingRetry,   // Wrong answer given; retry() asks the same question again
+        AwaitingAdvance, // Right answer given; advance() moves on
+        Finished
+    };
+
+    QuizSession();
+    QuizSession(const QList<KanjiCard> &cards, Mode mode);
+
+    void restart();
+
+    State state() const { return currentState; }
+    bool isFinished() const { return currentState == State::Finished; }
+    int questionIndex() const { return currentQuestion; }
+    int questionCount() const { return cards.size() * 2; }
+    const KanjiCard &currentCard() const { return cards[currentQuestion / 2]; }
+    int currentCardIndex() const { return currentQuestion / 2; }
+    QuestionType currentType() const;
+    QString expectedAnswer() const;
+
+    QuizAnswerOutcome submitAnswer(const QString &answer);
+    void retry();
+    bool advance(); // True when that was the last question
+    const QuizCompletion &completion() const { return finalResult; }
+
+private:
+    void finish();
+
+    QList<KanjiCard> cards;
+    QList<AnswerMatcher> meaningMatchers; // Parallel to cards
+    QList<AnswerMatcher> readingMatchers;
+    Mode mode;
+
+    State currentState;
+    int currentQuestion;
+    QList<bool> results;      // Per question, answered correctly
+    QSet<int> leveledUpIds;   // Review cards already sent a level-up
+    int mistakes;
+    QuizCompletion finalResult;
+};
+
+#endif // QUIZ_SESSION_H
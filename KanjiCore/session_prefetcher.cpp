@@ -0,0 +1,124 @@
+#include "session_prefetcher.h"
+#include "kanji_change_notifier.h"
+#include "kanji_clock.h"
+#include <QThread>
+#include <QDebug>
+
+SessionPrefetcher::SessionPrefetcher(KanjiDatabase *database, int learningBatchSize, QObject *parent)
+    : QObject(parent), database(database), learningBatchSize(learningBatchSize),
+      worker(nullptr), refetchPending(false), waitingForFlush(false)
+{
+    // Answers arrive in bursts during a quiz; refetch once they pause
+    settleTimer = new QTimer(this);
+    settleTimer->setSingleShot(true);
+    settleTimer->setInterval(SettleDelayMs);
+    connect(settleTimer, &QTimer::timeout, this, &SessionPrefetcher::prefetch);
+
+    connect(database->notifier(), &KanjiChangeNotifier::changed, this, &SessionPrefetcher::onDatabaseChanged);
+    connect(database->notifier(), &KanjiChangeNotifier::progressFlushed, this, &SessionPrefetcher::onProgressFlushed);
+}
+
+SessionPrefetcher::~SessionPrefetcher()
+{
+    // The worker posts its result back to this object
+    if (worker) {
+        worker->wait();
+    }
+}
+
+void SessionPrefetcher::prefetch()
+{
+    if (worker) {
+        refetchPending = true;
+        return;
+    }
+    // The worker's connection only sees committed progress. Flushing here would
+    // commit every answer on its own during a quiz, so wait for the batch.
+    if (database->hasPendingProgress()) {
+        waitingForFlush = true;
+        return;
+    }
+    waitingForFlush = false;
+    refetchPending = false;
+
+    const quint64 revision = database->notifier()->revision();
+    const int batchSize = learningBatchSize;
+    const int deckId = database->activeDeck(); // Switching decks bumps the revision too
+
+    worker = QThread::create([this, revision, batchSize, deckId]() {
+        Snapshot result;
+        result.revision = revision;
+
+        KanjiDatabase reader("KanjiSessionPrefetch");
+        if (reader.open()) {
+            reader.setActiveDeck(deckId);
+
+            // Read the next due time first: anything due before the queue
+            // query runs is in the queue, so validUntil errs on the early side
+            result.validUntil = reader.getNextReviewTime();
+            result.learningBatch = reader.getNewKanji(batchSize);
+            result.reviewQueue = reader.getReviewKanji();
+            result.valid = true;
+        } else {
+            qDebug() << "Session prefetch failed:" << reader.getLastError();
+        }
+
+        QMetaObject::invokeMethod(this, [this, result]() { onFetched(result); }, Qt::QueuedConnection);
+    });
+    connect(worker, &QThread::finished, worker, &QObject::deleteLater);
+    worker->start();
+}
+
+void SessionPrefetcher::onFetched(const Snapshot &result)
+{
+    worker = nullptr;
+
+    // Written to while the worker was reading - the result may be stale
+    if (result.revision != database->notifier()->revision()) {
+        refetchPending = true;
+    } else if (result.valid) {
+        snapshot = result;
+        emit ready();
+    }
+
+    if (refetchPending) {
+        settleTimer->start();
+    }
+}
+
+void SessionPrefetcher::onDatabaseChanged()
+{
+    settleTimer->start();
+}
+
+void SessionPrefetcher::onProgressFlushed()
+{
+    if (waitingForFlush) {
+        prefetch();
+    }
+}
+
+bool SessionPrefetcher::isCurrent() const
+{
+    return snapshot.valid && snapshot.revision == database->notifier()->revision();
+}
+
+bool SessionPrefetcher::takeLearningBatch(QList<KanjiCard> &cards) const
+{
+    if (!isCurrent()) {
+        return false;
+    }
+    cards = snapshot.learningBatch;
+    return true;
+}
+
+bool SessionPrefetcher::takeReviewQueue(QList<KanjiCard> &cards) const
+{
+    // Time alone makes more cards due, so the queue also expires
+    if (!isCurrent() ||
+        (snapshot.validUntil.isValid() && snapshot.validUntil <= KanjiClock::now())) {
+        return false;
+    }
+    cards = snapshot.reviewQueue;
+    return true;
+}
@@ -0,0 +1,69 @@
+#ifndef SESSION_PREFETCHER_H
+#define SESSION_PREFETCHER_H
+
+// DLL Export/Import macros
+#ifdef _WIN32
+    #ifdef KANJICORE_EXPORTS
+        #define KANJICORE_API __declspec(dllexport)
+    #else
+        #define KANJICORE_API __declspec(dllimport)
+    #endif
+#else
+    #define KANJICORE_API
+#endif
+
+#include <QObject>
+#include <QList>
+#include <QDateTime>
+#include <QTimer>
+#include "kanji_database.h"
+
+// Keeps the next learning batch and the current review queue loaded ahead of
+// time so a study session can start without touching the database. Queries
+// run on a worker thread with its own connection. Every write through the
+// database bumps its notifier revision, which invalidates the cached results
+// immediately; a new fetch follows once the writes have settled and any
+// write-behind answers have been committed by the buffer's own flush.
+class KANJICORE_API SessionPrefetcher : public QObject
+{
+    Q_OBJECT
+
+public:
+    SessionPrefetcher(KanjiDatabase *database, int learningBatchSize, QObject *parent = nullptr);
+    ~SessionPrefetcher();
+
+    void prefetch(); // Start a fetch now unless one is running
+
+    // Fill cards and return true only if the cached result is still current
+    bool takeLearningBatch(QList<KanjiCard> &cards) const;
+    bool takeReviewQueue(QList<KanjiCard> &cards) const;
+
+signals:
+    void ready();
+
+private:
+    static constexpr int SettleDelayMs = 300;
+
+    struct Snapshot {
+        quint64 revision = 0;
+        bool valid = false;
+        QList<KanjiCard> learningBatch;
+        QList<KanjiCard> reviewQueue;
+        QDateTime validUntil; // Next card to become due after the queue was read
+    };
+
+    bool isCurrent() const;
+    void onDatabaseChanged();
+    void onProgressFlushed();
+    void onFetched(const Snapshot &result);
+
+    KanjiDatabase *database;
+    int learningBatchSize;
+    Snapshot snapshot;
+    QTimer *settleTimer;
+    QThread *worker;
+    bool refetchPending;
+    bool waitingForFlush; // Answers were pending; fetch once the buffer commits them
+};
+
+#endif // SESSION_PREFETCHER_H
@@ -0,0 +1,59 @@
+#include "asset_cache.h"
+#include "kanji_asset_format.h"
+#include <QResource>
+#include <QDebug>
+#include <cstring>
+
+const QImage &AssetCache::image(Asset asset)
+{
+    static QImage images[int(Asset::AssetCount)];
+    static bool loaded[int(Asset::AssetCount)] = {};
+    static const char *const paths[int(Asset::AssetCount)] = {
+        ":/assets/sprites/happy.kimg",
+        ":/assets/sprites/neutral.kimg",
+        ":/assets/sprites/sad.kimg"
+    };
+
+    const int index = int(asset);
+    if (!loaded[index]) {
+        images[index] = load(QString::fromLatin1(paths[index]));
+        loaded[index] = true;
+    }
+    return images[index];
+}
+
+QImage AssetCache::load(const QString &path)
+{
+    QResource resource(path);
+    if (!resource.isValid() || resource.compressionAlgorithm() != QResource::NoCompression) {
+        qDebug() << "Asset not available:" << path;
+        return QImage();
+    }
+
+    const uchar *data = resource.data();
+    const qint64 size = resource.size();
+    if (size < qint64(sizeof(KanjiAssetHeader))) {
+        qDebug() << "Asset truncated:" << path;
+        return QImage();
+    }
+
+    KanjiAssetHeader header;
+    std::memcpy(&header, data, sizeof(header));
+    const qint64 pixelBytes = qint64(header.bytesPerLine) * header.height;
+    if (std::memcmp(header.magic, "KIMG", 4) != 0 || header.version != KanjiAssetVersion ||
+        size < qint64(sizeof(header)) + pixelBytes) {
+        qDebug() << "Asset has an unexpected format:" << path;
+        return QImage();
+    }
+
+    const uchar *pixels = data + sizeof(header);
+    QImage image(pixels, int(header.width), int(header.height), int(header.bytesPerLine),
+                 QImage::Format(header.format));
+
+    // Resource data lives for the whole run, so the image can point at it
+    // directly - unless the compiler placed it unaligned for 32-bit pixels
+    if (quintptr(pixels) % 4 != 0) {
+        return image.copy();
+    }
+    return image;
+}
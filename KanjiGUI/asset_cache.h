@@ -0,0 +1,26 @@
+#ifndef ASSET_CACHE_H
+#define ASSET_CACHE_H
+
+#include <QImage>
+
+// Images packed into the executable at build time (KanjiAssetPacker + rcc,
+// uncompressed). Each is wrapped on first use as a QImage pointing straight
+// at the resource data, so nothing is decoded or scaled while the app runs.
+class AssetCache
+{
+public:
+    enum class Asset {
+        HappySprite,
+        NeutralSprite,
+        SadSprite,
+        AssetCount
+    };
+
+    // Null image if the asset is missing from the build; GUI thread only
+    static const QImage &image(Asset asset);
+
+private:
+    static QImage load(const QString &path);
+};
+
+#endif // ASSET_CACHE_H
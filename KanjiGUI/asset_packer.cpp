@@ -0,0 +1,72 @@
+#include "kanji_asset_format.h"
+#include <QCoreApplication>
+#include <QStringList>
+#include <QImage>
+#include <QFile>
+#include <QDebug>
+#include <cstring>
+
+// Build-time tool: decodes one PNG, scales it to the size it is drawn at and
+// writes it as a .kimg (see kanji_asset_format.h).
+//
+// Usage: KanjiAssetPacker <input.png> <output.kimg> <width> <height> <fit|fill> <argb|rgb>
+//   fit  - scale to fit inside width x height, keeping the aspect ratio
+//   fill - scale to cover width x height and crop the center
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QStringList args = app.arguments();
+
+    if (args.size() != 7) {
+        qCritical() << "Usage: KanjiAssetPacker <input.png> <output.kimg> <width> <height> <fit|fill> <argb|rgb>";
+        return 1;
+    }
+
+    const QString inputPath = args[1];
+    const QString outputPath = args[2];
+    const int width = args[3].toInt();
+    const int height = args[4].toInt();
+    const bool fill = args[5] == "fill";
+    const bool opaque = args[6] == "rgb";
+
+    QImage source(inputPath);
+    if (source.isNull() || width <= 0 || height <= 0) {
+        qCritical() << "Cannot read image" << inputPath;
+        return 1;
+    }
+
+    QImage scaled = source.scaled(width, height,
+                                  fill ? Qt::KeepAspectRatioByExpanding : Qt::KeepAspectRatio,
+                                  Qt::SmoothTransformation);
+    if (fill) {
+        scaled = scaled.copy((scaled.width() - width) / 2, (scaled.height() - height) / 2, width, height);
+    }
+
+    // The formats the raster paint engine blends without converting
+    QImage packed = scaled.convertToFormat(opaque ? QImage::Format_RGB32 : QImage::Format_ARGB32_Premultiplied);
+
+    KanjiAssetHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, "KIMG", 4);
+    header.version = KanjiAssetVersion;
+    header.width = quint32(packed.width());
+    header.height = quint32(packed.height());
+    header.bytesPerLine = quint32(packed.bytesPerLine());
+    header.format = quint32(packed.format());
+
+    QFile output(outputPath);
+    if (!output.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qCritical() << "Cannot write" << outputPath << ":" << output.errorString();
+        return 1;
+    }
+
+    output.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    output.write(reinterpret_cast<const char *>(packed.constBits()), packed.sizeInBytes());
+
+    if (output.error() != QFile::NoError) {
+        qCritical() << "Failed writing" << outputPath << ":" << output.errorString();
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,120 @@
+#include "feedback_overlay.h"
+#include "asset_cache.h"
+#include <QPainter>
+#include <QEvent>
+
+FeedbackOverlay::FeedbackOverlay(QWidget *parent)
+    : QWidget(parent), currentStyle(Style::Success), currentOpacity(0.0)
+{
+    // Same colors the per-answer stylesheet used, resolved once
+    styles[int(Style::Success)] = {QColor("#28a745"), QPen(QColor("#28a745"), 4),
+                                   AssetCache::image(AssetCache::Asset::HappySprite)};
+    styles[int(Style::Error)] = {QColor("#dc3545"), QPen(QColor("#dc3545"), 4),
+                                 AssetCache::image(AssetCache::Asset::SadSprite)};
+    styles[int(Style::Warning)] = {QColor("#ffc107"), QPen(QColor("#ffc107"), 4),
+                                   AssetCache::image(AssetCache::Asset::NeutralSprite)};
+
+    messageFont = QFont("Arial");
+    messageFont.setPixelSize(32);
+    messageFont.setBold(true);
+    dimColor = QColor(0, 0, 0, 128);
+
+    fadeAnimation = new QPropertyAnimation(this, "opacity", this);
+    connect(fadeAnimation, &QPropertyAnimation::finished, this, &FeedbackOverlay::onFadeFinished);
+
+    hideTimer = new QTimer(this);
+    hideTimer->setSingleShot(true);
+    connect(hideTimer, &QTimer::timeout, this, &FeedbackOverlay::dismiss);
+
+    // Follow the parent's size instead of being re-laid out per message
+    parent->installEventFilter(this);
+    setGeometry(parent->rect());
+    hide();
+}
+
+void FeedbackOverlay::showMessage(const QString &message, Style style, int durationMs)
+{
+    text = message;
+    currentStyle = style;
+
+    if (!isVisible()) {
+        show();
+    }
+    raise();
+    fadeTo(1.0, FadeInMs);
+    update();
+
+    hideTimer->start(durationMs);
+}
+
+void FeedbackOverlay::dismiss()
+{
+    hideTimer->stop();
+    if (isVisible()) {
+        fadeTo(0.0, FadeOutMs);
+    }
+}
+
+void FeedbackOverlay::setOpacity(qreal value)
+{
+    if (qFuzzyCompare(currentOpacity, value)) {
+        return;
+    }
+    currentOpacity = value;
+    update();
+}
+
+void FeedbackOverlay::fadeTo(qreal target, int durationMs)
+{
+    fadeAnimation->stop();
+    fadeAnimation->setStartValue(currentOpacity);
+    fadeAnimation->setEndValue(target);
+    fadeAnimation->setDuration(durationMs);
+    fadeAnimation->start();
+}
+
+void FeedbackOverlay::onFadeFinished()
+{
+    if (currentOpacity <= 0.0) {
+        hide();
+    }
+}
+
+void FeedbackOverlay::paintEvent(QPaintEvent *)
+{
+    if (currentOpacity <= 0.0) {
+        return;
+    }
+
+    QPainter painter(this);
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.setOpacity(currentOpacity);
+
+    painter.fillRect(rect(), dimColor);
+
+    const StylePreset &preset = styles[int(currentStyle)];
+    QRectF card((width() - CardWidth) / 2.0, (height() - CardHeight) / 2.0, CardWidth, CardHeight);
+
+    // Sprites are packed at their drawn size, so this is an unscaled blend
+    if (!preset.sprite.isNull()) {
+        QPointF spritePos(card.left() - SpriteSpacing - preset.sprite.width(),
+                          card.center().y() - preset.sprite.height() / 2.0);
+        painter.drawImage(spritePos.toPoint(), preset.sprite);
+    }
+
+    painter.setPen(preset.border);
+    painter.setBrush(Qt::white);
+    painter.drawRoundedRect(card.adjusted(2, 2, -2, -2), 15, 15);
+
+    painter.setFont(messageFont);
+    painter.setPen(preset.text);
+    painter.drawText(card.adjusted(40, 40, -40, -40), Qt::AlignCenter | Qt::TextWordWrap, text);
+}
+
+bool FeedbackOverlay::eventFilter(QObject *watched, QEvent *event)
+{
+    if (watched == parent() && event->type() == QEvent::Resize) {
+        setGeometry(parentWidget()->rect());
+    }
+    return QWidget::eventFilter(watched, event);
+}
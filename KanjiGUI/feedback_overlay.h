@@ -0,0 +1,68 @@
+#ifndef FEEDBACK_OVERLAY_H
+#define FEEDBACK_OVERLAY_H
+
+#include <QtWidgets/QWidget>
+#include <QColor>
+#include <QFont>
+#include <QPen>
+#include <QImage>
+#include <QTimer>
+#include <QPropertyAnimation>
+
+// Answer feedback card drawn over a window. Created once per window and reused
+// for every message: styles are precomputed, painting is done by hand and the
+// fade only animates an opacity value, so showing feedback never allocates
+// widgets or parses a stylesheet.
+class FeedbackOverlay : public QWidget
+{
+    Q_OBJECT
+    Q_PROPERTY(qreal opacity READ opacity WRITE setOpacity)
+
+public:
+    enum class Style {
+        Success,
+        Error,
+        Warning
+    };
+
+    explicit FeedbackOverlay(QWidget *parent);
+
+    void showMessage(const QString &message, Style style, int durationMs = 1000);
+    void dismiss();
+
+    qreal opacity() const { return currentOpacity; }
+    void setOpacity(qreal value);
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    bool eventFilter(QObject *watched, QEvent *event) override;
+
+private:
+    struct StylePreset {
+        QColor text;
+        QPen border;
+        QImage sprite; // Mood sprite from AssetCache, drawn left of the card
+    };
+
+    static constexpr int CardWidth = 500;
+    static constexpr int CardHeight = 250;
+    static constexpr int FadeInMs = 120;
+    static constexpr int FadeOutMs = 200;
+    static constexpr int SpriteSpacing = 20;
+
+    void fadeTo(qreal target, int durationMs);
+    void onFadeFinished();
+
+    StylePreset styles[3];
+    QFont messageFont;
+    QColor dimColor;
+
+    QString text;
+    Style currentStyle;
+    qreal currentOpacity;
+
+    QPropertyAnimation *fadeAnimation;
+    QTimer *hideTimer;
+};
+
+#endif // FEEDBACK_OVERLAY_H
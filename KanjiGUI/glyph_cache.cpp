@@ -0,0 +1,110 @@
+#include "glyph_cache.h"
+#include <QPainter>
+#include <QFont>
+#include <QFontMetricsF>
+#include <QMutexLocker>
+#include <QtMath>
+
+GlyphCache::GlyphCache(qint64 maxBytes)
+    : images(maxBytes), color(Qt::black), hits(0), misses(0)
+{
+    // One worker is enough to stay ahead of the user and keeps the GUI thread's core free
+    worker.setMaxThreadCount(1);
+}
+
+GlyphCache::~GlyphCache()
+{
+    worker.clear();
+    worker.waitForDone();
+}
+
+QString GlyphCache::cacheKey(const QString &kanji, int pixelSize, qreal devicePixelRatio)
+{
+    return QString("%1|%2|%3").arg(kanji).arg(pixelSize).arg(devicePixelRatio, 0, 'f', 2);
+}
+
+QPixmap GlyphCache::pixmap(const QString &kanji, int pixelSize, qreal devicePixelRatio)
+{
+    const QString key = cacheKey(kanji, pixelSize, devicePixelRatio);
+
+    QImage image;
+    {
+        QMutexLocker locker(&mutex);
+        if (QImage *cached = images.object(key)) {
+            image = *cached;
+            ++hits;
+        } else {
+            ++misses;
+        }
+    }
+
+    if (image.isNull()) {
+        image = render(kanji, pixelSize, devicePixelRatio);
+        insert(key, image);
+    }
+
+    // Premultiplied ARGB matches the raster backing store, so this is a plain copy
+    return QPixmap::fromImage(image);
+}
+
+void GlyphCache::prefetch(const QStringList &kanji, int pixelSize, qreal devicePixelRatio)
+{
+    QStringList missing;
+    {
+        QMutexLocker locker(&mutex);
+        for (const QString &text : kanji) {
+            const QString key = cacheKey(text, pixelSize, devicePixelRatio);
+            if (!text.isEmpty() && !images.contains(key) && !pending.contains(key)) {
+                pending.insert(key);
+                missing.append(text);
+            }
+        }
+    }
+
+    if (missing.isEmpty()) {
+        return;
+    }
+
+    worker.start([this, missing, pixelSize, devicePixelRatio]() {
+        for (const QString &text : missing) {
+            const QString key = cacheKey(text, pixelSize, devicePixelRatio);
+            QImage image = render(text, pixelSize, devicePixelRatio);
+
+            QMutexLocker locker(&mutex);
+            pending.remove(key);
+            images.insert(key, new QImage(image), image.sizeInBytes());
+        }
+    });
+}
+
+void GlyphCache::insert(const QString &key, const QImage &image)
+{
+    QMutexLocker locker(&mutex);
+    images.insert(key, new QImage(image), image.sizeInBytes());
+}
+
+QImage GlyphCache::render(const QString &kanji, int pixelSize, qreal devicePixelRatio) const
+{
+    // Same face the labels' stylesheet font used
+    QFont font("Arial");
+    font.setPixelSize(pixelSize);
+    font.setBold(true);
+
+    QFontMetricsF metrics(font);
+    QSizeF logicalSize(qMax(metrics.horizontalAdvance(kanji), qreal(pixelSize)), metrics.height());
+
+    QImage image(qCeil(logicalSize.width() * devicePixelRatio),
+                 qCeil(logicalSize.height() * devicePixelRatio),
+                 QImage::Format_ARGB32_Premultiplied);
+    image.setDevicePixelRatio(devicePixelRatio);
+    image.fill(Qt::transparent);
+
+    QPainter painter(&image);
+    painter.setRenderHint(QPainter::TextAntialiasing);
+    painter.setFont(font);
+    painter.setPen(color);
+    painter.drawText(QRectF(QPointF(0, 0), logicalSize), Qt::AlignCenter, kanji);
+    painter.end();
+
+    return image;
+}
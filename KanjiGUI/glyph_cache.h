@@ -0,0 +1,48 @@
+#ifndef GLYPH_CACHE_H
+#define GLYPH_CACHE_H
+
+#include <QString>
+#include <QStringList>
+#include <QImage>
+#include <QPixmap>
+#include <QColor>
+#include <QCache>
+#include <QSet>
+#include <QMutex>
+#include <QThreadPool>
+
+// Large kanji rendered once into images and reused, so showing a card is a
+// blit rather than a text layout and rasterization of a 240-300px glyph.
+// Images are keyed by text, pixel size and device pixel ratio; the cache is
+// an LRU bounded by image bytes. Upcoming cards can be rendered ahead of time
+// on a worker thread.
+class GlyphCache
+{
+public:
+    explicit GlyphCache(qint64 maxBytes = 48 * 1024 * 1024);
+    ~GlyphCache();
+
+    // Cached glyph, rendered on the calling thread if it was not prefetched
+    QPixmap pixmap(const QString &kanji, int pixelSize, qreal devicePixelRatio);
+
+    // Render any of these that are missing in the background
+    void prefetch(const QStringList &kanji, int pixelSize, qreal devicePixelRatio);
+
+    int getHitCount() const { return hits; }
+    int getMissCount() const { return misses; }
+
+private:
+    static QString cacheKey(const QString &kanji, int pixelSize, qreal devicePixelRatio);
+    QImage render(const QString &kanji, int pixelSize, qreal devicePixelRatio) const;
+    void insert(const QString &key, const QImage &image);
+
+    QCache<QString, QImage> images; // Cost = bytes
+    QSet<QString> pending;          // Queued or being rendered by the worker
+    mutable QMutex mutex;
+    QThreadPool worker;
+    QColor color;
+    int hits;
+    int misses;
+};
+
+#endif // GLYPH_CACHE_H
@@ -0,0 +1,24 @@
+#ifndef KANJI_ASSET_FORMAT_H
+#define KANJI_ASSET_FORMAT_H
+
+#include <QtGlobal>
+
+// Layout of the .kimg files written by KanjiAssetPacker at build time and read
+// by AssetCache at run time: this header followed by raw scanlines in the
+// given QImage::Format, ready to be wrapped by a QImage without decoding.
+// Pixel data is in host byte order, so the packer must run on the target.
+struct KanjiAssetHeader {
+    char magic[4];         // "KIMG"
+    quint32 version;
+    quint32 width;
+    quint32 height;
+    quint32 bytesPerLine;
+    quint32 format;        // QImage::Format value
+    quint32 reserved[2];   // Pads the header to 32 bytes so scanlines stay aligned
+};
+
+static_assert(sizeof(KanjiAssetHeader) == 32, "KanjiAssetHeader must stay 32 bytes");
+
+constexpr quint32 KanjiAssetVersion = 1;
+
+#endif // KANJI_ASSET_FORMAT_H
@@ -0,0 +1,81 @@
+#include "kanji_browser_window.h"
+#include "kanji_card_model.h"
+#include <QtWidgets/QVBoxLayout>
+#include <QtWidgets/QHBoxLayout>
+#include <QtWidgets/QHeaderView>
+
+KanjiBrowserWindow::KanjiBrowserWindow(KanjiDatabase *database, QWidget *parent)
+    : QWidget(parent, Qt::Window), model(new KanjiCardModel(database, this))
+{
+    setupUI();
+    
+    connect(model, &KanjiCardModel::matchesChanged, this, &KanjiBrowserWindow::updateMatchCount);
+    updateMatchCount();
+}
+
+void KanjiBrowserWindow::setupUI()
+{
+    QVBoxLayout *layout = new QVBoxLayout(this);
+    
+    QHBoxLayout *filterLayout = new QHBoxLayout();
+    filterLineEdit = new QLineEdit();
+    filterLineEdit->setPlaceholderText("Filter by kanji, meaning or reading...");
+    filterLineEdit->setClearButtonEnabled(true);
+    filterLayout->addWidget(filterLineEdit, 1);
+    
+    statusComboBox = new QComboBox();
+    statusComboBox->addItem("All Cards", KanjiBrowseQuery::AllCards);
+    statusComboBox->addItem("New", KanjiBrowseQuery::NewCards);
+    statusComboBox->addItem("Learned", KanjiBrowseQuery::LearnedCards);
+    statusComboBox->addItem("Due for Review", KanjiBrowseQuery::DueCards);
+    filterLayout->addWidget(statusComboBox);
+    
+    matchCountLabel = new QLabel();
+    filterLayout->addWidget(matchCountLabel);
+    layout->addLayout(filterLayout);
+    
+    tableView = new QTableView();
+    tableView->setModel(model);
+    tableView->setSelectionBehavior(QAbstractItemView::SelectRows);
+    tableView->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    tableView->setAlternatingRowColors(true);
+    tableView->setWordWrap(false);
+    
+    // Fixed row heights and interactive column widths keep the view from
+    // asking the model for size hints of rows it has not fetched
+    tableView->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+    tableView->verticalHeader()->setDefaultSectionSize(28);
+    tableView->verticalHeader()->hide();
+    tableView->horizontalHeader()->setSectionResizeMode(QHeaderView::Interactive);
+    tableView->horizontalHeader()->setStretchLastSection(true);
+    tableView->horizontalHeader()->setSortIndicator(-1, Qt::AscendingOrder);
+    tableView->setSortingEnabled(true);
+    layout->addWidget(tableView);
+    
+    filterTimer = new QTimer(this);
+    filterTimer->setSingleShot(true);
+    filterTimer->setInterval(FilterDelayMs);
+    connect(filterTimer, &QTimer::timeout, this, &KanjiBrowserWindow::applyTextFilter);
+    connect(filterLineEdit, &QLineEdit::textChanged, filterTimer, qOverload<>(&QTimer::start));
+    connect(statusComboBox, &QComboBox::currentIndexChanged, this, &KanjiBrowserWindow::onStatusChanged);
+    
+    setWindowTitle("Browse Kanji");
+    resize(900, 600);
+    
+    setObjectName("KanjiBrowserWindow");
+}
+
+void KanjiBrowserWindow::onStatusChanged(int index)
+{
+    model->setStatusFilter(KanjiBrowseQuery::Status(statusComboBox->itemData(index).toInt()));
+}
+
+void KanjiBrowserWindow::applyTextFilter()
+{
+    model->setTextFilter(filterLineEdit->text());
+}
+
+void KanjiBrowserWindow::updateMatchCount()
+{
+    matchCountLabel->setText(QString("%1 cards").arg(model->matchingCount()));
+}
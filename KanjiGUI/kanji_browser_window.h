@@ -0,0 +1,41 @@
+#ifndef KANJI_BROWSER_WINDOW_H
+#define KANJI_BROWSER_WINDOW_H
+
+#include <QtWidgets/QWidget>
+#include <QtWidgets/QTableView>
+#include <QtWidgets/QLineEdit>
+#include <QtWidgets/QComboBox>
+#include <QtWidgets/QLabel>
+#include <QTimer>
+#include "kanji_database.h"
+
+class KanjiCardModel;
+
+// Read-only table of every card in the deck with a status and text filter.
+// Columns with an index behind them sort when their header is clicked.
+class KanjiBrowserWindow : public QWidget
+{
+    Q_OBJECT
+
+public:
+    KanjiBrowserWindow(KanjiDatabase *database, QWidget *parent = nullptr);
+
+private slots:
+    void onStatusChanged(int index);
+    void applyTextFilter();
+    void updateMatchCount();
+
+private:
+    static constexpr int FilterDelayMs = 200; // Wait for a pause in typing before querying
+
+    void setupUI();
+
+    KanjiCardModel *model;
+    QTableView *tableView;
+    QLineEdit *filterLineEdit;
+    QComboBox *statusComboBox;
+    QLabel *matchCountLabel;
+    QTimer *filterTimer;
+};
+
+#endif // KANJI_BROWSER_WINDOW_H
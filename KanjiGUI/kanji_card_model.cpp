@@ -0,0 +1,228 @@
+#include "kanji_card_model.h"
+#include <QLocale>
+#include <QSet>
+
+KanjiCardModel::KanjiCardModel(KanjiDatabase *database, QObject *parent)
+    : QAbstractTableModel(parent), database(database), fetchedRows(0), reachedEnd(false),
+      pages(CachedPages)
+{
+    connect(database->notifier(), &KanjiChangeNotifier::changed, this, &KanjiCardModel::onDatabaseChanged);
+    reload();
+}
+
+int KanjiCardModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : fetchedRows;
+}
+
+int KanjiCardModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+QVariant KanjiCardModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= fetchedRows) {
+        return QVariant();
+    }
+
+    if (role == Qt::TextAlignmentRole) {
+        switch (index.column()) {
+            case KanjiColumn: return int(Qt::AlignCenter);
+            case SrsLevelColumn:
+            case ReviewCountColumn:
+            case PriorityColumn: return int(Qt::AlignRight | Qt::AlignVCenter);
+            default: return QVariant();
+        }
+    }
+
+    if (role != Qt::DisplayRole) {
+        return QVariant();
+    }
+
+    const KanjiResultSet *rows = page(index.row() / PageSize);
+    const int offset = index.row() % PageSize;
+    if (!rows || offset >= rows->size()) {
+        return QVariant();
+    }
+
+    const KanjiCardRow &card = rows->at(offset);
+    switch (index.column()) {
+        case KanjiColumn: return card.kanji.toString();
+        case MeaningColumn: return card.meaning.toString();
+        case OnReadingColumn: return card.on_reading.toString();
+        case KunReadingColumn: return card.kun_reading.toString();
+        case SrsLevelColumn: return card.is_learned ? QVariant(card.srs_level) : QVariant("New");
+        case NextReviewColumn:
+            if (!card.is_learned || card.next_review_ms < 0) {
+                return QVariant();
+            }
+            return QLocale().toString(card.nextReview(), QLocale::ShortFormat);
+        case ReviewCountColumn: return card.review_count;
+        case PriorityColumn: return card.priority;
+        default: return QVariant();
+    }
+}
+
+QVariant KanjiCardModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole) {
+        return QAbstractTableModel::headerData(section, orientation, role);
+    }
+
+    switch (section) {
+        case KanjiColumn: return "Kanji";
+        case MeaningColumn: return "Meaning";
+        case OnReadingColumn: return "On'yomi";
+        case KunReadingColumn: return "Kun'yomi";
+        case SrsLevelColumn: return "SRS Level";
+        case NextReviewColumn: return "Next Review";
+        case ReviewCountColumn: return "Reviews";
+        case PriorityColumn: return "Frequency";
+        default: return QVariant();
+    }
+}
+
+bool KanjiCardModel::canFetchMore(const QModelIndex &parent) const
+{
+    return !parent.isValid() && !reachedEnd;
+}
+
+void KanjiCardModel::fetchMore(const QModelIndex &parent)
+{
+    if (parent.isValid() || reachedEnd) {
+        return;
+    }
+
+    KanjiResultSet rows = database->getKanjiPageRows(browse, nextCursor, PageSize);
+    if (rows.size() < PageSize) {
+        reachedEnd = true;
+    }
+    if (rows.isEmpty()) {
+        return;
+    }
+
+    beginInsertRows(QModelIndex(), fetchedRows, fetchedRows + rows.size() - 1);
+    pageStarts.append(nextCursor);
+    nextCursor = KanjiDatabase::cursorAfter(rows.last(), browse.sortKey);
+    fetchedRows += rows.size();
+    pages.insert(pageStarts.size() - 1, new KanjiResultSet(std::move(rows)));
+    endInsertRows();
+}
+
+void KanjiCardModel::sort(int column, Qt::SortOrder order)
+{
+    // Only columns with an index behind them sort; anything else falls back to deck order
+    KanjiBrowseQuery::SortKey sortKey;
+    switch (column) {
+        case KanjiColumn: sortKey = KanjiBrowseQuery::SortByKanji; break;
+        case SrsLevelColumn: sortKey = KanjiBrowseQuery::SortBySrsLevel; break;
+        case NextReviewColumn: sortKey = KanjiBrowseQuery::SortByNextReview; break;
+        case PriorityColumn: sortKey = KanjiBrowseQuery::SortByPriority; break;
+        default: sortKey = KanjiBrowseQuery::SortById; break;
+    }
+
+    const bool descending = order == Qt::DescendingOrder;
+    if (sortKey == browse.sortKey && descending == browse.descending) {
+        return;
+    }
+
+    browse.sortKey = sortKey;
+    browse.descending = descending;
+    reload();
+}
+
+void KanjiCardModel::setStatusFilter(KanjiBrowseQuery::Status status)
+{
+    if (status == browse.status) {
+        return;
+    }
+    browse.status = status;
+    reload();
+    emit matchesChanged();
+}
+
+void KanjiCardModel::setTextFilter(const QString &text)
+{
+    if (text == browse.text) {
+        return;
+    }
+    browse.text = text;
+    reload();
+    emit matchesChanged();
+}
+
+int KanjiCardModel::matchingCount() const
+{
+    return database->countKanji(browse);
+}
+
+void KanjiCardModel::onDatabaseChanged(const KanjiChangeSet &change)
+{
+    const int progressKinds = KanjiChangeSet::CardsLearned | KanjiChangeSet::CardsRescheduled;
+    const bool bulk = change.kinds & (KanjiChangeSet::CardsReset | KanjiChangeSet::CardsImported |
+                                      KanjiChangeSet::ScopeChanged);
+    const bool filtered = browse.status != KanjiBrowseQuery::AllCards && (change.kinds & progressKinds);
+    bool reordered = false;
+    switch (browse.sortKey) {
+        case KanjiBrowseQuery::SortBySrsLevel:
+        case KanjiBrowseQuery::SortByNextReview: reordered = change.kinds & progressKinds; break;
+        case KanjiBrowseQuery::SortByPriority: reordered = change.kinds & KanjiChangeSet::CardsReordered; break;
+        default: break;
+    }
+
+    // Rows may have moved between pages, which would leave the saved cursors
+    // pointing at the wrong places, so start over from the top
+    if (bulk || filtered || reordered) {
+        reload();
+        emit matchesChanged();
+        return;
+    }
+
+    // Same rows in the same order: the page cursors still hold, only cached
+    // pages showing a changed card are dropped and re-read when next drawn
+    const QSet<int> changed(change.cardIds.cbegin(), change.cardIds.cend());
+    const QList<int> cached = pages.keys();
+    for (int pageIndex : cached) {
+        const KanjiResultSet *rows = pages.object(pageIndex);
+        bool stale = changed.isEmpty(); // Bulk priority updates name no cards
+        for (int i = 0; !stale && i < rows->size(); ++i) {
+            stale = changed.contains(rows->at(i).id);
+        }
+        if (stale) {
+            pages.remove(pageIndex);
+            const int first = pageIndex * PageSize;
+            emit dataChanged(index(first, 0), index(qMin(first + PageSize, fetchedRows) - 1, ColumnCount - 1));
+        }
+    }
+}
+
+const KanjiResultSet *KanjiCardModel::page(int pageIndex) const
+{
+    if (pageIndex < 0 || pageIndex >= pageStarts.size()) {
+        return nullptr;
+    }
+
+    if (KanjiResultSet *cached = pages.object(pageIndex)) {
+        return cached;
+    }
+
+    // Evicted earlier - seek back to where the page started
+    KanjiResultSet *rows = new KanjiResultSet(database->getKanjiPageRows(browse, pageStarts.at(pageIndex), PageSize));
+    pages.insert(pageIndex, rows);
+    return rows;
+}
+
+void KanjiCardModel::reload()
+{
+    beginResetModel();
+    pageStarts.clear();
+    nextCursor = KanjiPageCursor();
+    fetchedRows = 0;
+    reachedEnd = false;
+    pages.clear();
+    endResetModel();
+
+    // Views only ask for more rows once they have some to scroll through
+    fetchMore(QModelIndex());
+}
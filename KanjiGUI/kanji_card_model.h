@@ -0,0 +1,69 @@
+#ifndef KANJI_CARD_MODEL_H
+#define KANJI_CARD_MODEL_H
+
+#include <QAbstractTableModel>
+#include <QCache>
+#include <QList>
+#include "kanji_database.h"
+#include "kanji_change_notifier.h"
+
+// Whole-deck table model for the card browser. Rows arrive a page at a time
+// through fetchMore() as the view scrolls, using keyset paging so every page
+// is an index seek. Only the start cursor of each page is kept for good; page
+// contents live in a small cache and evicted pages are re-read on demand.
+// Pages are arena-backed result sets, so a cached page is a few allocations.
+class KanjiCardModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    enum Column {
+        KanjiColumn,
+        MeaningColumn,
+        OnReadingColumn,
+        KunReadingColumn,
+        SrsLevelColumn,
+        NextReviewColumn,
+        ReviewCountColumn,
+        PriorityColumn,
+        ColumnCount
+    };
+
+    static constexpr int PageSize = 256;
+    static constexpr int CachedPages = 16; // About four screens either side of the viewport
+
+    explicit KanjiCardModel(KanjiDatabase *database, QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+    bool canFetchMore(const QModelIndex &parent) const override;
+    void fetchMore(const QModelIndex &parent) override;
+    void sort(int column, Qt::SortOrder order = Qt::AscendingOrder) override;
+
+    void setStatusFilter(KanjiBrowseQuery::Status status);
+    void setTextFilter(const QString &text);
+    int matchingCount() const; // Rows the current filter matches, fetched or not
+
+signals:
+    void matchesChanged(); // Filter or deck changed, matchingCount() may differ
+
+private slots:
+    void onDatabaseChanged(const KanjiChangeSet &change);
+
+private:
+    const KanjiResultSet *page(int pageIndex) const;
+    void reload();
+
+    KanjiDatabase *database;
+    KanjiBrowseQuery browse;
+    QList<KanjiPageCursor> pageStarts; // Cursor in front of each fetched page
+    KanjiPageCursor nextCursor;        // After the last fetched row
+    int fetchedRows;
+    bool reachedEnd;
+    mutable QCache<int, KanjiResultSet> pages;
+};
+
+#endif // KANJI_CARD_MODEL_H
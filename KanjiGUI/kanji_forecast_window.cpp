@@ -0,0 +1,125 @@
+#include "kanji_forecast_window.h"
+#include "kanji_clock.h"
+#include <QtWidgets/QVBoxLayout>
+#include <QtWidgets/QHBoxLayout>
+#include <QtWidgets/QHeaderView>
+#include <QLocale>
+#include <cmath>
+
+KanjiForecastWindow::KanjiForecastWindow(KanjiForecast *forecast, QWidget *parent)
+    : QWidget(parent, Qt::Window), forecast(forecast)
+{
+    setupUI();
+    
+    // Answers elsewhere move cards between buckets while the window is open
+    connect(forecast, &KanjiForecast::forecastChanged, this, [this]() {
+        if (isVisible()) {
+            updateForecast();
+        }
+    });
+}
+
+void KanjiForecastWindow::setupUI()
+{
+    QVBoxLayout *layout = new QVBoxLayout(this);
+    
+    QHBoxLayout *optionsLayout = new QHBoxLayout();
+    rangeComboBox = new QComboBox();
+    rangeComboBox->addItem(QString("Next %1 days").arg(forecast->horizonDays()));
+    rangeComboBox->addItem(QString("Next %1 hours").arg(HourlyRange));
+    optionsLayout->addWidget(rangeComboBox);
+    
+    optionsLayout->addWidget(new QLabel("Accuracy:"));
+    accuracySpinBox = new QDoubleSpinBox();
+    accuracySpinBox->setRange(0, 100);
+    accuracySpinBox->setDecimals(0);
+    accuracySpinBox->setSuffix(" %");
+    accuracySpinBox->setValue(85);
+    optionsLayout->addWidget(accuracySpinBox);
+    
+    optionsLayout->addWidget(new QLabel("New cards per day:"));
+    newCardsSpinBox = new QSpinBox();
+    newCardsSpinBox->setRange(0, 500);
+    newCardsSpinBox->setValue(0);
+    optionsLayout->addWidget(newCardsSpinBox);
+    optionsLayout->addStretch();
+    layout->addLayout(optionsLayout);
+    
+    table = new QTableWidget(0, 3);
+    table->setHorizontalHeaderLabels({"When", "Scheduled", "Expected"});
+    table->horizontalHeaderItem(1)->setToolTip("Reviews of cards already scheduled");
+    table->horizontalHeaderItem(2)->setToolTip("Scheduled reviews plus the reviews they lead to");
+    table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    table->setSelectionBehavior(QAbstractItemView::SelectRows);
+    table->setAlternatingRowColors(true);
+    table->verticalHeader()->hide();
+    table->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+    layout->addWidget(table);
+    
+    summaryLabel = new QLabel();
+    layout->addWidget(summaryLabel);
+    
+    connect(rangeComboBox, &QComboBox::currentIndexChanged, this, &KanjiForecastWindow::updateForecast);
+    connect(accuracySpinBox, &QDoubleSpinBox::valueChanged, this, &KanjiForecastWindow::updateForecast);
+    connect(newCardsSpinBox, &QSpinBox::valueChanged, this, &KanjiForecastWindow::updateForecast);
+    
+    setWindowTitle("Review Forecast");
+    resize(520, 600);
+    
+    setObjectName("KanjiForecastWindow");
+}
+
+void KanjiForecastWindow::showEvent(QShowEvent *event)
+{
+    QWidget::showEvent(event);
+    updateForecast();
+}
+
+void KanjiForecastWindow::updateForecast()
+{
+    const bool hourly = rangeComboBox->currentIndex() == 1;
+    const double accuracy = accuracySpinBox->value() / 100.0;
+    const int newCards = newCardsSpinBox->value();
+    
+    QVector<int> scheduled;
+    QVector<double> expected;
+    if (hourly) {
+        scheduled = forecast->hourlyDue(HourlyRange);
+        expected = forecast->simulateHourly(HourlyRange, accuracy, newCards);
+    } else {
+        scheduled = forecast->dailyDue(forecast->horizonDays());
+        expected = forecast->simulateDaily(forecast->horizonDays(), accuracy, newCards);
+    }
+    
+    const QDateTime now = KanjiClock::now();
+    const QDateTime firstHour(now.date(), QTime(now.time().hour(), 0));
+    const QLocale locale;
+    
+    table->setRowCount(scheduled.size());
+    qint64 scheduledTotal = 0;
+    double expectedTotal = 0;
+    for (int row = 0; row < scheduled.size(); ++row) {
+        QString when;
+        if (hourly) {
+            when = row == 0 ? QString("Now") : locale.toString(firstHour.addSecs(qint64(row) * 3600), "ddd HH:mm");
+        } else {
+            when = row == 0 ? QString("Today") : row == 1 ? QString("Tomorrow")
+                                                         : locale.toString(now.date().addDays(row), "ddd d MMM");
+        }
+        const double expectedReviews = row < expected.size() ? expected[row] : 0.0;
+        
+        QTableWidgetItem *scheduledItem = new QTableWidgetItem(QString::number(scheduled[row]));
+        QTableWidgetItem *expectedItem = new QTableWidgetItem(QString::number(qRound64(expectedReviews)));
+        scheduledItem->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+        expectedItem->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+        table->setItem(row, 0, new QTableWidgetItem(when));
+        table->setItem(row, 1, scheduledItem);
+        table->setItem(row, 2, expectedItem);
+        
+        scheduledTotal += scheduled[row];
+        expectedTotal += expectedReviews;
+    }
+    
+    summaryLabel->setText(QString("%1 reviews scheduled, about %2 expected in total")
+                          .arg(scheduledTotal).arg(qRound64(expectedTotal)));
+}
@@ -0,0 +1,41 @@
+#ifndef KANJI_FORECAST_WINDOW_H
+#define KANJI_FORECAST_WINDOW_H
+
+#include <QtWidgets/QWidget>
+#include <QtWidgets/QTableWidget>
+#include <QtWidgets/QComboBox>
+#include <QtWidgets/QDoubleSpinBox>
+#include <QtWidgets/QSpinBox>
+#include <QtWidgets/QLabel>
+#include "kanji_forecast.h"
+
+// Reviews coming due per day or hour in the active deck: what is already
+// scheduled, and what to expect once those reviews schedule their own.
+// Reads only the forecast's histogram, never the kanji table.
+class KanjiForecastWindow : public QWidget
+{
+    Q_OBJECT
+
+public:
+    KanjiForecastWindow(KanjiForecast *forecast, QWidget *parent = nullptr);
+
+private slots:
+    void updateForecast();
+
+protected:
+    void showEvent(QShowEvent *event) override;
+
+private:
+    static constexpr int HourlyRange = 48;
+
+    void setupUI();
+
+    KanjiForecast *forecast;
+    QComboBox *rangeComboBox;
+    QDoubleSpinBox *accuracySpinBox;
+    QSpinBox *newCardsSpinBox;
+    QTableWidget *table;
+    QLabel *summaryLabel;
+};
+
+#endif // KANJI_FORECAST_WINDOW_H
@@ -1,23 +1,43 @@
 #include "kanji_learning_window.h"
 #include <japanese_text_utils.h>
+#include "kanji_theme.h"
+#include "latency_hud.h"
 #include <QtWidgets/QApplication>
 #include <QtWidgets/QMessageBox>
 #include <QTimer>
 #include <QDebug>
 #include <QKeyEvent>
+#include <QCloseEvent>
+#include <QElapsedTimer>
 #include <QPropertyAnimation>
 #include <QGraphicsOpacityEffect>
 
 KanjiLearningWindow::KanjiLearningWindow(KanjiDatabase *db, Mode mode, QWidget *parent)
-    : QMainWindow(parent), database(db), currentMode(mode), currentKanjiIndex(0), 
-      currentQuizIndex(0), currentQuizType(QuizType::Meaning),
-      questionAnsweredCorrectly(false), retryCount(0), isConverting(false)
+    : KanjiLearningWindow(db, mode, nullptr, parent)
+{
+}
+
+KanjiLearningWindow::KanjiLearningWindow(KanjiDatabase *db, Mode mode, const QList<KanjiCard> &sessionKanji, QWidget *parent)
+    : KanjiLearningWindow(db, mode, &sessionKanji, parent)
+{
+}
+
+KanjiLearningWindow::KanjiLearningWindow(KanjiDatabase *db, Mode mode, const QList<KanjiCard> *sessionKanji, QWidget *parent)
+    : QMainWindow(parent), database(db), currentMode(mode), currentKanjiIndex(0), isConverting(false)
 {
     try {
+        QElapsedTimer constructionTimer;
+        constructionTimer.start();
+        int polishesBefore = KanjiTheme::polishCount();
+        
+        // Polish now rather than on show() so the log covers the full styling cost
         setupUI();
+        ensurePolished();
+        qDebug() << "Learning window UI built in" << constructionTimer.elapsed() << "ms with"
+                 << KanjiTheme::polishCount() - polishesBefore << "polish events";
         
         if (currentMode == Mode::Learning) {
-            loadKanjiForLearning();
+            loadKanjiForLearning(sessionKanji);
             if (!studyKanji.isEmpty()) {
                 displayCurrentKanji();
                 switchToStudyMode();
@@ -25,21 +45,11 @@ KanjiLearningWindow::KanjiLearningWindow(KanjiDatabase *db, Mode mode, QWidget *
                 QMessageBox::information(this, "No New Kanji", "No new kanji available for learning.");
             }
         } else if (currentMode == Mode::Review) {
-            loadKanjiForReview();
+            loadKanjiForReview(sessionKanji);
             if (!studyKanji.isEmpty()) {
                 // For review mode, go directly to quiz - no need to study first
                 displayCurrentKanji();
-                
-                // Initialize quiz state
-                currentQuizIndex = 0;
-                quizResults.clear();
-                processedKanjiIds.clear(); // Clear tracking for review mode
-                for (int i = 0; i < studyKanji.size() * 2; ++i) {
-                    quizResults.append(false);
-                }
-                
-                switchToQuizMode();
-                startNextQuizQuestion();
+                beginQuiz();
             } else {
                 QMessageBox::information(this, "No Reviews", "No kanji are due for review at this time.");
             }
@@ -67,10 +77,27 @@ KanjiLearningWindow::~KanjiLearningWindow()
 {
 }
 
+void KanjiLearningWindow::attachLatencyMonitor(LatencyMonitor *monitor)
+{
+    latencyMonitor = monitor;
+    monitor->watchInput(answerLineEdit);
+    monitor->watchPaint(answerLineEdit, LatencyMonitor::Stage::KeyToPaint);
+    monitor->watchPaint(feedbackOverlay, LatencyMonitor::Stage::EnterToFeedback);
+    monitor->sampleWhileVisible(this); // Also covers the HUD, a child of this window
+    
+    // Connected after onAnswerTextChanged, so it runs once conversion is done
+    connect(answerLineEdit, &QLineEdit::textChanged, monitor, [monitor]() {
+        monitor->end(LatencyMonitor::Stage::KeyToConversion);
+    });
+    
+    latencyHud = new LatencyHud(monitor, this);
+}
+
 void KanjiLearningWindow::setupUI()
 {
     // Set window properties
     setWindowTitle("Learn New Kanji");
+    setObjectName("KanjiLearningWindow"); // Scopes the KanjiTheme rules for this window
     setFixedSize(1400, 1000);  // Even bigger for more kanji space
     
     // Create central widget
@@ -85,43 +112,8 @@ void KanjiLearningWindow::setupUI()
     createStudyInterface();
     createQuizInterface();
     
-    // Much darker, more visible styling
-    setStyleSheet(R"(
-        QWidget {
-            background-color: #f8f9fa;
-            font-family: Arial;
-        }
-        QPushButton {
-            background-color: #007bff;
-            color: white;
-            border: none;
-            padding: 12px 24px;
-            font-size: 16px;
-            font-weight: bold;
-            border-radius: 6px;
-            min-height: 40px;
-        }
-        QPushButton:hover {
-            background-color: #0056b3;
-        }
-        QPushButton:disabled {
-            background-color: #6c757d;
-            color: #ffffff;
-        }
-        QLineEdit {
-            background-color: white;
-            border: 3px solid #007bff;
-            padding: 12px;
-            font-size: 18px;
-            font-weight: bold;
-            border-radius: 6px;
-            color: #000000;
-        }
-        QLabel {
-            color: #000000;
-            font-weight: bold;
-        }
-    )");
+    feedbackOverlay = new FeedbackOverlay(this);
+    
 }
 
 void KanjiLearningWindow::createStudyInterface()
@@ -136,18 +128,18 @@ void KanjiLearningWindow::createStudyInterface()
     QString titleText = (currentMode == Mode::Learning) ? "Study Mode" : "Review Mode";
     titleLabel = new QLabel(titleText);
     titleLabel->setAlignment(Qt::AlignCenter);
-    titleLabel->setStyleSheet("font-size: 28px; font-weight: bold; color: #000000; background: white; padding: 25px; border-radius: 8px; border: 2px solid #007bff;");
+    titleLabel->setObjectName("modeTitle");
     layout->addWidget(titleLabel);
     
     // Progress
     progressLabel = new QLabel("Kanji 1 of 5");
     progressLabel->setAlignment(Qt::AlignCenter);
-    progressLabel->setStyleSheet("font-size: 18px; color: #000000; font-weight: bold; padding: 15px;");
+    progressLabel->setObjectName("progressCaption");
     layout->addWidget(progressLabel);
     
     // Main content area with much more space
     QWidget *contentWidget = new QWidget();
-    contentWidget->setStyleSheet("background: white; border-radius: 12px; padding: 80px; border: 2px solid #dee2e6;");
+    contentWidget->setObjectName("studyContent");
     
     QVBoxLayout *contentLayout = new QVBoxLayout(contentWidget);
     contentLayout->setSpacing(50);
@@ -155,19 +147,19 @@ void KanjiLearningWindow::createStudyInterface()
     // Much larger kanji with even more space
     kanjiCharLabel = new QLabel("一");
     kanjiCharLabel->setAlignment(Qt::AlignCenter);
-    kanjiCharLabel->setStyleSheet("font-size: 240px; font-weight: bold; color: #000000; min-height: 350px; padding: 20px 50px 50px 50px;");
+    kanjiCharLabel->setObjectName("studyKanji");
     contentLayout->addWidget(kanjiCharLabel);
     
     // Meaning with darker text
     meaningLabel = new QLabel("Meaning: one");
     meaningLabel->setAlignment(Qt::AlignCenter);
-    meaningLabel->setStyleSheet("font-size: 24px; font-weight: bold; color: #000000; background: #f8d7da; padding: 15px; border-radius: 6px; border: 2px solid #e74c3c;");
+    meaningLabel->setObjectName("meaningLabel");
     contentLayout->addWidget(meaningLabel);
     
     // Reading with darker text
     readingLabel = new QLabel("Reading: いち");
     readingLabel->setAlignment(Qt::AlignCenter);
-    readingLabel->setStyleSheet("font-size: 22px; font-weight: bold; color: #000000; background: #d1ecf1; padding: 15px; border-radius: 6px; border: 2px solid #3498db;");
+    readingLabel->setObjectName("readingLabel");
     contentLayout->addWidget(readingLabel);
     
     layout->addWidget(contentWidget);
@@ -177,18 +169,18 @@ void KanjiLearningWindow::createStudyInterface()
     buttonLayout->setSpacing(20);
     
     backToMainButton = new QPushButton("← Back");
-    backToMainButton->setStyleSheet("background-color: #6c757d; font-size: 16px;");
+    backToMainButton->setObjectName("backToMainButton");
     
     previousButton = new QPushButton("Previous");
-    previousButton->setStyleSheet("background-color: #ffc107; color: #000000; font-size: 16px;");
+    previousButton->setObjectName("previousButton");
     
     nextButton = new QPushButton("Next");
-    nextButton->setStyleSheet("background-color: #28a745; font-size: 16px;");
+    nextButton->setObjectName("nextButton");
     
     // Different button text for learning vs review
     QString startButtonText = (currentMode == Mode::Learning) ? "Start Quiz" : "Start Review";
     startQuizButton = new QPushButton(startButtonText);
-    startQuizButton->setStyleSheet("background-color: #dc3545; font-size: 18px; min-width: 150px;");
+    startQuizButton->setObjectName("startQuizButton");
     
     connect(backToMainButton, &QPushButton::clicked, this, &KanjiLearningWindow::onBackToMain);
     connect(previousButton, &QPushButton::clicked, this, &KanjiLearningWindow::onPreviousKanji);
@@ -220,63 +212,63 @@ void KanjiLearningWindow::createQuizInterface()
     QString quizTitleText = (currentMode == Mode::Learning) ? "Quiz Mode" : "Review Mode";
     quizTitleLabel = new QLabel(quizTitleText);
     quizTitleLabel->setAlignment(Qt::AlignCenter);
-    quizTitleLabel->setStyleSheet("font-size: 28px; font-weight: bold; color: #000000; background: white; padding: 25px; border-radius: 8px; border: 2px solid #007bff;");
+    quizTitleLabel->setObjectName("modeTitle");
     layout->addWidget(quizTitleLabel);
     
     quizProgressLabel = new QLabel("Question 1 of 10");
     quizProgressLabel->setAlignment(Qt::AlignCenter);
-    quizProgressLabel->setStyleSheet("font-size: 18px; color: #000000; font-weight: bold; padding: 15px;");
+    quizProgressLabel->setObjectName("progressCaption");
     layout->addWidget(quizProgressLabel);
     
     quizProgressBar = new QProgressBar();
     quizProgressBar->setRange(0, 10);
     quizProgressBar->setValue(1);
     quizProgressBar->setFixedHeight(25);
-    quizProgressBar->setStyleSheet("QProgressBar { border: 2px solid #007bff; border-radius: 6px; background: white; font-size: 14px; font-weight: bold; color: #000000; } QProgressBar::chunk { background-color: #28a745; border-radius: 4px; }");
+    quizProgressBar->setObjectName("quizProgressBar");
     layout->addWidget(quizProgressBar);
     
     // Main content area with horizontal layout
     QWidget *questionWidget = new QWidget();
-    questionWidget->setStyleSheet("background: white; border-radius: 12px; padding: 40px; border: 2px solid #dee2e6;");
+    questionWidget->setObjectName("quizContent");
     
     QHBoxLayout *questionLayout = new QHBoxLayout(questionWidget);
     questionLayout->setSpacing(60);
     
     // Left side - Kanji display (much bigger now!)
     QWidget *kanjiWidget = new QWidget();
-    kanjiWidget->setStyleSheet("background: #f8f9fa; border-radius: 8px; padding: 20px 40px 40px 40px; min-width: 500px;");
+    kanjiWidget->setObjectName("quizKanjiPanel");
     QVBoxLayout *kanjiLayout = new QVBoxLayout(kanjiWidget);
     kanjiLayout->setSpacing(20);
     
     quizKanjiLabel = new QLabel("一");
     quizKanjiLabel->setAlignment(Qt::AlignCenter);
-    quizKanjiLabel->setStyleSheet("font-size: 300px; font-weight: bold; color: #000000; min-height: 400px;");
+    quizKanjiLabel->setObjectName("quizKanji");
     kanjiLayout->addWidget(quizKanjiLabel);
     
     questionLayout->addWidget(kanjiWidget);
     
     // Right side - Question and input
     QWidget *inputWidget = new QWidget();
-    inputWidget->setStyleSheet("background: #f8f9fa; border-radius: 8px; padding: 40px; min-width: 400px;");
+    inputWidget->setObjectName("quizInputPanel");
     QVBoxLayout *inputLayout = new QVBoxLayout(inputWidget);
     inputLayout->setSpacing(40);
     
     quizQuestionLabel = new QLabel("What is the meaning of this kanji?");
     quizQuestionLabel->setAlignment(Qt::AlignCenter);
-    quizQuestionLabel->setStyleSheet("font-size: 24px; font-weight: bold; color: #000000; padding: 20px; background: white; border-radius: 8px;");
+    quizQuestionLabel->setObjectName("quizQuestionLabel");
     quizQuestionLabel->setWordWrap(true);
     inputLayout->addWidget(quizQuestionLabel);
     
     answerLineEdit = new QLineEdit();
     answerLineEdit->setPlaceholderText("Type your answer here...");
     answerLineEdit->setAlignment(Qt::AlignCenter);
-    answerLineEdit->setStyleSheet("min-height: 80px; font-size: 24px; font-weight: bold; background: white; border: 3px solid #007bff; border-radius: 8px; padding: 15px;");
+    answerLineEdit->setObjectName("answerLineEdit");
     inputLayout->addWidget(answerLineEdit);
     
     // Add some instruction text
     QLabel *instructionLabel = new QLabel("Press Enter to submit your answer");
     instructionLabel->setAlignment(Qt::AlignCenter);
-    instructionLabel->setStyleSheet("font-size: 16px; color: #6c757d; font-style: italic; padding: 10px;");
+    instructionLabel->setObjectName("instructionLabel");
     inputLayout->addWidget(instructionLabel);
     
     inputLayout->addStretch(); // Push everything to top
@@ -290,7 +282,7 @@ void KanjiLearningWindow::createQuizInterface()
     feedbackLabel->setVisible(false);  // Hide it, we'll use overlay
     
     retryButton = new QPushButton("Try Again");
-    retryButton->setStyleSheet("background-color: #dc3545; min-height: 50px; font-size: 18px;");
+    retryButton->setObjectName("retryButton");
     retryButton->setVisible(false);
     layout->addWidget(retryButton);
     
@@ -308,7 +300,7 @@ void KanjiLearningWindow::onAnswerTextChanged(const QString &text)
     }
     
     // Only convert for reading questions
-    if (currentQuizType != QuizType::Reading) {
+    if (quizSession.isFinished() || quizSession.currentType() != QuizSession::QuestionType::Reading) {
         return;
     }
     
@@ -333,10 +325,23 @@ void KanjiLearningWindow::onAnswerTextChanged(const QString &text)
     }
 }
 
-void KanjiLearningWindow::loadKanjiForLearning()
+void KanjiLearningWindow::loadKanjiForLearning(const QList<KanjiCard> *sessionKanji)
 {
-    studyKanji = database->getNewKanji(5);
+    studyKanji = sessionKanji ? *sessionKanji : database->getNewKanji(LearningBatchSize);
     currentKanjiIndex = 0;
+    
+    // The whole session is known up front; the quiz revisits the same cards larger
+    prefetchGlyphs(0, StudyGlyphSize);
+    prefetchGlyphs(0, QuizGlyphSize);
+}
+
+void KanjiLearningWindow::prefetchGlyphs(int fromIndex, int pixelSize)
+{
+    QStringList upcoming;
+    for (int i = fromIndex; i < studyKanji.size() && i < fromIndex + GlyphPrefetchCount; ++i) {
+        upcoming.append(studyKanji[i].kanji);
+    }
+    glyphCache.prefetch(upcoming, pixelSize, devicePixelRatioF());
 }
 
 void KanjiLearningWindow::displayCurrentKanji()
@@ -347,7 +352,8 @@ void KanjiLearningWindow::displayCurrentKanji()
     
     const KanjiCard &kanji = studyKanji[currentKanjiIndex];
     
-    kanjiCharLabel->setText(kanji.kanji);
+    kanjiCharLabel->setPixmap(glyphCache.pixmap(kanji.kanji, StudyGlyphSize, devicePixelRatioF()));
+    prefetchGlyphs(currentKanjiIndex + 1, StudyGlyphSize);
     meaningLabel->setText(QString("Meaning: %1").arg(kanji.meaning));
     
     QString reading = kanji.on_reading.isEmpty() ? kanji.kun_reading : kanji.on_reading;
@@ -378,12 +384,14 @@ void KanjiLearningWindow::onNextKanji()
 
 void KanjiLearningWindow::onStartQuiz()
 {
-    currentQuizIndex = 0;
-    quizResults.clear();
-    processedKanjiIds.clear(); // Clear tracking for review mode
-    for (int i = 0; i < studyKanji.size() * 2; ++i) {
-        quizResults.append(false);
-    }
+    beginQuiz();
+}
+
+void KanjiLearningWindow::beginQuiz()
+{
+    // A fresh session also rebuilds the answer matchers for the loaded cards
+    quizSession = QuizSession(studyKanji, currentMode == Mode::Learning ?
+                              QuizSession::Mode::Learning : QuizSession::Mode::Review);
     switchToQuizMode();
     startNextQuizQuestion();
 }
@@ -402,32 +410,29 @@ void KanjiLearningWindow::switchToQuizMode()
 
 void KanjiLearningWindow::startNextQuizQuestion()
 {
-    if (currentQuizIndex >= studyKanji.size() * 2) {
+    if (quizSession.isFinished()) {
         completeQuiz();
         return;
     }
     
-    int kanjiIndex = currentQuizIndex / 2;
-    currentQuizType = (currentQuizIndex % 2 == 0) ? QuizType::Meaning : QuizType::Reading;
-    
-    const KanjiCard &kanji = studyKanji[kanjiIndex];
+    const int kanjiIndex = quizSession.currentCardIndex();
+    const KanjiCard &kanji = quizSession.currentCard();
     
-    quizKanjiLabel->setText(kanji.kanji);
-    quizProgressLabel->setText(QString("Question %1 of %2").arg(currentQuizIndex + 1).arg(studyKanji.size() * 2));
-    quizProgressBar->setValue(currentQuizIndex + 1);
+    quizKanjiLabel->setPixmap(glyphCache.pixmap(kanji.kanji, QuizGlyphSize, devicePixelRatioF()));
+    prefetchGlyphs(kanjiIndex + 1, QuizGlyphSize);
+    quizProgressLabel->setText(QString("Question %1 of %2").arg(quizSession.questionIndex() + 1).arg(quizSession.questionCount()));
+    quizProgressBar->setValue(quizSession.questionIndex() + 1);
     
     feedbackLabel->clear();
     answerLineEdit->clear();
     answerLineEdit->setEnabled(true);
     retryButton->setVisible(false);
     
-    if (currentQuizType == QuizType::Meaning) {
+    if (quizSession.currentType() == QuizSession::QuestionType::Meaning) {
         quizQuestionLabel->setText("What is the meaning of this kanji?");
-        correctAnswer = kanji.meaning;
         answerLineEdit->setPlaceholderText("Type the meaning in English...");
     } else {
         quizQuestionLabel->setText("What is the reading of this kanji?");
-        correctAnswer = kanji.on_reading.isEmpty() ? kanji.kun_reading : kanji.on_reading;
         answerLineEdit->setPlaceholderText("Type the reading in hiragana...");
     }
     
@@ -438,7 +443,7 @@ void KanjiLearningWindow::onAnswerSubmitted()
 {
     QString userAnswer = answerLineEdit->text().trimmed();
     if (userAnswer.isEmpty()) {
-        showFeedbackOverlay("Warning: Please enter an answer", "#ffc107");
+        showFeedbackOverlay("Warning: Please enter an answer", FeedbackOverlay::Style::Warning);
         return;
     }
     checkQuizAnswer();
@@ -446,124 +451,61 @@ void KanjiLearningWindow::onAnswerSubmitted()
 
 void KanjiLearningWindow::checkQuizAnswer()
 {
-    QString userAnswer = answerLineEdit->text().trimmed().toLower();
-    bool isCorrect = false;
-    
-    if (currentQuizType == QuizType::Meaning) {
-        // Handle multiple meanings separated by "/"
-        QStringList possibleAnswers = correctAnswer.toLower().split("/");
-        for (const QString &answer : possibleAnswers) {
-            if (userAnswer == answer.trimmed()) {
-                isCorrect = true;
-                break;
-            }
-        }
-    } else {
-        const KanjiCard &kanji = studyKanji[currentQuizIndex / 2];
-        isCorrect = (userAnswer == kanji.on_reading || userAnswer == kanji.kun_reading);
-    }
+    LatencyMonitor::Scope checkTiming(latencyMonitor, LatencyMonitor::Stage::AnswerCheck);
+    
+    const QuizAnswerOutcome outcome = quizSession.submitAnswer(answerLineEdit->text());
     
-    if (isCorrect) {
-        // Ensure we don't go out of bounds
-        if (currentQuizIndex < quizResults.size()) {
-            quizResults[currentQuizIndex] = true;
+    if (outcome.result == QuizAnswerOutcome::Correct) {
+        if (outcome.match == AnswerMatcher::Match::Exact) {
+            showFeedbackOverlay("Correct!", FeedbackOverlay::Style::Success);
+        } else {
+            showFeedbackOverlay(QString("Correct!\nExpected: %1").arg(outcome.expected), FeedbackOverlay::Style::Success);
         }
         
-        showFeedbackOverlay("Correct!", "#28a745");
-        
-        // For review mode, check if both meaning and reading are now correct for this kanji
-        if (currentMode == Mode::Review) {
-            int kanjiIndex = currentQuizIndex / 2;
-            int meaningIndex = kanjiIndex * 2;     // Meaning question index
-            int readingIndex = kanjiIndex * 2 + 1; // Reading question index
-            
-            // Check if both questions for this kanji are answered correctly
-            if (meaningIndex < quizResults.size() && readingIndex < quizResults.size() &&
-                quizResults[meaningIndex] && quizResults[readingIndex]) {
-                
-                // Check if we haven't already processed this kanji
-                const KanjiCard &kanji = studyKanji[kanjiIndex];
-                
-                // Only process if we haven't already leveled up this kanji
-                if (!processedKanjiIds.contains(kanji.id)) {
-                    // Level up the kanji and update next review time
-                    qDebug() << "Both meaning and reading correct for kanji:" << kanji.kanji << "- Leveling up!";
-                    database->updateKanjiProgress(kanji.id, true, 1);
-                    
-                    // Mark this kanji as processed
-                    processedKanjiIds.insert(kanji.id);
-                }
-            }
-        }
+        // Review level-up once both meaning and reading of a card are right
+        applyProgress(outcome.progressUpdates);
         
         // Hide retry button and disable input temporarily, then automatically proceed
         retryButton->setVisible(false);
         answerLineEdit->setEnabled(false);
         
-        QTimer::singleShot(800, [this]() {
-            currentQuizIndex++;
+        QTimer::singleShot(800, this, [this]() {
+            quizSession.advance();
             startNextQuizQuestion();
         });
-    } else {
-        showFeedbackOverlay(QString("Incorrect\nCorrect answer: %1").arg(correctAnswer), "#dc3545");
+    } else if (outcome.result == QuizAnswerOutcome::Incorrect) {
+        showFeedbackOverlay(QString("Incorrect\nCorrect answer: %1").arg(outcome.expected), FeedbackOverlay::Style::Error);
         
         // For review mode, wrong answer lowers SRS level immediately
-        if (currentMode == Mode::Review) {
-            int kanjiIndex = currentQuizIndex / 2;
-            const KanjiCard &kanji = studyKanji[kanjiIndex];
-            qDebug() << "Wrong answer for kanji:" << kanji.kanji << "- Lowering level!";
-            database->updateKanjiProgress(kanji.id, false, 1);
-        }
+        applyProgress(outcome.progressUpdates);
         
         retryButton->setVisible(true);
         answerLineEdit->setEnabled(false);
     }
 }
 
-void KanjiLearningWindow::showFeedbackOverlay(const QString &message, const QString &color)
+void KanjiLearningWindow::applyProgress(const QList<QuizProgressUpdate> &updates)
 {
-    // Create overlay widget
-    QWidget *overlay = new QWidget(this);
-    overlay->setGeometry(0, 0, width(), height());
-    overlay->setStyleSheet("background-color: rgba(0, 0, 0, 0.5);");
-    
-    // Create message box in center
-    QLabel *messageLabel = new QLabel(message, overlay);
-    messageLabel->setAlignment(Qt::AlignCenter);
-    messageLabel->setWordWrap(true);
-    messageLabel->setStyleSheet(QString(
-        "background-color: white; "
-        "color: %1; "
-        "font-size: 32px; "
-        "font-weight: bold; "
-        "padding: 40px; "
-        "border-radius: 15px; "
-        "border: 4px solid %1; "
-        "min-width: 400px; "
-        "min-height: 200px;"
-    ).arg(color));
-    
-    // Center the message
-    int msgWidth = 500;
-    int msgHeight = 250;
-    messageLabel->setGeometry(
-        (width() - msgWidth) / 2,
-        (height() - msgHeight) / 2,
-        msgWidth,
-        msgHeight
-    );
-    
-    overlay->show();
-    overlay->raise();
-    
-    // Auto-hide after 1 second (reduced from 2 seconds)
-    QTimer::singleShot(1000, [overlay]() {
-        overlay->deleteLater();
-    });
+    if (updates.isEmpty()) {
+        return;
+    }
+    
+    LatencyMonitor::Scope writeTiming(latencyMonitor, LatencyMonitor::Stage::DatabaseWrite);
+    for (const QuizProgressUpdate &update : updates) {
+        database->updateKanjiProgress(update.cardId, update.correct, 1);
+    }
+}
+
+void KanjiLearningWindow::showFeedbackOverlay(const QString &message, FeedbackOverlay::Style style)
+{
+    // One overlay per window, restyled and faded instead of rebuilt per answer
+    feedbackOverlay->showMessage(message, style);
 }
 
 void KanjiLearningWindow::onRetryQuestion()
 {
+    quizSession.retry();
+    
     // Hide the retry button
     retryButton->setVisible(false);
     
@@ -575,62 +517,52 @@ void KanjiLearningWindow::onRetryQuestion()
 
 void KanjiLearningWindow::completeQuiz()
 {
-    bool allCorrect = true;
-    for (bool result : quizResults) {
-        if (!result) {
-            allCorrect = false;
-            break;
-        }
-    }
+    const QuizCompletion &completion = quizSession.completion();
     
-    if (allCorrect) {
+    if (completion.allCorrect) {
+        // Learning sessions mark every card learned here; reviews were updated per answer
+        applyProgress(completion.progressUpdates);
+        
         if (currentMode == Mode::Learning) {
-            markKanjiAsLearned();
-            showFeedbackOverlay(QString("Congratulations!\nYou learned %1 kanji!").arg(studyKanji.size()), "#28a745");
+            showFeedbackOverlay(QString("Congratulations!\nYou learned %1 kanji!").arg(studyKanji.size()), FeedbackOverlay::Style::Success);
         } else {
-            // For review mode, progress is already updated per-answer, just show completion message
-            showFeedbackOverlay(QString("Review Complete!\nYou reviewed %1 kanji!").arg(studyKanji.size()), "#28a745");
+            showFeedbackOverlay(QString("Review Complete!\nYou reviewed %1 kanji!").arg(studyKanji.size()), FeedbackOverlay::Style::Success);
         }
         
-        QTimer::singleShot(3000, [this]() {
+        QTimer::singleShot(3000, this, [this]() {
             close();
         });
     } else {
         QString message = (currentMode == Mode::Learning) ? 
                          "Some answers were incorrect.\nReview the kanji and try again!" :
                          "Some answers were incorrect.\nReview these kanji again!";
-        showFeedbackOverlay(message, "#ffc107");
+        showFeedbackOverlay(message, FeedbackOverlay::Style::Warning);
         
-        QTimer::singleShot(3000, [this]() {
+        QTimer::singleShot(3000, this, [this]() {
             switchToStudyMode();
         });
     }
 }
 
-void KanjiLearningWindow::markKanjiAsLearned()
-{
-    for (const KanjiCard &kanji : studyKanji) {
-        database->updateKanjiProgress(kanji.id, true, 1);
-    }
-}
-
 void KanjiLearningWindow::onBackToMain()
 {
     close();
 }
 
-void KanjiLearningWindow::loadKanjiForReview()
+void KanjiLearningWindow::loadKanjiForReview(const QList<KanjiCard> *sessionKanji)
 {
-    studyKanji = database->getReviewKanji();
+    studyKanji = sessionKanji ? *sessionKanji : database->getReviewKanji();
     currentKanjiIndex = 0;
+    prefetchGlyphs(0, QuizGlyphSize);
 }
 
-void KanjiLearningWindow::updateKanjiReviewProgress()
+void KanjiLearningWindow::closeEvent(QCloseEvent *event)
 {
-    for (const KanjiCard &kanji : studyKanji) {
-        // For reviews, we call updateKanjiProgress which handles SRS level increment
-        database->updateKanjiProgress(kanji.id, true, 1);
+    // Commit the session's journaled answers now rather than on the next timer
+    if (!database->flushProgress()) {
+        qDebug() << "Failed to save progress:" << database->getLastError();
     }
+    QMainWindow::closeEvent(event);
 }
 
 void KanjiLearningWindow::keyPressEvent(QKeyEvent *event)
@@ -640,5 +572,9 @@ void KanjiLearningWindow::keyPressEvent(QKeyEvent *event)
         close();
         return;
     }
+    if (event->key() == Qt::Key_F12 && latencyHud) {
+        latencyHud->toggle();
+        return;
+    }
     QMainWindow::keyPressEvent(event);
 } 
\ No newline at end of file
@@ -15,6 +15,12 @@
 #include <stdexcept>
 #include <exception>
 #include <kanji_database.h>
+#include <quiz_session.h>
+#include "feedback_overlay.h"
+#include "glyph_cache.h"
+#include "latency_monitor.h"
+
+class LatencyHud;
 
 class KanjiLearningWindow : public QMainWindow
 {
@@ -26,8 +32,16 @@ public:
         Review
     };
     
+    // Session size for learning mode, also used by SessionPrefetcher
+    static constexpr int LearningBatchSize = 5;
+    
     explicit KanjiLearningWindow(KanjiDatabase *db, Mode mode = Mode::Learning, QWidget *parent = nullptr);
+    // Starts with cards loaded ahead of time instead of querying the database
+    KanjiLearningWindow(KanjiDatabase *db, Mode mode, const QList<KanjiCard> &sessionKanji, QWidget *parent = nullptr);
     ~KanjiLearningWindow();
+    
+    // Time the answer path into monitor; F12 toggles its HUD
+    void attachLatencyMonitor(LatencyMonitor *monitor);
 
 private slots:
     void onBackToMain();
@@ -40,22 +54,26 @@ private slots:
 
 protected:
     void keyPressEvent(QKeyEvent *event) override;
+    void closeEvent(QCloseEvent *event) override;
 
 private:
+    KanjiLearningWindow(KanjiDatabase *db, Mode mode, const QList<KanjiCard> *sessionKanji, QWidget *parent);
+    
     void setupUI();
     void createStudyInterface();
     void createQuizInterface();
-    void loadKanjiForLearning();
-    void loadKanjiForReview();
+    void loadKanjiForLearning(const QList<KanjiCard> *sessionKanji);
+    void loadKanjiForReview(const QList<KanjiCard> *sessionKanji);
+    void prefetchGlyphs(int fromIndex, int pixelSize);
     void displayCurrentKanji();
     void switchToStudyMode();
     void switchToQuizMode();
+    void beginQuiz();
     void startNextQuizQuestion();
     void checkQuizAnswer();
     void completeQuiz();
-    void markKanjiAsLearned();
-    void updateKanjiReviewProgress();
-    void showFeedbackOverlay(const QString &message, const QString &color);
+    void applyProgress(const QList<QuizProgressUpdate> &updates);
+    void showFeedbackOverlay(const QString &message, FeedbackOverlay::Style style);
 
     // Database and mode
     KanjiDatabase *database;
@@ -63,6 +81,12 @@ private:
     QList<KanjiCard> studyKanji;
     int currentKanjiIndex;
 
+    // Pre-rendered large kanji for the study and quiz cards
+    static constexpr int StudyGlyphSize = 240;
+    static constexpr int QuizGlyphSize = 300;
+    static constexpr int GlyphPrefetchCount = 4;
+    GlyphCache glyphCache;
+
     // Main layout
     QWidget *centralWidget;
     QVBoxLayout *mainLayout;
@@ -89,23 +113,17 @@ private:
     QLineEdit *answerLineEdit;
     QPushButton *retryButton;
     QLabel *feedbackLabel;
+    FeedbackOverlay *feedbackOverlay;
 
-    // Quiz state
-    int currentQuizIndex;
-    QString correctAnswer;
-    QList<bool> quizResults;
-    QSet<int> processedKanjiIds; // Track kanji that have been leveled up in review mode
-    bool questionAnsweredCorrectly;
-    int retryCount;
+    // Quiz state lives in the session; the window only shows it
+    QuizSession quizSession;
 
     // Conversion state
     bool isConverting = false;
 
-    enum class QuizType {
-        Meaning,
-        Reading
-    };
-    QuizType currentQuizType;
+    // Instrumentation, owned by the main window
+    LatencyMonitor *latencyMonitor = nullptr;
+    LatencyHud *latencyHud = nullptr;
 };
 
 #endif // KANJI_LEARNING_WINDOW_H 
\ No newline at end of file
@@ -1,5 +1,6 @@
 #include <QtWidgets/QApplication>
 #include "kanji_main_window.h"
+#include "kanji_theme.h"
 
 int main(int argc, char *argv[])
 {
@@ -10,6 +11,9 @@ int main(int argc, char *argv[])
     app.setApplicationVersion("1.0");
     app.setOrganizationName("Japanese Learning Tools");
     
+    // One stylesheet for every window, parsed once
+    KanjiTheme::apply(app);
+    
     KanjiMainWindow window;
     window.show();
     
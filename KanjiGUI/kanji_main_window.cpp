@@ -1,39 +1,181 @@
 #include "kanji_main_window.h"
 #include "kanji_learning_window.h"
+#include "kanji_browser_window.h"
+#include "kanji_forecast_window.h"
+#include "kanji_forecast.h"
+#include "kanji_analytics.h"
+#include "kanji_frequency_builder.h"
+#include "kanji_theme.h"
+#include "startup_timer.h"
+#include "session_prefetcher.h"
+#include "latency_monitor.h"
+#include "progress_sync.h"
+#include "database_backup.h"
 #include <QtWidgets/QApplication>
 #include <QtWidgets/QMessageBox>
 #include <QtWidgets/QMenuBar>
 #include <QtWidgets/QStatusBar>
+#include <QtWidgets/QFileDialog>
+#include <QtWidgets/QInputDialog>
+#include <QFileInfo>
+#include <QElapsedTimer>
+#include <QThread>
 #include <QProcess>
 #include <QTimer>
+#include <QSignalBlocker>
 #include <QDebug>
 
-KanjiMainWindow::KanjiMainWindow(QWidget *parent)
-    : QMainWindow(parent), database(new KanjiDatabase()), learningWindow(nullptr)
+// "10 sec", "5 min", "1 hour": the largest whole unit
+static QString formatDuration(qint64 seconds)
 {
-    // Initialize database
-    if (!database->initialize()) {
-        QMessageBox::critical(this, "Database Error", 
-                            "Failed to initialize database: " + database->getLastError());
-        return;
+    if (seconds < 60) {
+        return QString("%1 sec").arg(seconds);
     }
-    
+    if (seconds < 3600) {
+        return QString("%1 min").arg(seconds / 60);
+    }
+    if (seconds < 86400) {
+        return QString("%1 hour%2").arg(seconds / 3600).arg(seconds < 7200 ? "" : "s");
+    }
+    return QString("%1 day%2").arg(seconds / 86400).arg(seconds < 172800 ? "" : "s");
+}
+
+KanjiMainWindow::KanjiMainWindow(QWidget *parent)
+    : QMainWindow(parent), totalCount(0), learnedCount(0), newCount(0), reviewDueCount(0),
+      database(new KanjiDatabase()), databaseReady(false), startupThread(nullptr), prefetcher(nullptr),
+      databaseBackup(nullptr), forecast(nullptr), analytics(nullptr),
+      latencyMonitor(new LatencyMonitor(this)), dueTimer(nullptr),
+      learningWindow(nullptr)
+{
+    // Show the window right away with placeholder statistics; the database is
+    // opened, migrated and counted off the GUI thread
     setupUI();
-    refreshStatistics();
     
-    // Set up timer to refresh statistics every 5 seconds
-    refreshTimer = new QTimer(this);
-    connect(refreshTimer, &QTimer::timeout, this, &KanjiMainWindow::refreshStatistics);
-    refreshTimer->start(5000); // 5 seconds
+    // Only time can make a review due without a database write, so a single-shot
+    // timer aimed at the next review replaces periodic polling
+    dueTimer = new QTimer(this);
+    dueTimer->setSingleShot(true);
+    connect(dueTimer, &QTimer::timeout, this, &KanjiMainWindow::onReviewsBecameDue);
+    
+    startDatabaseInitialization();
+}
+
+void KanjiMainWindow::startDatabaseInitialization()
+{
+    statusBar()->showMessage("Opening kanji database...");
+    
+    startupThread = QThread::create([this]() {
+        // Schema setup, seeding and first counts on a private connection;
+        // the GUI thread opens its own once the schema is in place
+        KanjiDatabase startupDatabase("KanjiStartup");
+        bool ok = startupDatabase.initialize();
+        QString error = startupDatabase.getLastError();
+        int total = 0;
+        int learned = 0;
+        int fresh = 0;
+        int due = 0;
+        QDateTime nextReview;
+        if (ok) {
+            total = startupDatabase.getTotalKanjiCount();
+            learned = startupDatabase.getLearnedKanjiCount();
+            fresh = startupDatabase.getNewKanjiCount();
+            due = startupDatabase.getReviewDueCount();
+            nextReview = startupDatabase.getNextReviewTime();
+        }
+        
+        QMetaObject::invokeMethod(this, [=]() {
+            if (!ok || !database->open()) {
+                statusBar()->showMessage("Database unavailable");
+                QMessageBox::critical(this, "Database Error",
+                                    "Failed to initialize database: " + (ok ? database->getLastError() : error));
+                return;
+            }
+            
+            // Answers are journaled and committed in batches off the answer path
+            if (!database->enableWriteBehind()) {
+                qDebug() << "Write-behind unavailable, answers commit directly:" << database->getLastError();
+            }
+            
+            totalCount = total;
+            learnedCount = learned;
+            newCount = fresh;
+            reviewDueCount = due;
+            databaseReady = true;
+            
+            // Everything after this arrives as coalesced counter deltas from the database
+            connect(database->notifier(), &KanjiChangeNotifier::changed, this, &KanjiMainWindow::applyChange);
+            
+            for (QAction *action : databaseActions) {
+                action->setEnabled(true);
+            }
+            statisticsButton->setEnabled(true);
+            populateDeckSelector();
+            updateStatisticsDisplay();
+            scheduleDueTimer(nextReview);
+            
+            StartupTimer::markInteractive();
+            
+            // Load the first session's cards while the user looks at the statistics
+            prefetcher = new SessionPrefetcher(database, KanjiLearningWindow::LearningBatchSize, this);
+            prefetcher->prefetch();
+            
+            // Built on first view from one indexed read, then follows the change deltas
+            forecast = new KanjiForecast(database, KanjiForecast::DefaultHorizonDays, this);
+            analytics = new KanjiAnalytics(database, 0, this);
+            analytics->preload(); // Review history read in the background before the statistics dialog
+            
+            databaseBackup = new DatabaseBackup(database, this);
+            connect(databaseBackup, &DatabaseBackup::progress, this, [this](int copied, int total) {
+                if (total > 0) {
+                    statusBar()->showMessage(QString("Backing up database... %1%").arg(copied * 100 / total));
+                }
+            });
+            connect(databaseBackup, &DatabaseBackup::finished, this, &KanjiMainWindow::onBackupFinished);
+            
+            // One snapshot a day, taken in the background at startup
+            QFileInfoList snapshots = DatabaseBackup::snapshots(database->getBackupDirectory());
+            if (snapshots.isEmpty() ||
+                snapshots.first().lastModified().secsTo(QDateTime::currentDateTime()) > 24 * 60 * 60) {
+                databaseBackup->snapshot();
+            }
+        }, Qt::QueuedConnection);
+    });
+    startupThread->start();
+}
+
+void KanjiMainWindow::paintEvent(QPaintEvent *event)
+{
+    QMainWindow::paintEvent(event);
+    StartupTimer::markFirstPaint();
 }
 
 KanjiMainWindow::~KanjiMainWindow()
 {
-    delete database;
+    // Closed during startup: let initialize() finish rather than outlive main();
+    // its queued completion is dropped along with this window
+    startupThread->wait();
+    delete startupThread;
+    if (analyzeThread) {
+        analyzeThread->wait();
+        delete analyzeThread;
+    }
+    if (frequencyThread) {
+        frequencyThread->wait();
+        delete frequencyThread;
+    }
+    
+    // Closing flushes the session's answers, so it goes while the database is alive
     if (learningWindow) {
         learningWindow->close();
         delete learningWindow;
     }
+    delete prefetcher; // Waits for a running fetch before the database goes away
+    delete databaseBackup; // Cancels a running backup the same way
+    delete browserWindow;
+    delete forecastWindow;
+    delete forecast;
+    delete analytics;
+    delete database;
 }
 
 void KanjiMainWindow::setupUI()
@@ -52,46 +194,8 @@ void KanjiMainWindow::setupUI()
     setMinimumSize(800, 600);
     resize(1000, 700);
     
-    // Apply modern styling
-    setStyleSheet(R"(
-        QMainWindow {
-            background-color: #f8f9fa;
-        }
-        QPushButton {
-            background-color: #007bff;
-            color: white;
-            border: none;
-            border-radius: 8px;
-            padding: 15px 25px;
-            font-size: 14px;
-            font-weight: bold;
-            min-height: 20px;
-        }
-        QPushButton:hover {
-            background-color: #0056b3;
-        }
-        QPushButton:pressed {
-            background-color: #004085;
-        }
-        QFrame {
-            background-color: white;
-            border: 1px solid #dee2e6;
-            border-radius: 10px;
-            padding: 20px;
-        }
-        QLabel {
-            color: #333333;
-        }
-        QProgressBar {
-            border: 2px solid #dee2e6;
-            border-radius: 5px;
-            text-align: center;
-        }
-        QProgressBar::chunk {
-            background-color: #28a745;
-            border-radius: 3px;
-        }
-    )");
+    // Styling comes from the application stylesheet (KanjiTheme), scoped by this name
+    setObjectName("KanjiMainWindow");
 }
 
 void KanjiMainWindow::createMenuBar()
@@ -101,6 +205,35 @@ void KanjiMainWindow::createMenuBar()
     // File menu
     QMenu *fileMenu = menuBar->addMenu("&File");
     
+    QAction *analyzeFileAction = fileMenu->addAction("&Analyze Text File...");
+    connect(analyzeFileAction, &QAction::triggered, this, &KanjiMainWindow::onAnalyzeTextFile);
+    
+    QAction *analyzeTextAction = fileMenu->addAction("Analyze &Pasted Text...");
+    connect(analyzeTextAction, &QAction::triggered, this, &KanjiMainWindow::onAnalyzePastedText);
+    
+    QAction *frequencyAction = fileMenu->addAction("Order New Kanji by &Text Frequency...");
+    connect(frequencyAction, &QAction::triggered, this, &KanjiMainWindow::onBuildFrequencyOrder);
+    
+    QAction *importAction = fileMenu->addAction("&Import Kanji List...");
+    connect(importAction, &QAction::triggered, this, &KanjiMainWindow::onImportKanji);
+    
+    QAction *exportCardsAction = fileMenu->addAction("&Export Cards and Progress...");
+    connect(exportCardsAction, &QAction::triggered, this, &KanjiMainWindow::onExportCards);
+    
+    QAction *importCardsAction = fileMenu->addAction("Import &Cards and Progress...");
+    connect(importCardsAction, &QAction::triggered, this, &KanjiMainWindow::onImportCards);
+    
+    QAction *syncAction = fileMenu->addAction("S&ync Progress with Folder...");
+    connect(syncAction, &QAction::triggered, this, &KanjiMainWindow::onSyncProgress);
+    
+    fileMenu->addSeparator();
+    
+    QAction *backupAction = fileMenu->addAction("&Back Up Database...");
+    connect(backupAction, &QAction::triggered, this, &KanjiMainWindow::onBackupDatabase);
+    
+    QAction *snapshotAction = fileMenu->addAction("Take Database &Snapshot");
+    connect(snapshotAction, &QAction::triggered, this, &KanjiMainWindow::onTakeSnapshot);
+    
     fileMenu->addSeparator();
     
     QAction *exitAction = fileMenu->addAction("E&xit");
@@ -121,9 +254,21 @@ void KanjiMainWindow::createMenuBar()
     QAction *statsAction = viewMenu->addAction("&Statistics");
     connect(statsAction, &QAction::triggered, this, &KanjiMainWindow::onViewStatistics);
     
+    QAction *browseAction = viewMenu->addAction("&Browse Kanji...");
+    browseAction->setShortcut(QKeySequence("Ctrl+B"));
+    connect(browseAction, &QAction::triggered, this, &KanjiMainWindow::onBrowseKanji);
+    
+    QAction *forecastAction = viewMenu->addAction("Review &Forecast...");
+    connect(forecastAction, &QAction::triggered, this, &KanjiMainWindow::onViewForecast);
+    
     QAction *refreshAction = viewMenu->addAction("&Refresh");
     connect(refreshAction, &QAction::triggered, this, &KanjiMainWindow::refreshStatistics);
     
+    viewMenu->addSeparator();
+    
+    QAction *latencyAction = viewMenu->addAction("Export &Latency Histograms...");
+    connect(latencyAction, &QAction::triggered, this, &KanjiMainWindow::onExportLatency);
+    
     // Test menu for debugging
     QMenu *testMenu = menuBar->addMenu("&Test");
     
@@ -148,7 +293,6 @@ void KanjiMainWindow::createMenuBar()
         database->debugShowAllLearnedKanji();
         int reviewCount = database->getReviewDueCount();
         
-        refreshStatistics();
         QMessageBox::information(this, "Test", QString("Added %1 kanji to review queue!\nReview count: %2").arg(count).arg(reviewCount));
     });
     
@@ -160,7 +304,6 @@ void KanjiMainWindow::createMenuBar()
             
         if (reply == QMessageBox::Yes) {
             database->resetAllKanjiToUnlearned();
-            refreshStatistics();
             QMessageBox::information(this, "Reset Complete", "All kanji have been reset to unlearned state.");
         }
     });
@@ -197,10 +340,18 @@ void KanjiMainWindow::createMenuBar()
         // Check review count
         int reviewCount = database->getReviewDueCount();
         
-        refreshStatistics();
         QMessageBox::information(this, "Test Complete", 
             QString("Learned %1 kanji.\nReview count: %2\nCheck console for details.").arg(count).arg(reviewCount));
     });
+    
+    // Everything except Exit needs the database, which opens in the background
+    databaseActions = {analyzeFileAction, analyzeTextAction, frequencyAction, importAction, exportCardsAction,
+                       importCardsAction, syncAction, backupAction,
+                       snapshotAction, learnAction, reviewAction, statsAction, browseAction, forecastAction, refreshAction,
+                       testMenu->menuAction()};
+    for (QAction *action : databaseActions) {
+        action->setEnabled(false);
+    }
 }
 
 void KanjiMainWindow::createMainContent()
@@ -213,37 +364,42 @@ void KanjiMainWindow::createMainContent()
     
     // Welcome section
     welcomeLabel = new QLabel("Welcome to Kanji Learning System", this);
-    welcomeLabel->setFont(QFont("Arial", 24, QFont::Bold));
+    welcomeLabel->setObjectName("welcomeLabel");
+    welcomeLabel->setFont(KanjiTheme::font(KanjiTheme::Font::Welcome));
     welcomeLabel->setAlignment(Qt::AlignCenter);
-    welcomeLabel->setStyleSheet("color: #2c3e50; margin-bottom: 10px;");
     
     infoLabel = new QLabel("Choose an option below to start your Japanese learning journey!", this);
-    infoLabel->setFont(QFont("Arial", 12));
+    infoLabel->setObjectName("infoLabel");
+    infoLabel->setFont(KanjiTheme::font(KanjiTheme::Font::Info));
     infoLabel->setAlignment(Qt::AlignCenter);
-    infoLabel->setStyleSheet("color: #6c757d; margin-bottom: 30px;");
     
     leftLayout->addWidget(welcomeLabel);
     leftLayout->addWidget(infoLabel);
     
     // Main action buttons
     learnNewButton = new QPushButton("Learn New Kanji", this);
-    learnNewButton->setFont(QFont("Arial", 16, QFont::Bold));
+    learnNewButton->setObjectName("learnNewButton");
+    learnNewButton->setFont(KanjiTheme::font(KanjiTheme::Font::PrimaryButton));
     learnNewButton->setMinimumHeight(60);
-    learnNewButton->setStyleSheet("QPushButton { background-color: #28a745; } QPushButton:hover { background-color: #1e7e34; }");
     connect(learnNewButton, &QPushButton::clicked, this, &KanjiMainWindow::onLearnNewKanji);
     
     reviewButton = new QPushButton("Review Kanji", this);
-    reviewButton->setFont(QFont("Arial", 16, QFont::Bold));
+    reviewButton->setObjectName("reviewButton");
+    reviewButton->setFont(KanjiTheme::font(KanjiTheme::Font::PrimaryButton));
     reviewButton->setMinimumHeight(60);
-    reviewButton->setStyleSheet("QPushButton { background-color: #ffc107; color: #212529; } QPushButton:hover { background-color: #e0a800; }");
     connect(reviewButton, &QPushButton::clicked, this, &KanjiMainWindow::onReviewKanji);
     
     statisticsButton = new QPushButton("View Statistics", this);
-    statisticsButton->setFont(QFont("Arial", 14));
+    statisticsButton->setObjectName("statisticsButton");
+    statisticsButton->setFont(KanjiTheme::font(KanjiTheme::Font::SecondaryButton));
     statisticsButton->setMinimumHeight(50);
-    statisticsButton->setStyleSheet("QPushButton { background-color: #6f42c1; } QPushButton:hover { background-color: #5a32a3; }");
     connect(statisticsButton, &QPushButton::clicked, this, &KanjiMainWindow::onViewStatistics);
     
+    // Placeholders until the database has been opened
+    learnNewButton->setEnabled(false);
+    reviewButton->setEnabled(false);
+    statisticsButton->setEnabled(false);
+    
     leftLayout->addWidget(learnNewButton);
     leftLayout->addSpacing(15);
     leftLayout->addWidget(reviewButton);
@@ -270,27 +426,32 @@ void KanjiMainWindow::createStatisticsPanel()
     QVBoxLayout *statsLayout = new QVBoxLayout(statsFrame);
     
     QLabel *statsTitle = new QLabel("Your Progress", statsFrame);
-    statsTitle->setFont(QFont("Arial", 16, QFont::Bold));
+    statsTitle->setObjectName("statsTitle");
+    statsTitle->setFont(KanjiTheme::font(KanjiTheme::Font::PanelTitle));
     statsTitle->setAlignment(Qt::AlignCenter);
-    statsTitle->setStyleSheet("color: #495057; margin-bottom: 20px;");
+    
+    deckComboBox = new QComboBox(statsFrame);
+    deckComboBox->setObjectName("deckComboBox");
+    deckComboBox->addItem("All Decks", 0);
+    deckComboBox->setEnabled(false);
     
     totalKanjiLabel = new QLabel("Total Kanji: Loading...", statsFrame);
-    totalKanjiLabel->setFont(QFont("Arial", 12));
+    totalKanjiLabel->setFont(KanjiTheme::font(KanjiTheme::Font::Statistic));
     
     learnedKanjiLabel = new QLabel("Learned: Loading...", statsFrame);
-    learnedKanjiLabel->setFont(QFont("Arial", 12));
-    learnedKanjiLabel->setStyleSheet("color: #28a745;");
+    learnedKanjiLabel->setObjectName("learnedKanjiLabel");
+    learnedKanjiLabel->setFont(KanjiTheme::font(KanjiTheme::Font::Statistic));
     
     newKanjiLabel = new QLabel("New: Loading...", statsFrame);
-    newKanjiLabel->setFont(QFont("Arial", 12));
-    newKanjiLabel->setStyleSheet("color: #007bff;");
+    newKanjiLabel->setObjectName("newKanjiLabel");
+    newKanjiLabel->setFont(KanjiTheme::font(KanjiTheme::Font::Statistic));
     
     reviewDueLabel = new QLabel("Due for Review: Loading...", statsFrame);
-    reviewDueLabel->setFont(QFont("Arial", 12));
-    reviewDueLabel->setStyleSheet("color: #ffc107;");
+    reviewDueLabel->setObjectName("reviewDueLabel");
+    reviewDueLabel->setFont(KanjiTheme::font(KanjiTheme::Font::Statistic));
     
     progressLabel = new QLabel("Progress: 0%", statsFrame);
-    progressLabel->setFont(QFont("Arial", 12, QFont::Bold));
+    progressLabel->setFont(KanjiTheme::font(KanjiTheme::Font::StatisticEmphasis));
     progressLabel->setAlignment(Qt::AlignCenter);
     
     progressBar = new QProgressBar(statsFrame);
@@ -299,6 +460,7 @@ void KanjiMainWindow::createStatisticsPanel()
     progressBar->setTextVisible(true);
     
     statsLayout->addWidget(statsTitle);
+    statsLayout->addWidget(deckComboBox);
     statsLayout->addSpacing(10);
     statsLayout->addWidget(totalKanjiLabel);
     statsLayout->addWidget(learnedKanjiLabel);
@@ -313,40 +475,133 @@ void KanjiMainWindow::createStatisticsPanel()
 void KanjiMainWindow::refreshStatistics()
 {
     // Safety check to prevent crashes
-    if (!database) {
+    if (!database || !databaseReady) {
         qDebug() << "Database not available for statistics refresh";
         return;
     }
     
-    int total = database->getTotalKanjiCount();
-    int learned = database->getLearnedKanjiCount();
-    int newKanji = database->getNewKanjiCount();
-    int reviewDue = database->getReviewDueCount();
+    totalCount = database->getTotalKanjiCount();
+    learnedCount = database->getLearnedKanjiCount();
+    newCount = database->getNewKanjiCount();
+    reviewDueCount = database->getReviewDueCount();
+    
+    // The counts just read already include any deltas still waiting to be emitted
+    database->notifier()->discardPending();
+    
+    updateStatisticsDisplay();
+    scheduleDueTimer(database->getNextReviewTime());
+}
+
+void KanjiMainWindow::populateDeckSelector()
+{
+    // Counts come from the decks table, not from scanning cards
+    QSignalBlocker blocker(deckComboBox);
+    const int selected = deckComboBox->currentData().toInt();
+    deckComboBox->clear();
+    deckComboBox->addItem("All Decks", 0);
+    
+    // Only N5 and an N4 starter set are seeded; the other levels stay hidden
+    // until an imported kanji list gives them cards
+    QStringList emptyDecks;
+    for (const KanjiDeck &deck : database->getDecks()) {
+        if (deck.card_count == 0) {
+            emptyDecks.append(deck.name);
+            continue;
+        }
+        deckComboBox->addItem(QString("%1 (%2)").arg(deck.name).arg(deck.card_count), deck.id);
+    }
+    deckComboBox->setToolTip(emptyDecks.isEmpty() ? QString()
+        : QString("%1 have no cards yet - use File > Import Kanji List to add them").arg(emptyDecks.join(", ")));
+    deckComboBox->setCurrentIndex(qMax(0, deckComboBox->findData(selected)));
+    
+    if (!deckComboBox->isEnabled()) {
+        deckComboBox->setEnabled(true);
+        connect(deckComboBox, &QComboBox::currentIndexChanged, this, &KanjiMainWindow::onDeckChanged);
+    }
+}
+
+void KanjiMainWindow::onDeckChanged(int index)
+{
+    // The database posts ScopeChanged, which reloads the counters in applyChange
+    database->setActiveDeck(deckComboBox->itemData(index).toInt());
+}
+
+void KanjiMainWindow::applyChange(const KanjiChangeSet &change)
+{
+    if (change.kinds & KanjiChangeSet::ScopeChanged) {
+        // Deltas merged in with the switch belong to the old deck; the per-deck
+        // counters make re-reading everything cheap
+        dueTimer->stop();
+        refreshStatistics();
+        return;
+    }
+    
+    totalCount += change.totalDelta;
+    learnedCount += change.learnedDelta;
+    newCount += change.newDelta;
+    reviewDueCount = qMax(0, reviewDueCount + change.reviewDueDelta);
     
-    totalKanjiLabel->setText(QString("Total Kanji: %1").arg(total));
-    learnedKanjiLabel->setText(QString("Learned: %1").arg(learned));
-    newKanjiLabel->setText(QString("New: %1").arg(newKanji));
-    reviewDueLabel->setText(QString("Due for Review: %1").arg(reviewDue));
+    if (change.kinds & KanjiChangeSet::CardsReset) {
+        dueTimer->stop();
+    }
+    scheduleDueTimer(change.earliestNextReview);
     
-    int progressPercent = total > 0 ? (learned * 100) / total : 0;
+    updateStatisticsDisplay();
+}
+
+void KanjiMainWindow::scheduleDueTimer(const QDateTime &when)
+{
+    if (!when.isValid()) {
+        return;
+    }
+    
+    // QTimer intervals are int milliseconds; far-off reviews just re-arm on timeout
+    qint64 delay = qBound<qint64>(0, QDateTime::currentDateTime().msecsTo(when), 24 * 60 * 60 * 1000);
+    if (dueTimer->isActive() && dueTimer->remainingTime() <= delay) {
+        return;
+    }
+    dueTimer->start(int(delay));
+}
+
+void KanjiMainWindow::onReviewsBecameDue()
+{
+    // The due count depends on the clock, so re-read just that one
+    reviewDueCount = database->getReviewDueCount();
+    updateStatisticsDisplay();
+    scheduleDueTimer(database->getNextReviewTime());
+    
+    // The prefetched review queue no longer holds every due card
+    if (prefetcher) {
+        prefetcher->prefetch();
+    }
+}
+
+void KanjiMainWindow::updateStatisticsDisplay()
+{
+    totalKanjiLabel->setText(QString("Total Kanji: %1").arg(totalCount));
+    learnedKanjiLabel->setText(QString("Learned: %1").arg(learnedCount));
+    newKanjiLabel->setText(QString("New: %1").arg(newCount));
+    reviewDueLabel->setText(QString("Due for Review: %1").arg(reviewDueCount));
+    
+    int progressPercent = totalCount > 0 ? (learnedCount * 100) / totalCount : 0;
     progressLabel->setText(QString("Progress: %1%").arg(progressPercent));
     progressBar->setValue(progressPercent);
     
     // Update button text with counts
-    learnNewButton->setText(QString("Learn New Kanji (%1)").arg(newKanji));
-    reviewButton->setText(QString("Review Kanji (%1)").arg(reviewDue));
+    learnNewButton->setText(QString("Learn New Kanji (%1)").arg(newCount));
+    reviewButton->setText(QString("Review Kanji (%1)").arg(reviewDueCount));
     
     // Enable/disable buttons based on availability
-    learnNewButton->setEnabled(newKanji > 0);
-    reviewButton->setEnabled(reviewDue > 0);
+    learnNewButton->setEnabled(newCount > 0);
+    reviewButton->setEnabled(reviewDueCount > 0);
     
     statusBar()->showMessage(QString("Statistics updated - %1 kanji learned, %2 due for review")
-                           .arg(learned).arg(reviewDue));
+                           .arg(learnedCount).arg(reviewDueCount));
 }
 
 void KanjiMainWindow::onLearnNewKanji()
 {
-    int newCount = database->getNewKanjiCount();
+    // Counters follow every write, so no count query is needed here
     if (newCount == 0) {
         QMessageBox::information(this, "No New Kanji", 
                                 "Congratulations! You have studied all available kanji.");
@@ -360,8 +615,14 @@ void KanjiMainWindow::onLearnNewKanji()
         learningWindow = nullptr;
     }
     
-    // Create and show new learning window
-    learningWindow = new KanjiLearningWindow(database, KanjiLearningWindow::Mode::Learning, this);
+    // Create and show new learning window, from the prefetched batch when it is still current
+    QList<KanjiCard> batch;
+    if (prefetcher && prefetcher->takeLearningBatch(batch)) {
+        learningWindow = new KanjiLearningWindow(database, KanjiLearningWindow::Mode::Learning, batch, this);
+    } else {
+        learningWindow = new KanjiLearningWindow(database, KanjiLearningWindow::Mode::Learning, this);
+    }
+    learningWindow->attachLatencyMonitor(latencyMonitor);
     connect(learningWindow, &QMainWindow::destroyed, this, &KanjiMainWindow::onLearningWindowClosed);
     learningWindow->show();
     learningWindow->raise();
@@ -371,36 +632,17 @@ void KanjiMainWindow::onLearnNewKanji()
 void KanjiMainWindow::onLearningWindowClosed()
 {
     learningWindow = nullptr;
-    // Refresh statistics when learning window is closed - but do it safely with a delay
-    QTimer::singleShot(100, this, &KanjiMainWindow::refreshStatistics);
+    // Statistics already followed the session through database change notifications
 }
 
 void KanjiMainWindow::onReviewKanji()
 {
-    int reviewCount = database->getReviewDueCount();
-    int learnedCount = database->getLearnedKanjiCount();
+    int reviewCount = reviewDueCount;
     
     qDebug() << "Review button clicked:";
     qDebug() << "- Learned kanji count:" << learnedCount;
     qDebug() << "- Review due count:" << reviewCount;
     
-    // Get detailed info about learned kanji
-    QList<KanjiCard> allKanji = database->getAllKanji();
-    int learnedWithReviewTime = 0;
-    QDateTime now = QDateTime::currentDateTime();
-    
-    for (const KanjiCard &kanji : allKanji) {
-        if (kanji.is_learned) {
-            learnedWithReviewTime++;
-            qDebug() << "Learned kanji:" << kanji.kanji 
-                     << "Level:" << kanji.srs_level 
-                     << "Next review:" << kanji.next_review.toString()
-                     << "Due?" << (kanji.next_review <= now);
-        }
-    }
-    
-    qDebug() << "- Learned kanji with review times:" << learnedWithReviewTime;
-    
     if (reviewCount == 0) {
         QString message;
         if (learnedCount == 0) {
@@ -421,8 +663,14 @@ void KanjiMainWindow::onReviewKanji()
         learningWindow = nullptr;
     }
     
-    // Create and show review window
-    learningWindow = new KanjiLearningWindow(database, KanjiLearningWindow::Mode::Review, this);
+    // Create and show review window, from the prefetched queue when it is still current
+    QList<KanjiCard> queue;
+    if (prefetcher && prefetcher->takeReviewQueue(queue)) {
+        learningWindow = new KanjiLearningWindow(database, KanjiLearningWindow::Mode::Review, queue, this);
+    } else {
+        learningWindow = new KanjiLearningWindow(database, KanjiLearningWindow::Mode::Review, this);
+    }
+    learningWindow->attachLatencyMonitor(latencyMonitor);
     connect(learningWindow, &QMainWindow::destroyed, this, &KanjiMainWindow::onLearningWindowClosed);
     learningWindow->show();
     learningWindow->raise();
@@ -431,37 +679,365 @@ void KanjiMainWindow::onReviewKanji()
 
 void KanjiMainWindow::onViewStatistics()
 {
-    refreshStatistics();
+    // One pass over the in-memory columns instead of a query per count
+    const KanjiStatistics stats = analytics->statistics();
+    totalCount = stats.totalCards;
+    learnedCount = stats.learnedCards;
+    newCount = stats.newCards;
+    reviewDueCount = stats.dueCards;
+    updateStatisticsDisplay();
+    scheduleDueTimer(stats.nextReview);
     
-    // Get SRS level breakdown
-    QMap<int, int> levelCounts = database->getKanjiCountByLevel();
+    auto accuracy = [](const KanjiAnswerCounts &counts) {
+        return counts.reviews > 0 ? QString("%1% of %2").arg(qRound(counts.accuracy() * 100)).arg(counts.reviews)
+                                  : QString("no answers");
+    };
     
     QString levelBreakdown = "SRS Level Breakdown:\n\n";
-    levelBreakdown += QString("Level 0 (Unlearned): %1\n").arg(levelCounts[0]);
-    levelBreakdown += QString("Level 1 (10 sec): %1\n").arg(levelCounts[1]);
-    levelBreakdown += QString("Level 2 (30 sec): %1\n").arg(levelCounts[2]);
-    levelBreakdown += QString("Level 3 (1 min): %1\n").arg(levelCounts[3]);
-    levelBreakdown += QString("Level 4 (2 min): %1\n").arg(levelCounts[4]);
-    levelBreakdown += QString("Level 5 (5 min): %1\n").arg(levelCounts[5]);
-    levelBreakdown += QString("Level 6 (10 min): %1\n").arg(levelCounts[6]);
-    levelBreakdown += QString("Level 7 (30 min): %1\n").arg(levelCounts[7]);
-    levelBreakdown += QString("Level 8 (1 hour): %1\n\n").arg(levelCounts[8]);
-    
-    QMessageBox::information(this, "Statistics", 
-                            QString("Kanji Learning Statistics\n\n"
-                                   "Total Kanji: %1\n"
-                                   "Learned: %2 (%3%)\n"
-                                   "New: %4\n"
-                                   "Due for Review: %5\n\n"
-                                   "%6"
-                                   "Keep up the great work!")
-                           .arg(database->getTotalKanjiCount())
-                           .arg(database->getLearnedKanjiCount())
-                           .arg(database->getTotalKanjiCount() > 0 ? 
-                                (database->getLearnedKanjiCount() * 100) / database->getTotalKanjiCount() : 0)
-                           .arg(database->getNewKanjiCount())
-                           .arg(database->getReviewDueCount())
-                           .arg(levelBreakdown));
+    levelBreakdown += QString("Level 0 (Unlearned): %1, answered %2\n")
+                          .arg(stats.cardsByLevel[0]).arg(accuracy(stats.byLevel[0]));
+    for (int level = 1; level < KanjiStatistics::LevelCount; ++level) {
+        levelBreakdown += QString("Level %1 (%2): %3, answered %4\n")
+                              .arg(level).arg(formatDuration(KanjiDatabase::srsIntervalSeconds(level)))
+                              .arg(stats.cardsByLevel[level]).arg(accuracy(stats.byLevel[level]));
+    }
+    
+    // Answer history by group, behind "Show Details..."
+    QString details = "Accuracy by difficulty:\n";
+    for (int difficulty = 0; difficulty < KanjiStatistics::DifficultyCount; ++difficulty) {
+        details += QString("  Difficulty %1: %2\n").arg(difficulty + 1).arg(accuracy(stats.byDifficulty[difficulty]));
+    }
+    details += "\nAccuracy by time of day:\n";
+    for (int hour = 0; hour < KanjiStatistics::HourCount; ++hour) {
+        if (stats.byHour[hour].reviews > 0) {
+            details += QString("  %1:00-%2:00: %3\n").arg(hour, 2, 10, QChar('0')).arg(hour + 1, 2, 10, QChar('0'))
+                           .arg(accuracy(stats.byHour[hour]));
+        }
+    }
+    details += "\nRetention by time since the previous review:\n";
+    for (int bucket = 0; bucket < KanjiStatistics::RetentionBucketCount; ++bucket) {
+        if (stats.retention[bucket].reviews > 0) {
+            details += QString("  From %1: %2\n").arg(formatDuration(KanjiStatistics::retentionBucketStart(bucket)))
+                           .arg(accuracy(stats.retention[bucket]));
+        }
+    }
+    
+    QMessageBox box(QMessageBox::Information, "Statistics",
+                    QString("Kanji Learning Statistics\n\n"
+                            "Total Kanji: %1\n"
+                            "Learned: %2 (%3%)\n"
+                            "New: %4\n"
+                            "Due for Review: %5\n\n"
+                            "Accuracy: %6\n"
+                            "Last %7 days: %8\n\n"
+                            "%9\n"
+                            "Keep up the great work!")
+                        .arg(stats.totalCards)
+                        .arg(stats.learnedCards)
+                        .arg(stats.totalCards > 0 ? (stats.learnedCards * 100) / stats.totalCards : 0)
+                        .arg(stats.newCards)
+                        .arg(stats.dueCards)
+                        .arg(accuracy(stats.answers))
+                        .arg(KanjiStatistics::RecentDays)
+                        .arg(accuracy(stats.recentAnswers))
+                        .arg(levelBreakdown),
+                    QMessageBox::Ok, this);
+    box.setDetailedText(details);
+    box.exec();
+}
+
+void KanjiMainWindow::onBrowseKanji()
+{
+    if (!browserWindow) {
+        browserWindow = new KanjiBrowserWindow(database, this);
+        browserWindow->setAttribute(Qt::WA_DeleteOnClose);
+    }
+    browserWindow->show();
+    browserWindow->raise();
+    browserWindow->activateWindow();
+}
+
+void KanjiMainWindow::onViewForecast()
+{
+    if (!forecastWindow) {
+        forecastWindow = new KanjiForecastWindow(forecast, this);
+        forecastWindow->setAttribute(Qt::WA_DeleteOnClose);
+    }
+    forecastWindow->show();
+    forecastWindow->raise();
+    forecastWindow->activateWindow();
+}
+
+void KanjiMainWindow::onAnalyzeTextFile()
+{
+    if (analyzeThread) {
+        statusBar()->showMessage("A text file is still being analyzed");
+        return;
+    }
+    
+    QString path = QFileDialog::getOpenFileName(this, "Analyze Text File", QString(),
+                                                "Text files (*.txt);;All files (*)");
+    if (path.isEmpty()) {
+        return;
+    }
+    
+    // The SQLite connection belongs to this thread, so take the SRS snapshot here
+    QHash<QString, int> levels = database->getKanjiSrsLevels();
+    QString fileName = QFileInfo(path).fileName();
+    statusBar()->showMessage(QString("Analyzing %1...").arg(fileName));
+    
+    // Large files take a few seconds - scan off the GUI thread
+    analyzeThread = QThread::create([this, path, fileName, levels]() {
+        KanjiDocumentAnalyzer analyzer(levels);
+        DocumentAnalysis analysis;
+        bool ok = analyzer.analyzeFile(path, analysis);
+        QString error = analyzer.getLastError();
+        
+        QMetaObject::invokeMethod(this, [this, ok, analysis, error, fileName]() {
+            if (!ok) {
+                statusBar()->showMessage("Analysis failed");
+                QMessageBox::warning(this, "Analysis Failed", error);
+                return;
+            }
+            showDocumentAnalysis(analysis, fileName);
+        }, Qt::QueuedConnection);
+    });
+    connect(analyzeThread, &QThread::finished, analyzeThread, &QObject::deleteLater);
+    analyzeThread->start();
+}
+
+void KanjiMainWindow::onAnalyzePastedText()
+{
+    bool ok = false;
+    QString text = QInputDialog::getMultiLineText(this, "Analyze Text",
+                                                  "Paste Japanese text to see which kanji you know:",
+                                                  QString(), &ok);
+    if (!ok || text.isEmpty()) {
+        return;
+    }
+    
+    KanjiDocumentAnalyzer analyzer(database->getKanjiSrsLevels());
+    showDocumentAnalysis(analyzer.analyzeText(text), "pasted text");
+}
+
+void KanjiMainWindow::onBuildFrequencyOrder()
+{
+    if (frequencyThread) {
+        statusBar()->showMessage("Text files are still being counted");
+        return;
+    }
+    
+    QString directory = QFileDialog::getExistingDirectory(this, "Choose a Folder of Japanese Text Files");
+    if (directory.isEmpty()) {
+        return;
+    }
+    
+    statusBar()->showMessage("Counting kanji in text files...");
+    
+    // Scanning runs off the GUI thread; only the priority update touches the database
+    frequencyThread = QThread::create([this, directory]() {
+        KanjiFrequencyBuilder builder;
+        builder.addDirectory(directory);
+        bool ok = builder.build();
+        QHash<QString, qint64> counts = builder.counts();
+        int fileCount = builder.getFileCount();
+        qint64 bytes = builder.stats().bytes;
+        QString error = builder.getLastError();
+        
+        QMetaObject::invokeMethod(this, [this, ok, counts, fileCount, bytes, error]() {
+            if (!ok || !database->setKanjiPriorities(counts)) {
+                statusBar()->showMessage("Frequency ordering failed");
+                QMessageBox::warning(this, "Frequency Ordering Failed",
+                                     ok ? database->getLastError() : error);
+                return;
+            }
+            
+            statusBar()->showMessage("New kanji are now ordered by text frequency");
+            QMessageBox::information(this, "Frequency Ordering",
+                                    QString("Scanned %1 files (%2 MB) and found %3 distinct kanji.\n"
+                                           "New kanji will now be introduced most frequent first.")
+                                   .arg(fileCount)
+                                   .arg(bytes / (1024 * 1024))
+                                   .arg(counts.size()));
+        }, Qt::QueuedConnection);
+    });
+    connect(frequencyThread, &QThread::finished, frequencyThread, &QObject::deleteLater);
+    frequencyThread->start();
+}
+
+void KanjiMainWindow::onImportKanji()
+{
+    QString path = QFileDialog::getOpenFileName(this, "Import Kanji List", QString(),
+                                                "Tab-separated files (*.tsv *.txt);;All files (*)");
+    if (path.isEmpty()) {
+        return;
+    }
+    
+    int imported = 0;
+    if (!database->importKanjiFile(path, &imported)) {
+        QMessageBox::warning(this, "Import Failed", database->getLastError());
+        return;
+    }
+    
+    populateDeckSelector();
+    statusBar()->showMessage(QString("Imported %1 kanji from %2").arg(imported).arg(QFileInfo(path).fileName()));
+}
+
+void KanjiMainWindow::onExportCards()
+{
+    QString path = QFileDialog::getSaveFileName(this, "Export Cards and Progress", "kanji_cards.kcol",
+                                                "Kanji Card Files (*.kcol)");
+    if (path.isEmpty()) {
+        return;
+    }
+    
+    QElapsedTimer timer;
+    timer.start();
+    int exported = 0;
+    if (!database->exportCards(path, &exported)) {
+        QMessageBox::warning(this, "Export Failed", database->getLastError());
+        return;
+    }
+    statusBar()->showMessage(QString("Exported %1 kanji (%2 KB) in %3 ms")
+                           .arg(exported).arg(QFileInfo(path).size() / 1024).arg(timer.elapsed()));
+}
+
+void KanjiMainWindow::onImportCards()
+{
+    QString path = QFileDialog::getOpenFileName(this, "Import Cards and Progress", QString(),
+                                                "Kanji Card Files (*.kcol);;All files (*)");
+    if (path.isEmpty()) {
+        return;
+    }
+    
+    QMessageBox::StandardButton reply = QMessageBox::question(this, "Import Cards and Progress",
+        "Cards in the file replace the content and progress of matching kanji.\nContinue?",
+        QMessageBox::Yes | QMessageBox::No);
+    if (reply != QMessageBox::Yes) {
+        return;
+    }
+    
+    QElapsedTimer timer;
+    timer.start();
+    int imported = 0;
+    if (!database->importCards(path, &imported)) {
+        QMessageBox::warning(this, "Import Failed", database->getLastError());
+        return;
+    }
+    
+    populateDeckSelector();
+    statusBar()->showMessage(QString("Imported %1 kanji in %2 ms").arg(imported).arg(timer.elapsed()));
+}
+
+void KanjiMainWindow::onSyncProgress()
+{
+    QString folder = QFileDialog::getExistingDirectory(this, "Choose the Shared Sync Folder",
+                                                       database->getSyncValue("sync_folder"));
+    if (folder.isEmpty()) {
+        return;
+    }
+    database->setSyncValue("sync_folder", folder);
+    
+    // Deltas are a few kilobytes, so this stays on the GUI connection
+    ProgressSync sync(database, folder);
+    if (!sync.sync()) {
+        QMessageBox::warning(this, "Sync Failed", sync.getLastError());
+        return;
+    }
+    
+    const SyncStats &stats = sync.stats();
+    statusBar()->showMessage(QString("Sync: sent %1 cards (%2 bytes), applied %3 of %4 received from %5 files")
+                           .arg(stats.exportedRecords).arg(stats.bytesWritten)
+                           .arg(stats.appliedRecords).arg(stats.receivedRecords).arg(stats.importedFiles)
+                           + (stats.waitingDevices > 0
+                              ? QString(", waiting on missing files from %1 devices").arg(stats.waitingDevices)
+                              : QString()));
+}
+
+void KanjiMainWindow::onBackupDatabase()
+{
+    if (databaseBackup->isRunning()) {
+        statusBar()->showMessage("A backup is already running");
+        return;
+    }
+    
+    QString path = QFileDialog::getSaveFileName(this, "Back Up Database", "kanji_learning_backup.db",
+                                                "SQLite Databases (*.db)");
+    if (!path.isEmpty()) {
+        databaseBackup->backup(path);
+    }
+}
+
+void KanjiMainWindow::onTakeSnapshot()
+{
+    if (!databaseBackup->snapshot()) {
+        statusBar()->showMessage("A backup is already running");
+    }
+}
+
+void KanjiMainWindow::onBackupFinished(bool ok, const QString &pathOrError)
+{
+    if (!ok) {
+        statusBar()->showMessage("Backup failed");
+        QMessageBox::warning(this, "Backup Failed", pathOrError);
+        return;
+    }
+    statusBar()->showMessage("Database backed up to " + QDir::toNativeSeparators(pathOrError));
+}
+
+void KanjiMainWindow::onExportLatency()
+{
+    QString path = QFileDialog::getSaveFileName(this, "Export Latency Histograms", "kanji_latency.csv",
+                                                "CSV Files (*.csv)");
+    if (path.isEmpty()) {
+        return;
+    }
+    
+    QString error;
+    if (!latencyMonitor->exportCsv(path, &error)) {
+        QMessageBox::warning(this, "Export Failed", "Could not write latency histograms: " + error);
+        return;
+    }
+    statusBar()->showMessage("Latency histograms exported to " + path);
+}
+
+void KanjiMainWindow::showDocumentAnalysis(const DocumentAnalysis &analysis, const QString &source)
+{
+    statusBar()->showMessage(QString("Analyzed %1 in %2 ms").arg(source).arg(analysis.elapsedMs));
+    
+    if (analysis.totalKanji == 0) {
+        QMessageBox::information(this, "Text Analysis", QString("No kanji found in %1.").arg(source));
+        return;
+    }
+    
+    QString unknown;
+    for (int i = 0; i < analysis.unknownKanji.size() && i < 15; ++i) {
+        const KanjiFrequency &frequency = analysis.unknownKanji[i];
+        unknown += QString("%1 ×%2   ").arg(frequency.kanji).arg(frequency.count);
+    }
+    
+    // Kanji without a card in the deck are marked with *
+    QString order;
+    for (int i = 0; i < analysis.learningOrder.size() && i < 30; ++i) {
+        const KanjiFrequency &frequency = analysis.learningOrder[i];
+        order += frequency.inDeck ? frequency.kanji : frequency.kanji + "*";
+        order += " ";
+    }
+    
+    QMessageBox::information(this, "Text Analysis",
+                            QString("Text Analysis: %1\n\n"
+                                   "Kanji in text: %2 (%3 distinct)\n"
+                                   "Known: %4 distinct\n"
+                                   "Coverage: %5%\n\n"
+                                   "Most frequent unknown kanji:\n%6\n\n"
+                                   "Suggested learning order (* = not in deck yet):\n%7")
+                           .arg(source)
+                           .arg(analysis.totalKanji)
+                           .arg(analysis.distinctKanji)
+                           .arg(analysis.distinctKnown)
+                           .arg(analysis.coverage, 0, 'f', 1)
+                           .arg(unknown.isEmpty() ? QString("none - you know them all!") : unknown)
+                           .arg(order));
 }
 
 void KanjiMainWindow::updateStatistics()
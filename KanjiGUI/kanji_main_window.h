@@ -10,12 +10,24 @@
 #include <QtWidgets/QWidget>
 #include <QtWidgets/QProgressBar>
 #include <QtWidgets/QFrame>
+#include <QtWidgets/QComboBox>
 #include <QFont>
 #include <QTimer>
+#include <QPointer>
 #include "kanji_database.h"
+#include "kanji_change_notifier.h"
+#include "kanji_document_analyzer.h"
 
 // Forward declaration
 class KanjiLearningWindow;
+class QThread;
+class KanjiBrowserWindow;
+class KanjiForecastWindow;
+class KanjiForecast;
+class KanjiAnalytics;
+class SessionPrefetcher;
+class DatabaseBackup;
+class LatencyMonitor;
 
 class KanjiMainWindow : public QMainWindow
 {
@@ -29,15 +41,39 @@ private slots:
     void onLearnNewKanji();
     void onReviewKanji();
     void onViewStatistics();
+    void onBrowseKanji();
+    void onViewForecast();
     void updateStatistics();
     void onLearningWindowClosed();
+    void onAnalyzeTextFile();
+    void onAnalyzePastedText();
+    void onBuildFrequencyOrder();
+    void onImportKanji();
+    void onExportCards();
+    void onImportCards();
+    void onSyncProgress();
+    void onBackupDatabase();
+    void onTakeSnapshot();
+    void onBackupFinished(bool ok, const QString &pathOrError);
+    void onDeckChanged(int index);
+    void onExportLatency();
+    void applyChange(const KanjiChangeSet &change);
+    void onReviewsBecameDue();
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
 
 private:
+    void startDatabaseInitialization();
     void setupUI();
     void createMenuBar();
     void createMainContent();
     void createStatisticsPanel();
     void refreshStatistics();
+    void populateDeckSelector();
+    void updateStatisticsDisplay();
+    void scheduleDueTimer(const QDateTime &when);
+    void showDocumentAnalysis(const DocumentAnalysis &analysis, const QString &source);
     
     // UI Components
     QWidget *centralWidget;
@@ -51,8 +87,9 @@ private:
     QPushButton *reviewButton;
     QPushButton *statisticsButton;
     
-    // Statistics display
+    // Statistics display, scoped to the deck chosen in deckComboBox
     QFrame *statsFrame;
+    QComboBox *deckComboBox;
     QLabel *totalKanjiLabel;
     QLabel *learnedKanjiLabel;
     QLabel *reviewDueLabel;
@@ -60,14 +97,32 @@ private:
     QLabel *progressLabel;
     QProgressBar *progressBar;
     
+    // Counters behind the statistics panel, kept current from database change deltas
+    int totalCount;
+    int learnedCount;
+    int newCount;
+    int reviewDueCount;
+    
     // Welcome/Info panel
     QLabel *welcomeLabel;
     QLabel *infoLabel;
     
     // Database and windows
     KanjiDatabase *database;
-    QTimer *refreshTimer;
+    bool databaseReady;              // GUI-thread connection open, counters loaded
+    QThread *startupThread;          // Runs initialize(); joined before the window goes away
+    QPointer<QThread> analyzeThread; // Text file scan, joined the same way
+    QPointer<QThread> frequencyThread; // Frequency corpus scan, joined the same way
+    QList<QAction*> databaseActions; // Disabled until databaseReady
+    SessionPrefetcher *prefetcher;   // Next session's cards, loaded in the background
+    DatabaseBackup *databaseBackup;  // Backups and snapshots on a worker connection
+    KanjiForecast *forecast;         // Review load histogram, kept current from change deltas
+    KanjiAnalytics *analytics;       // Counts and answer history for the statistics dialog
+    LatencyMonitor *latencyMonitor;  // Shared by every learning window
+    QTimer *dueTimer; // Fires when the next scheduled review becomes due
     KanjiLearningWindow *learningWindow;
+    QPointer<KanjiBrowserWindow> browserWindow;
+    QPointer<KanjiForecastWindow> forecastWindow;
 };
 
 #endif // KANJI_MAIN_WINDOW_H 
\ No newline at end of file
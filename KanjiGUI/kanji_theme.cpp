@@ -0,0 +1,277 @@
+#include "kanji_theme.h"
+#include <QtWidgets/QApplication>
+#include <QEvent>
+#include <QElapsedTimer>
+#include <QDebug>
+
+namespace {
+int polishEvents = 0;
+}
+
+KanjiTheme::KanjiTheme(QObject *parent)
+    : QObject(parent)
+{
+}
+
+void KanjiTheme::apply(QApplication &app)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    app.installEventFilter(new KanjiTheme(&app));
+    app.setStyleSheet(styleSheet());
+
+    qDebug() << "Theme applied in" << timer.elapsed() << "ms";
+}
+
+int KanjiTheme::polishCount()
+{
+    return polishEvents;
+}
+
+bool KanjiTheme::eventFilter(QObject *watched, QEvent *event)
+{
+    if (event->type() == QEvent::Polish) {
+        ++polishEvents;
+    }
+    return QObject::eventFilter(watched, event);
+}
+
+const QFont &KanjiTheme::font(Font role)
+{
+    static const QFont fonts[int(Font::FontCount)] = {
+        QFont("Arial", 24, QFont::Bold), // Welcome
+        QFont("Arial", 12),              // Info
+        QFont("Arial", 16, QFont::Bold), // PrimaryButton
+        QFont("Arial", 14),              // SecondaryButton
+        QFont("Arial", 16, QFont::Bold), // PanelTitle
+        QFont("Arial", 12),              // Statistic
+        QFont("Arial", 12, QFont::Bold)  // StatisticEmphasis
+    };
+    return fonts[int(role)];
+}
+
+QString KanjiTheme::styleSheet()
+{
+    return QStringLiteral(R"(
+        /* Main window */
+        QMainWindow#KanjiMainWindow {
+            background-color: #f8f9fa;
+        }
+        #KanjiMainWindow QPushButton {
+            background-color: #007bff;
+            color: white;
+            border: none;
+            border-radius: 8px;
+            padding: 15px 25px;
+            font-size: 14px;
+            font-weight: bold;
+            min-height: 20px;
+        }
+        #KanjiMainWindow QPushButton:hover {
+            background-color: #0056b3;
+        }
+        #KanjiMainWindow QPushButton:pressed {
+            background-color: #004085;
+        }
+        #KanjiMainWindow QFrame {
+            background-color: white;
+            border: 1px solid #dee2e6;
+            border-radius: 10px;
+            padding: 20px;
+        }
+        #KanjiMainWindow QLabel {
+            color: #333333;
+        }
+        #KanjiMainWindow QProgressBar {
+            border: 2px solid #dee2e6;
+            border-radius: 5px;
+            text-align: center;
+        }
+        #KanjiMainWindow QProgressBar::chunk {
+            background-color: #28a745;
+            border-radius: 3px;
+        }
+        #KanjiMainWindow QLabel#welcomeLabel {
+            color: #2c3e50;
+            margin-bottom: 10px;
+        }
+        #KanjiMainWindow QLabel#infoLabel {
+            color: #6c757d;
+            margin-bottom: 30px;
+        }
+        #KanjiMainWindow QPushButton#learnNewButton {
+            background-color: #28a745;
+        }
+        #KanjiMainWindow QPushButton#learnNewButton:hover {
+            background-color: #1e7e34;
+        }
+        #KanjiMainWindow QPushButton#reviewButton {
+            background-color: #ffc107;
+            color: #212529;
+        }
+        #KanjiMainWindow QPushButton#reviewButton:hover {
+            background-color: #e0a800;
+        }
+        #KanjiMainWindow QPushButton#statisticsButton {
+            background-color: #6f42c1;
+        }
+        #KanjiMainWindow QPushButton#statisticsButton:hover {
+            background-color: #5a32a3;
+        }
+        #KanjiMainWindow QLabel#statsTitle {
+            color: #495057;
+            margin-bottom: 20px;
+        }
+        #KanjiMainWindow QLabel#learnedKanjiLabel {
+            color: #28a745;
+        }
+        #KanjiMainWindow QLabel#newKanjiLabel {
+            color: #007bff;
+        }
+        #KanjiMainWindow QLabel#reviewDueLabel {
+            color: #ffc107;
+        }
+
+        /* Learning window */
+        QMainWindow#KanjiLearningWindow, #KanjiLearningWindow QWidget {
+            background-color: #f8f9fa;
+            font-family: Arial;
+        }
+        #KanjiLearningWindow QPushButton {
+            background-color: #007bff;
+            color: white;
+            border: none;
+            padding: 12px 24px;
+            font-size: 16px;
+            font-weight: bold;
+            border-radius: 6px;
+            min-height: 40px;
+        }
+        #KanjiLearningWindow QPushButton:hover {
+            background-color: #0056b3;
+        }
+        #KanjiLearningWindow QPushButton:disabled {
+            background-color: #6c757d;
+            color: #ffffff;
+        }
+        #KanjiLearningWindow QLineEdit {
+            background-color: white;
+            border: 3px solid #007bff;
+            padding: 12px;
+            font-size: 18px;
+            font-weight: bold;
+            border-radius: 6px;
+            color: #000000;
+        }
+        #KanjiLearningWindow QLabel {
+            color: #000000;
+            font-weight: bold;
+        }
+        #KanjiLearningWindow QLabel#modeTitle {
+            font-size: 28px;
+            background: white;
+            padding: 25px;
+            border-radius: 8px;
+            border: 2px solid #007bff;
+        }
+        #KanjiLearningWindow QLabel#progressCaption {
+            font-size: 18px;
+            padding: 15px;
+        }
+        #KanjiLearningWindow QWidget#studyContent {
+            background: white;
+            border-radius: 12px;
+            padding: 80px;
+            border: 2px solid #dee2e6;
+        }
+        #KanjiLearningWindow QLabel#studyKanji {
+            background: white;
+            min-height: 350px;
+            padding: 20px 50px 50px 50px;
+        }
+        #KanjiLearningWindow QLabel#meaningLabel {
+            font-size: 24px;
+            background: #f8d7da;
+            padding: 15px;
+            border-radius: 6px;
+            border: 2px solid #e74c3c;
+        }
+        #KanjiLearningWindow QLabel#readingLabel {
+            font-size: 22px;
+            background: #d1ecf1;
+            padding: 15px;
+            border-radius: 6px;
+            border: 2px solid #3498db;
+        }
+        #KanjiLearningWindow QPushButton#backToMainButton {
+            background-color: #6c757d;
+        }
+        #KanjiLearningWindow QPushButton#previousButton {
+            background-color: #ffc107;
+            color: #000000;
+        }
+        #KanjiLearningWindow QPushButton#nextButton {
+            background-color: #28a745;
+        }
+        #KanjiLearningWindow QPushButton#startQuizButton {
+            background-color: #dc3545;
+            font-size: 18px;
+            min-width: 150px;
+        }
+        #KanjiLearningWindow QProgressBar#quizProgressBar {
+            border: 2px solid #007bff;
+            border-radius: 6px;
+            background: white;
+            font-size: 14px;
+            font-weight: bold;
+            color: #000000;
+        }
+        #KanjiLearningWindow QProgressBar#quizProgressBar::chunk {
+            background-color: #28a745;
+            border-radius: 4px;
+        }
+        #KanjiLearningWindow QWidget#quizContent {
+            background: white;
+            border-radius: 12px;
+            padding: 40px;
+            border: 2px solid #dee2e6;
+        }
+        #KanjiLearningWindow QWidget#quizKanjiPanel {
+            border-radius: 8px;
+            padding: 20px 40px 40px 40px;
+            min-width: 500px;
+        }
+        #KanjiLearningWindow QLabel#quizKanji {
+            min-height: 400px;
+        }
+        #KanjiLearningWindow QWidget#quizInputPanel {
+            border-radius: 8px;
+            padding: 40px;
+            min-width: 400px;
+        }
+        #KanjiLearningWindow QLabel#quizQuestionLabel {
+            font-size: 24px;
+            padding: 20px;
+            background: white;
+            border-radius: 8px;
+        }
+        #KanjiLearningWindow QLineEdit#answerLineEdit {
+            min-height: 80px;
+            font-size: 24px;
+            border-radius: 8px;
+            padding: 15px;
+        }
+        #KanjiLearningWindow QLabel#instructionLabel {
+            font-size: 16px;
+            color: #6c757d;
+            font-style: italic;
+            padding: 10px;
+        }
+        #KanjiLearningWindow QPushButton#retryButton {
+            background-color: #dc3545;
+            min-height: 50px;
+            font-size: 18px;
+        }
+    )");
+}
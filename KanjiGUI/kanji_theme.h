@@ -0,0 +1,45 @@
+#ifndef KANJI_THEME_H
+#define KANJI_THEME_H
+
+#include <QObject>
+#include <QFont>
+#include <QString>
+
+class QApplication;
+
+// All widget styling for the GUI, compiled into one application stylesheet.
+// Windows and widgets only set object names; rules are scoped by the window's
+// object name so each window keeps its own look. Styling once at the
+// application level replaces dozens of per-widget setStyleSheet calls, each of
+// which re-parsed CSS and re-polished the widget during construction.
+class KanjiTheme : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum class Font {
+        Welcome,
+        Info,
+        PrimaryButton,
+        SecondaryButton,
+        PanelTitle,
+        Statistic,
+        StatisticEmphasis,
+        FontCount
+    };
+
+    static void apply(QApplication &app);
+    static const QFont &font(Font role);
+
+    // Polish events seen since apply(), to spot widgets being re-styled
+    static int polishCount();
+
+protected:
+    bool eventFilter(QObject *watched, QEvent *event) override;
+
+private:
+    explicit KanjiTheme(QObject *parent);
+    static QString styleSheet();
+};
+
+#endif // KANJI_THEME_H
@@ -0,0 +1,80 @@
+#include "latency_hud.h"
+#include <QPainter>
+#include <QFontMetrics>
+
+LatencyHud::LatencyHud(LatencyMonitor *monitor, QWidget *parent)
+    : QWidget(parent), monitor(monitor)
+{
+    setAttribute(Qt::WA_TransparentForMouseEvents);
+
+    font = QFont("Courier New");
+    font.setStyleHint(QFont::Monospace);
+    font.setPixelSize(13);
+
+    refreshTimer = new QTimer(this);
+    refreshTimer->setInterval(RefreshMs);
+    connect(refreshTimer, &QTimer::timeout, this, qOverload<>(&QWidget::update));
+
+    QFontMetrics metrics(font);
+    resize(metrics.horizontalAdvance(QString(46, 'M')) + 2 * Margin,
+           metrics.lineSpacing() * (int(LatencyMonitor::Stage::StageCount) + 2) + 2 * Margin);
+    hide();
+}
+
+void LatencyHud::toggle()
+{
+    if (isVisible()) {
+        refreshTimer->stop();
+        hide();
+        return;
+    }
+
+    place();
+    show();
+    raise();
+    refreshTimer->start();
+}
+
+void LatencyHud::place()
+{
+    if (parentWidget()) {
+        move(parentWidget()->width() - width() - Margin, Margin);
+    }
+}
+
+QString LatencyHud::formatMicros(qint64 micros)
+{
+    if (micros >= 10000) {
+        return QString("%1ms").arg(micros / 1000);
+    }
+    return QString("%1ms").arg(micros / 1000.0, 0, 'f', 2);
+}
+
+void LatencyHud::paintEvent(QPaintEvent *)
+{
+    QPainter painter(this);
+    painter.fillRect(rect(), QColor(0, 0, 0, 190));
+    painter.setFont(font);
+    painter.setPen(QColor("#e0e0e0"));
+
+    QFontMetrics metrics(font);
+    const int lineHeight = metrics.lineSpacing();
+    int y = Margin + metrics.ascent();
+
+    painter.drawText(Margin, y, QString("%1 %2 %3 %4")
+                     .arg(QString("stage"), -18).arg(QString("p50"), 8).arg(QString("p99"), 8).arg(QString("n"), 7));
+    y += lineHeight;
+
+    for (int stage = 0; stage < int(LatencyMonitor::Stage::StageCount); ++stage) {
+        const LatencyHistogram &histogram = monitor->histogram(LatencyMonitor::Stage(stage));
+        painter.drawText(Margin, y, QString("%1 %2 %3 %4")
+                         .arg(LatencyMonitor::stageName(LatencyMonitor::Stage(stage)), -18)
+                         .arg(formatMicros(histogram.percentile(50)), 8)
+                         .arg(formatMicros(histogram.percentile(99)), 8)
+                         .arg(histogram.count(), 7));
+        y += lineHeight;
+    }
+
+    painter.setPen(monitor->getStallCount() > 0 ? QColor("#ffc107") : QColor("#e0e0e0"));
+    painter.drawText(Margin, y, QString("event loop stalls: %1").arg(monitor->getStallCount()));
+}
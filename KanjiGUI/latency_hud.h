@@ -0,0 +1,36 @@
+#ifndef LATENCY_HUD_H
+#define LATENCY_HUD_H
+
+#include <QtWidgets/QWidget>
+#include <QFont>
+#include <QTimer>
+#include "latency_monitor.h"
+
+// Small always-on-top panel with p50/p99 per LatencyMonitor stage and the
+// event-loop stall count. Hidden by default; toggle() shows it and starts a
+// 4 Hz refresh that stops again while hidden.
+class LatencyHud : public QWidget
+{
+    Q_OBJECT
+
+public:
+    LatencyHud(LatencyMonitor *monitor, QWidget *parent);
+
+    void toggle();
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+
+private:
+    static constexpr int RefreshMs = 250;
+    static constexpr int Margin = 10;
+
+    static QString formatMicros(qint64 micros);
+    void place();
+
+    LatencyMonitor *monitor;
+    QTimer *refreshTimer;
+    QFont font;
+};
+
+#endif // LATENCY_HUD_H
@@ -0,0 +1,255 @@
+#include "latency_monitor.h"
+#include <QtWidgets/QWidget>
+#include <QKeyEvent>
+#include <QFile>
+#include <QTextStream>
+
+LatencyHistogram::LatencyHistogram()
+    : counts((MaxMagnitude - SubBucketBits + 2) * SubBucketCount, 0), total(0), maxValue(0)
+{
+}
+
+int LatencyHistogram::indexFor(qint64 micros)
+{
+    if (micros < SubBucketCount) {
+        return int(qMax<qint64>(0, micros));
+    }
+
+    int magnitude = 63 - qCountLeadingZeroBits(quint64(micros));
+    if (magnitude > MaxMagnitude) {
+        return (MaxMagnitude - SubBucketBits + 2) * SubBucketCount - 1;
+    }
+
+    const int shift = magnitude - SubBucketBits;
+    const int subBucket = int(micros >> shift) - SubBucketCount;
+    return (shift + 1) * SubBucketCount + subBucket;
+}
+
+qint64 LatencyHistogram::bucketLower(int index)
+{
+    if (index < SubBucketCount) {
+        return index;
+    }
+    const int shift = index / SubBucketCount - 1;
+    const qint64 subBucket = index % SubBucketCount + SubBucketCount;
+    return subBucket << shift;
+}
+
+qint64 LatencyHistogram::bucketUpper(int index)
+{
+    if (index < SubBucketCount) {
+        return index;
+    }
+    const int shift = index / SubBucketCount - 1;
+    return bucketLower(index) + (qint64(1) << shift) - 1;
+}
+
+void LatencyHistogram::record(qint64 micros)
+{
+    ++counts[indexFor(micros)];
+    ++total;
+    maxValue = qMax(maxValue, micros);
+}
+
+void LatencyHistogram::reset()
+{
+    counts.fill(0);
+    total = 0;
+    maxValue = 0;
+}
+
+qint64 LatencyHistogram::percentile(double percent) const
+{
+    if (total == 0) {
+        return 0;
+    }
+
+    const qint64 target = qMax<qint64>(1, qint64(total * percent / 100.0 + 0.5));
+    qint64 seen = 0;
+    for (int i = 0; i < counts.size(); ++i) {
+        seen += counts[i];
+        if (seen >= target) {
+            return qMin(bucketUpper(i), maxValue);
+        }
+    }
+    return maxValue;
+}
+
+LatencyMonitor::Scope::Scope(LatencyMonitor *monitor, Stage stage)
+    : monitor(monitor), stage(stage), startNs(monitor ? monitor->clock.nsecsElapsed() : 0)
+{
+}
+
+LatencyMonitor::Scope::~Scope()
+{
+    if (monitor) {
+        monitor->record(stage, (monitor->clock.nsecsElapsed() - startNs) / 1000);
+    }
+}
+
+LatencyMonitor::LatencyMonitor(QObject *parent)
+    : QObject(parent), inputWidget(nullptr), stalls(0)
+{
+    clock.start();
+    for (qint64 &start : pendingStart) {
+        start = -1;
+    }
+
+    // A late heartbeat means the event loop was blocked for that long
+    heartbeat = new QTimer(this);
+    heartbeat->setTimerType(Qt::PreciseTimer);
+    heartbeat->setInterval(HeartbeatMs);
+    connect(heartbeat, &QTimer::timeout, this, &LatencyMonitor::onHeartbeat);
+    lastHeartbeatNs = clock.nsecsElapsed();
+}
+
+void LatencyMonitor::watchInput(QWidget *input)
+{
+    inputWidget = input;
+    input->installEventFilter(this);
+}
+
+void LatencyMonitor::watchPaint(QWidget *widget, Stage stage)
+{
+    paintWatches.append(qMakePair(static_cast<QObject *>(widget), stage));
+    widget->installEventFilter(this);
+    connect(widget, &QObject::destroyed, this, [this](QObject *object) {
+        for (int i = paintWatches.size() - 1; i >= 0; --i) {
+            if (paintWatches[i].first == object) {
+                paintWatches.removeAt(i);
+            }
+        }
+        if (inputWidget == object) {
+            inputWidget = nullptr;
+        }
+    });
+}
+
+void LatencyMonitor::sampleWhileVisible(QWidget *window)
+{
+    sampledWindows.append(window);
+    window->installEventFilter(this);
+    connect(window, &QObject::destroyed, this, &LatencyMonitor::updateHeartbeat);
+    updateHeartbeat();
+}
+
+void LatencyMonitor::updateHeartbeat()
+{
+    sampledWindows.removeAll(QPointer<QWidget>()); // Destroyed windows
+    bool shown = false;
+    for (const QPointer<QWidget> &window : sampledWindows) {
+        shown = shown || (window && window->isVisible());
+    }
+
+    if (shown && !heartbeat->isActive()) {
+        // Time spent stopped is not lateness
+        lastHeartbeatNs = clock.nsecsElapsed();
+        heartbeat->start();
+    } else if (!shown) {
+        heartbeat->stop();
+    }
+}
+
+void LatencyMonitor::begin(Stage stage)
+{
+    pendingStart[int(stage)] = clock.nsecsElapsed();
+}
+
+void LatencyMonitor::end(Stage stage)
+{
+    qint64 &start = pendingStart[int(stage)];
+    if (start < 0) {
+        return;
+    }
+    record(stage, (clock.nsecsElapsed() - start) / 1000);
+    start = -1;
+}
+
+void LatencyMonitor::record(Stage stage, qint64 micros)
+{
+    histograms[int(stage)].record(micros);
+}
+
+void LatencyMonitor::reset()
+{
+    for (LatencyHistogram &histogram : histograms) {
+        histogram.reset();
+    }
+    stalls = 0;
+}
+
+bool LatencyMonitor::eventFilter(QObject *watched, QEvent *event)
+{
+    if (event->type() == QEvent::KeyPress && watched == inputWidget) {
+        begin(Stage::KeyToConversion);
+        begin(Stage::KeyToPaint);
+        const int key = static_cast<QKeyEvent *>(event)->key();
+        if (key == Qt::Key_Return || key == Qt::Key_Enter) {
+            begin(Stage::EnterToFeedback);
+        }
+    } else if (event->type() == QEvent::Show || event->type() == QEvent::Hide) {
+        if (sampledWindows.contains(qobject_cast<QWidget *>(watched))) {
+            updateHeartbeat();
+        }
+    } else if (event->type() == QEvent::Paint) {
+        for (const auto &watch : paintWatches) {
+            if (watch.first == watched) {
+                end(watch.second);
+            }
+        }
+    }
+    return QObject::eventFilter(watched, event);
+}
+
+void LatencyMonitor::onHeartbeat()
+{
+    const qint64 now = clock.nsecsElapsed();
+    const qint64 lateMs = (now - lastHeartbeatNs) / 1000000 - HeartbeatMs;
+    lastHeartbeatNs = now;
+
+    record(Stage::EventLoopLag, qMax<qint64>(0, lateMs) * 1000);
+    if (lateMs >= StallThresholdMs) {
+        ++stalls;
+    }
+}
+
+QString LatencyMonitor::stageName(Stage stage)
+{
+    switch (stage) {
+    case Stage::KeyToConversion: return "key_to_conversion";
+    case Stage::KeyToPaint: return "key_to_paint";
+    case Stage::EnterToFeedback: return "enter_to_feedback";
+    case Stage::AnswerCheck: return "answer_check";
+    case Stage::DatabaseWrite: return "database_write";
+    case Stage::EventLoopLag: return "event_loop_lag";
+    default: return "unknown";
+    }
+}
+
+bool LatencyMonitor::exportCsv(const QString &path, QString *error) const
+{
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+        if (error) {
+            *error = file.errorString();
+        }
+        return false;
+    }
+
+    // One row per non-empty bucket so runs can be merged or diffed offline
+    QTextStream out(&file);
+    out << "stage,lower_us,upper_us,count\n";
+    for (int stage = 0; stage < int(Stage::StageCount); ++stage) {
+        const LatencyHistogram &histogram = histograms[stage];
+        const QString name = stageName(Stage(stage));
+        for (int i = 0; i < histogram.bucketCount(); ++i) {
+            if (histogram.bucketValue(i) > 0) {
+                out << name << ',' << LatencyHistogram::bucketLower(i) << ','
+                    << LatencyHistogram::bucketUpper(i) << ',' << histogram.bucketValue(i) << '\n';
+            }
+        }
+    }
+    out << "stalls,0,0," << stalls << '\n';
+
+    return true;
+}
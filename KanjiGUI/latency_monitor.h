@@ -0,0 +1,118 @@
+#ifndef LATENCY_MONITOR_H
+#define LATENCY_MONITOR_H
+
+#include <QObject>
+#include <QString>
+#include <QVector>
+#include <QElapsedTimer>
+#include <QTimer>
+#include <QPointer>
+
+class QWidget;
+
+// Log-linear latency histogram in microseconds, HdrHistogram style: 32 linear
+// sub-buckets per power of two, so every recorded value is kept to within ~3%
+// from 1 us up to several hours with a fixed 1024 counters.
+class LatencyHistogram
+{
+public:
+    LatencyHistogram();
+
+    void record(qint64 micros);
+    void reset();
+
+    qint64 count() const { return total; }
+    qint64 max() const { return maxValue; }
+    qint64 percentile(double percent) const; // Upper edge of the bucket holding it
+
+    int bucketCount() const { return counts.size(); }
+    qint64 bucketValue(int index) const { return counts[index]; }
+    static qint64 bucketLower(int index);
+    static qint64 bucketUpper(int index);
+
+private:
+    static constexpr int SubBucketBits = 5;
+    static constexpr int SubBucketCount = 1 << SubBucketBits;
+    static constexpr int MaxMagnitude = 35;
+
+    static int indexFor(qint64 micros);
+
+    QVector<qint64> counts;
+    qint64 total;
+    qint64 maxValue;
+};
+
+// Timestamps the answer path of a quiz (key press, romaji conversion, answer
+// check, database write, next paint) into one histogram per stage, and counts
+// event-loop stalls with a heartbeat timer. The heartbeat only runs while a
+// window registered with sampleWhileVisible() is shown, so an idle app isn't
+// woken by it. Paint-terminated stages are closed by an event filter on the
+// widget that shows the result.
+class LatencyMonitor : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum class Stage {
+        KeyToConversion, // Key press in the answer field -> conversion done
+        KeyToPaint,      // Key press -> answer field repainted
+        EnterToFeedback, // Enter -> feedback overlay painted
+        AnswerCheck,     // checkQuizAnswer
+        DatabaseWrite,   // updateKanjiProgress from the quiz
+        EventLoopLag,    // Heartbeat lateness
+        StageCount
+    };
+
+    // Times the enclosing block; does nothing with a null monitor
+    class Scope
+    {
+    public:
+        Scope(LatencyMonitor *monitor, Stage stage);
+        ~Scope();
+
+    private:
+        LatencyMonitor *monitor;
+        Stage stage;
+        qint64 startNs;
+    };
+
+    explicit LatencyMonitor(QObject *parent = nullptr);
+
+    void watchInput(QWidget *input);              // Starts the key stages
+    void watchPaint(QWidget *widget, Stage stage); // Paint of widget ends stage
+    void sampleWhileVisible(QWidget *window);      // Heartbeat runs while any such window is shown
+
+    void begin(Stage stage);
+    void end(Stage stage); // Records only if begin() is pending
+    void record(Stage stage, qint64 micros);
+
+    const LatencyHistogram &histogram(Stage stage) const { return histograms[int(stage)]; }
+    int getStallCount() const { return stalls; }
+    void reset();
+
+    bool exportCsv(const QString &path, QString *error = nullptr) const;
+    static QString stageName(Stage stage);
+
+protected:
+    bool eventFilter(QObject *watched, QEvent *event) override;
+
+private:
+    static constexpr int HeartbeatMs = 50;
+    static constexpr int StallThresholdMs = 100; // Lateness that counts as a stall
+
+    void onHeartbeat();
+    void updateHeartbeat();
+
+    QElapsedTimer clock;
+    LatencyHistogram histograms[int(Stage::StageCount)];
+    qint64 pendingStart[int(Stage::StageCount)];
+    QList<QPair<QObject *, Stage>> paintWatches;
+    QObject *inputWidget;
+
+    QList<QPointer<QWidget>> sampledWindows;
+    QTimer *heartbeat;
+    qint64 lastHeartbeatNs;
+    int stalls;
+};
+
+#endif // LATENCY_MONITOR_H
@@ -0,0 +1,46 @@
+#include "startup_timer.h"
+#include <QElapsedTimer>
+#include <QDebug>
+
+namespace {
+
+// Started during static initialization, before main() runs
+struct ProcessClock {
+    QElapsedTimer timer;
+    qint64 firstPaint = -1;
+    bool interactive = false;
+    ProcessClock() { timer.start(); }
+};
+
+ProcessClock processClock;
+
+}
+
+qint64 StartupTimer::elapsed()
+{
+    return processClock.timer.elapsed();
+}
+
+void StartupTimer::markFirstPaint()
+{
+    if (processClock.firstPaint >= 0) {
+        return;
+    }
+    processClock.firstPaint = elapsed();
+
+    if (processClock.firstPaint > FirstPaintTargetMs) {
+        qWarning() << "Startup: first paint at" << processClock.firstPaint << "ms, target is"
+                   << FirstPaintTargetMs << "ms";
+    } else {
+        qDebug() << "Startup: first paint at" << processClock.firstPaint << "ms";
+    }
+}
+
+void StartupTimer::markInteractive()
+{
+    if (processClock.interactive) {
+        return;
+    }
+    processClock.interactive = true;
+    qDebug() << "Startup: interactive at" << elapsed() << "ms";
+}
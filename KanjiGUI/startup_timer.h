@@ -0,0 +1,19 @@
+#ifndef STARTUP_TIMER_H
+#define STARTUP_TIMER_H
+
+#include <QString>
+
+// Cold start phases measured from process start (static initialization of the
+// executable) and written to the log: first paint, then interactive once the
+// database is open and statistics are shown.
+class StartupTimer
+{
+public:
+    static constexpr qint64 FirstPaintTargetMs = 150;
+
+    static qint64 elapsed();
+    static void markFirstPaint(); // Only the first call is logged
+    static void markInteractive();
+};
+
+#endif // STARTUP_TIMER_H
@@ -0,0 +1,85 @@
+// Allocation check for KanjiResultSet: reads a 10k-card deck with
+// getAllKanjiRows() and checks that the rows cost arena blocks rather than
+// per-row or per-string heap allocations.
+//
+//   KanjiArenaCheck [--deck-size 10000] [--data-dir dir]
+//
+// Passes when the result set holds no more heap blocks than its used bytes
+// need in DefaultBlockSize blocks, plus the row chunk index and a partly
+// filled last block, and when that is under 1% of the estimated string
+// allocations of the same rows as KanjiCards. Exit code 0 when both hold,
+// 1 when either fails, 2 on a setup failure.
+
+#include "kanji_database.h"
+#include "kanji_result_set.h"
+#include "synthetic_deck.h"
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDir>
+#include <QLoggingCategory>
+#include <QTemporaryDir>
+#include <QTextStream>
+
+namespace {
+
+constexpr int SlackBlocks = 2;            // Chunk index and the partly filled last block
+constexpr int MaxPercentOfStrings = 1;
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("KanjiArenaCheck");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Checks that a whole-deck read stays within a bounded number of heap allocations.");
+    parser.addHelpOption();
+    parser.addOptions({
+        {"deck-size", "Cards in the generated deck.", "n", "10000"},
+        {"data-dir", "Database directory, a temporary one by default.", "dir"}
+    });
+    parser.process(app);
+
+    // KanjiDatabase logs every query
+    QLoggingCategory::setFilterRules("default.debug=false");
+
+    const int deckSize = qBound(1, parser.value("deck-size").toInt(), 0x9FFF - 0x4E00);
+    QTemporaryDir temporaryDir;
+    const QString dataDir = parser.isSet("data-dir") ? parser.value("data-dir") : temporaryDir.path();
+    QDir().mkpath(dataDir);
+    KanjiDatabase::setDataLocation(dataDir);
+
+    KanjiDatabase database("KanjiArenaCheck");
+    const QString deckPath = dataDir + "/arena_deck.tsv";
+    if (!database.initialize() || !writeSyntheticDeck(deckPath, deckSize) || !database.importKanjiFile(deckPath)) {
+        qWarning() << "Setup failed:" << database.getLastError();
+        return 2;
+    }
+
+    const KanjiResultSet rows = database.getAllKanjiRows();
+    const KanjiResultSet::Stats stats = rows.stats();
+    const qsizetype blockLimit = (stats.bytesUsed + KanjiArena::DefaultBlockSize - 1) / KanjiArena::DefaultBlockSize
+                                 + SlackBlocks;
+
+    QTextStream console(stdout);
+    console << QString("%1 rows: %2 heap allocations (limit %3), about %4 as KanjiCard strings\n")
+               .arg(stats.rows).arg(stats.heapAllocations).arg(blockLimit).arg(stats.stringAllocations);
+
+    int failures = 0;
+    if (stats.rows < database.getTotalKanjiCount()) {
+        console << QString("FAIL read %1 of %2 cards\n").arg(stats.rows).arg(database.getTotalKanjiCount());
+        ++failures;
+    }
+    if (stats.heapAllocations > blockLimit) {
+        console << "FAIL more heap allocations than the arena blocks account for\n";
+        ++failures;
+    }
+    if (stats.heapAllocations * 100 > stats.stringAllocations * MaxPercentOfStrings) {
+        console << QString("FAIL heap allocations are over %1% of the KanjiCard estimate\n").arg(MaxPercentOfStrings);
+        ++failures;
+    }
+
+    console << (failures ? QString("%1 checks failed\n").arg(failures) : QString("Allocations within bounds\n"));
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,395 @@
+// Query-plan audit for KanjiDatabase: drives every public operation against a
+// populated database, collects each distinct statement it prepares (see
+// KanjiDatabase::setStatementObserver) and runs EXPLAIN QUERY PLAN on it.
+//
+//   KanjiPlanAudit [--deck-size 2136] [--data-dir dir] [--verbose]
+//
+// Statements are classed by the operation that issued them:
+//   hot         study loop, counters, search and deep browse pages: any SCAN
+//               of the kanji table fails, as does a missing expected index
+//   first page  first browse page: an index walk in sort order is allowed,
+//               it stops after LIMIT rows; a walk that also sorts fails
+//   cold        imports, exports, whole-deck reads: reported only
+// A statement issued by more than one operation gets the strictest class.
+// Statements run inside triggers are not covered. Exit code 0 when every
+// plan passes, 1 on a violation, 2 on a setup failure.
+
+#include "kanji_database.h"
+#include "kanji_clock.h"
+#include "synthetic_deck.h"
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QLoggingCategory>
+#include <QMap>
+#include <QRegularExpression>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <algorithm>
+#include <climits>
+
+namespace {
+
+constexpr int PageSize = 100;
+constexpr int LearnBatches = 60;
+
+enum Access {
+    Hot,
+    FirstPage,
+    Cold
+};
+
+const char *const AccessNames[] = {"hot", "first page", "cold"};
+
+struct Statement {
+    QString sql;
+    QStringList operations;
+    Access access = Cold;
+    QStringList expectedIndexes; // Each must appear in the plan
+};
+
+// Tags every statement KanjiDatabase prepares with the operation running at the time
+class StatementLog
+{
+public:
+    template <typename Operation>
+    void run(const QString &name, Access access, Operation operation, const QStringList &expectedIndexes = {})
+    {
+        currentName = name;
+        currentAccess = access;
+        currentExpected = expectedIndexes;
+        operation();
+        currentName = "setup";
+        currentAccess = Cold;
+        currentExpected.clear();
+    }
+
+    void record(const QString &sql)
+    {
+        const QString key = sql.simplified();
+        auto it = statements.find(key);
+        if (it == statements.end()) {
+            it = statements.insert(key, Statement());
+            it->sql = key;
+            it->access = currentAccess;
+        }
+        if (!it->operations.contains(currentName)) {
+            it->operations.append(currentName);
+        }
+        it->access = qMin(it->access, currentAccess);
+        for (const QString &index : currentExpected) {
+            if (!it->expectedIndexes.contains(index)) {
+                it->expectedIndexes.append(index);
+            }
+        }
+    }
+
+    QList<Statement> all() const { return statements.values(); }
+
+private:
+    QMap<QString, Statement> statements;
+    QString currentName = "setup";
+    Access currentAccess = Cold;
+    QStringList currentExpected;
+};
+
+bool isPlanned(const QString &sql)
+{
+    static const QRegularExpression dml("^(SELECT|INSERT|UPDATE|DELETE|WITH|REPLACE)\\b",
+                                        QRegularExpression::CaseInsensitiveOption);
+    return dml.match(sql).hasMatch();
+}
+
+// Positional placeholders outside string literals
+int placeholderCount(const QString &sql)
+{
+    int count = 0;
+    bool quoted = false;
+    for (QChar c : sql) {
+        if (c == '\'') {
+            quoted = !quoted;
+        } else if (c == '?' && !quoted) {
+            ++count;
+        }
+    }
+    return count;
+}
+
+// Plan detail rows; values don't matter to the planner without sqlite_stat tables
+bool explain(QSqlDatabase &db, const QString &sql, QStringList &plan, QString &error)
+{
+    QSqlQuery query(db);
+    if (!query.prepare("EXPLAIN QUERY PLAN " + sql)) {
+        error = query.lastError().text();
+        return false;
+    }
+    for (int i = placeholderCount(sql); i > 0; --i) {
+        query.addBindValue(QVariant());
+    }
+    if (!query.exec()) {
+        error = query.lastError().text();
+        return false;
+    }
+    while (query.next()) {
+        plan.append(query.value(3).toString());
+    }
+    return true;
+}
+
+// Violations of the statement's class, empty when the plan passes
+QStringList checkPlan(const Statement &statement, const QStringList &plan)
+{
+    static const QRegularExpression kanjiScan("^SCAN (TABLE )?kanji( |$)"); // TABLE before SQLite 3.36
+    const QString text = plan.join('\n');
+
+    QStringList problems;
+    bool scans = false;
+    for (const QString &row : plan) {
+        scans = scans || kanjiScan.match(row).hasMatch();
+    }
+
+    if (statement.access == Hot && scans) {
+        problems.append("scans the kanji table");
+    } else if (statement.access == FirstPage && scans && text.contains("USE TEMP B-TREE")) {
+        problems.append("scans the kanji table and sorts the result");
+    }
+    if (statement.access != Cold) {
+        for (const QString &index : statement.expectedIndexes) {
+            if (!text.contains(index)) {
+                problems.append("does not use " + index);
+            }
+        }
+    }
+    return problems;
+}
+
+// Every status, sort key and direction, a page at a time. Sorting by
+// next_review pages to the end so the seeks across NULLs are exercised.
+void browseAll(KanjiDatabase &database, StatementLog &log, const QString &scope)
+{
+    const QList<KanjiBrowseQuery::Status> statuses = {KanjiBrowseQuery::AllCards, KanjiBrowseQuery::NewCards,
+                                                      KanjiBrowseQuery::LearnedCards, KanjiBrowseQuery::DueCards};
+    const QList<KanjiBrowseQuery::SortKey> sortKeys = {KanjiBrowseQuery::SortById, KanjiBrowseQuery::SortByKanji,
+                                                       KanjiBrowseQuery::SortBySrsLevel,
+                                                       KanjiBrowseQuery::SortByNextReview,
+                                                       KanjiBrowseQuery::SortByPriority};
+
+    for (KanjiBrowseQuery::Status status : statuses) {
+        for (const QString &text : {QString(), QString("meaning")}) {
+            KanjiBrowseQuery browse;
+            browse.status = status;
+            browse.text = text;
+
+            // Matches everything unfiltered, so it counts the whole deck by definition
+            const bool wholeDeck = status == KanjiBrowseQuery::AllCards && text.isEmpty() && database.activeDeck() == 0;
+            log.run(scope + "browse_count", wholeDeck ? Cold : Hot, [&]() { database.countKanji(browse); });
+
+            for (KanjiBrowseQuery::SortKey sortKey : sortKeys) {
+                for (bool descending : {false, true}) {
+                    browse.sortKey = sortKey;
+                    browse.descending = descending;
+                    const int maxPages = sortKey == KanjiBrowseQuery::SortByNextReview ? INT_MAX : 3;
+
+                    KanjiPageCursor cursor;
+                    for (int page = 0; page < maxPages; ++page) {
+                        KanjiResultSet rows;
+                        log.run(scope + (page == 0 ? "browse_first_page" : "browse_page"), page == 0 ? FirstPage : Hot,
+                                [&]() { rows = database.getKanjiPageRows(browse, cursor, PageSize); });
+                        if (rows.size() < PageSize) {
+                            break;
+                        }
+                        cursor = KanjiDatabase::cursorAfter(rows.last(), sortKey);
+                    }
+                }
+            }
+        }
+    }
+}
+
+// The study loop and counters as the main window drives them
+void study(KanjiDatabase &database, StatementLog &log, const QString &scope)
+{
+    log.run(scope + "new_queue", Hot, [&]() { database.getNewKanji(10); }, {"idx_kanji_new_priority"});
+    log.run(scope + "review_queue", Hot, [&]() { database.getReviewKanji(); }, {"idx_kanji_review"});
+    log.run(scope + "due_count", Hot, [&]() { database.getReviewDueCount(); }, {"idx_kanji_review"});
+    log.run(scope + "next_review", Hot, [&]() { database.getNextReviewTime(); }, {"idx_kanji_review"});
+    log.run(scope + "learned_count", Hot, [&]() { database.getLearnedKanjiCount(); });
+    log.run(scope + "new_count", Hot, [&]() { database.getNewKanjiCount(); });
+    log.run(scope + "level_counts", Hot, [&]() { database.getKanjiCountByLevel(); });
+    log.run(scope + "forecast", Hot, [&]() { database.getScheduledReviews(KanjiClock::now().addDays(37)); },
+            {"idx_kanji_review"});
+    log.run(scope + "total_count", database.activeDeck() == 0 ? Cold : Hot, [&]() { database.getTotalKanjiCount(); });
+    log.run(scope + "card_states", database.activeDeck() == 0 ? Cold : Hot, [&]() {
+        KanjiCardColumns cards;
+        database.readCardStates(cards);
+    });
+    log.run(scope + "review_log", Hot, [&]() {
+        KanjiReviewColumns reviews;
+        database.readReviewLog(reviews);
+    }, {"INTEGER PRIMARY KEY"});
+    log.run(scope + "search", Hot, [&]() { database.searchKanji("meaning 12"); });
+
+    const QList<KanjiCard> batch = database.getNewKanji(2);
+    for (const KanjiCard &card : batch) {
+        log.run(scope + "card", Hot, [&]() { database.getKanjiById(card.id); }, {"INTEGER PRIMARY KEY"});
+        log.run(scope + "answer", Hot, [&]() { database.updateKanjiProgress(card.id, true, card.difficulty_level); });
+    }
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("KanjiPlanAudit");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Checks the query plan of every statement KanjiDatabase issues.");
+    parser.addHelpOption();
+    parser.addOptions({
+        {"deck-size", "Cards in the generated deck.", "n", "2136"},
+        {"data-dir", "Database directory, a temporary one by default.", "dir"},
+        {"verbose", "Print every plan and keep the database's debug output."}
+    });
+    parser.process(app);
+
+    const bool verbose = parser.isSet("verbose");
+    if (!verbose) {
+        QLoggingCategory::setFilterRules("default.debug=false");
+    }
+
+    const int deckSize = qBound(1, parser.value("deck-size").toInt(), 0x9FFF - 0x4E00);
+    QTemporaryDir temporaryDir;
+    const QString dataDir = parser.isSet("data-dir") ? parser.value("data-dir") : temporaryDir.path();
+    QDir().mkpath(dataDir);
+    KanjiDatabase::setDataLocation(dataDir);
+
+    StatementLog log;
+    KanjiDatabase::setStatementObserver([&log](const QString &sql) { log.record(sql); });
+
+    KanjiClock::setVirtualTime(QDateTime(QDate(2024, 1, 1), QTime(19, 0)));
+
+    KanjiDatabase database("KanjiPlanAudit");
+    const QString deckPath = dataDir + "/audit_deck.tsv";
+    if (!database.initialize() || !writeSyntheticDeck(deckPath, deckSize) || !database.importKanjiFile(deckPath)) {
+        qWarning() << "Setup failed:" << database.getLastError();
+        return 2;
+    }
+
+    // Some history so every status has rows: a few hundred cards learned over
+    // a few weeks, some of them due again
+    for (int day = 0; day < LearnBatches; ++day) {
+        for (const KanjiCard &card : database.getNewKanji(10)) {
+            log.run("answer", Hot, [&]() { database.updateKanjiProgress(card.id, day % 4 != 0, card.difficulty_level); });
+        }
+        KanjiClock::advance(8 * 3600);
+    }
+
+    QTextStream console(stdout);
+
+    // Unscoped, then scoped to a mid-size deck
+    int scopedDeck = 0;
+    log.run("decks", Hot, [&]() {
+        for (const KanjiDeck &deck : database.getDecks()) {
+            if (deck.jlpt_level == 3) {
+                scopedDeck = deck.id;
+            }
+        }
+    });
+    for (int deckId : {0, scopedDeck}) {
+        log.run("set_deck", Cold, [&]() { database.setActiveDeck(deckId); });
+        const QString scope = deckId == 0 ? QString() : QString("deck:");
+        study(database, log, scope);
+        browseAll(database, log, scope);
+    }
+    log.run("set_deck", Cold, [&]() { database.setActiveDeck(0); });
+
+    // Built from a whole-deck read on first use, then looked up by id
+    log.run("reading_index", Cold, [&]() { database.findKanjiByReading("か", true, 20); });
+    log.run("reading_lookup", Hot, [&]() { database.findKanjiByReading("か", true, 20); }, {"INTEGER PRIMARY KEY"});
+
+    // Write-behind batches
+    if (database.enableWriteBehind()) {
+        for (const KanjiCard &card : database.getReviewKanji().mid(0, 5)) {
+            log.run("answer", Hot, [&]() { database.updateKanjiProgress(card.id, true, card.difficulty_level); });
+        }
+        log.run("flush", Hot, [&]() { database.flushProgress(); });
+    }
+
+    // Whole-deck and maintenance operations
+    const QString exportPath = dataDir + "/audit_export.kcol";
+    log.run("all_cards", Cold, [&]() { database.getAllKanji(); });
+    log.run("all_rows", Cold, [&]() { database.getAllKanjiRows(); });
+    log.run("srs_levels", Cold, [&]() { database.getKanjiSrsLevels(); });
+    log.run("export", Cold, [&]() { database.exportCards(exportPath); });
+    log.run("import", Cold, [&]() { database.importCards(exportPath); });
+    log.run("sync", Cold, [&]() {
+        database.getDeviceId();
+        const QList<KanjiProgressRecord> records = database.getProgressChangesSince(0);
+        database.applyProgressChanges(records);
+        database.setSyncValue("audit", "1");
+        database.getSyncValue("audit");
+    });
+    log.run("priorities", Cold, [&]() { database.setKanjiPriorities({{"一", 100}, {"二", 50}}); });
+    log.run("testing", Cold, [&]() {
+        database.setImmediateReviewTime(1, 60);
+        database.debugShowAllLearnedKanji();
+        database.resetAllKanjiToUnlearned();
+    });
+
+    QCoreApplication::processEvents();
+    KanjiDatabase::setStatementObserver({});
+    KanjiClock::useSystemTime();
+
+    // Plans come from a second connection so the audited one is left as it was
+    int failures = 0;
+    int audited = 0;
+    {
+        QSqlDatabase explainDb = QSqlDatabase::addDatabase("QSQLITE", "KanjiPlanAudit.explain");
+        explainDb.setDatabaseName(dataDir + "/kanji_learning.db");
+        if (!explainDb.open()) {
+            qWarning() << "Cannot open database for EXPLAIN:" << explainDb.lastError().text();
+            return 2;
+        }
+
+        QList<Statement> statements = log.all();
+        std::stable_sort(statements.begin(), statements.end(), [](const Statement &a, const Statement &b) {
+            return a.access < b.access;
+        });
+
+        for (const Statement &statement : statements) {
+            if (!isPlanned(statement.sql)) {
+                continue;
+            }
+            ++audited;
+
+            QStringList plan;
+            QString error;
+            QStringList problems;
+            if (!explain(explainDb, statement.sql, plan, error)) {
+                problems.append("EXPLAIN failed: " + error);
+            } else {
+                problems = checkPlan(statement, plan);
+            }
+
+            if (!problems.isEmpty() || verbose) {
+                console << (problems.isEmpty() ? "ok  " : "FAIL") << " [" << AccessNames[statement.access] << "] "
+                        << statement.operations.join(", ") << "\n    " << statement.sql << "\n";
+                for (const QString &row : plan) {
+                    console << "      " << row << "\n";
+                }
+                for (const QString &problem : problems) {
+                    console << "    -> " << problem << "\n";
+                }
+            }
+            failures += problems.isEmpty() ? 0 : 1;
+        }
+        explainDb.close();
+    }
+    QSqlDatabase::removeDatabase("KanjiPlanAudit.explain");
+
+    console << QString("%1 statements audited, %2 failing\n").arg(audited).arg(failures);
+    return failures ? 1 : 0;
+}
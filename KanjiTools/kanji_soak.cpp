@@ -0,0 +1,370 @@
+// Soak test for KanjiDatabase: replays a year of daily study sessions on a
+// virtual clock against a full-size deck and checks that query latency does
+// not degrade as review history accumulates. Sessions run through
+// QuizSession, so progress is written exactly as the learning window does.
+//
+//   KanjiSoak [--days 365] [--deck-size 2136] [--baseline soak_baseline.csv]
+//             [--tolerance 0.25] [--slack-us 200] [--report soak_report.csv]
+//             [--write-baseline file] [--data-dir dir] [--seed 1]
+//
+// Latency is gated on the final window (the largest database), every
+// percentile against the baseline: measured <= baseline * (1 + tolerance)
+// + slack. Exit code 0 when within, 1 on a regression, 2 on a setup failure,
+// 77 (skipped) when the baseline has no measurements to gate against.
+
+#include "kanji_database.h"
+#include "kanji_clock.h"
+#include "kanji_analytics.h"
+#include "quiz_session.h"
+#include "synthetic_deck.h"
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDate>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QLoggingCategory>
+#include <QMap>
+#include <QRandomGenerator>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QSysInfo>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <QThread>
+#include <QVector>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+constexpr int SkippedExitCode = 77; // ctest SKIP_RETURN_CODE
+constexpr int WindowDays = 30;
+constexpr int NewCardsPerDay = 10;
+constexpr int MaxReviewsPerDay = 200;
+constexpr int BacklogLimit = 100;      // No new cards while this many reviews are overdue
+constexpr double Accuracy = 0.85;
+constexpr int SecondsPerAnswer = 8;
+const double Percentiles[] = {50.0, 95.0, 99.0};
+
+struct LatencySummary {
+    qint64 count = 0;
+    qint64 values[3] = {}; // p50, p95, p99 in microseconds
+};
+
+// Per-operation samples for the current window, in microseconds
+class LatencyRecorder
+{
+public:
+    template <typename Operation>
+    auto time(const QString &name, Operation operation)
+    {
+        QElapsedTimer timer;
+        timer.start();
+        auto result = operation();
+        samples[name].append(timer.nsecsElapsed() / 1000);
+        return result;
+    }
+
+    QMap<QString, LatencySummary> takeWindow()
+    {
+        QMap<QString, LatencySummary> summaries;
+        for (auto it = samples.begin(); it != samples.end(); ++it) {
+            QVector<qint64> &values = it.value();
+            std::sort(values.begin(), values.end());
+
+            LatencySummary summary;
+            summary.count = values.size();
+            for (int i = 0; i < 3; ++i) {
+                qsizetype rank = qsizetype(std::ceil(Percentiles[i] / 100.0 * values.size())) - 1;
+                summary.values[i] = values.at(qBound<qsizetype>(0, rank, values.size() - 1));
+            }
+            summaries.insert(it.key(), summary);
+        }
+        samples.clear();
+        return summaries;
+    }
+
+private:
+    QMap<QString, QVector<qint64>> samples;
+};
+
+qint64 databaseBytes(const QString &directory)
+{
+    const QString path = directory + "/kanji_learning.db";
+    return QFileInfo(path).size() + QFileInfo(path + "-wal").size();
+}
+
+// Run parameters the ceilings were measured with; a baseline only gates runs
+// with the same ones
+QString runConfiguration(int days, int deckSize, quint32 seed)
+{
+    return QString("days=%1 deck_size=%2 seed=%3").arg(days).arg(deckSize).arg(seed);
+}
+
+bool readBaseline(const QString &path, QMap<QString, LatencySummary> &baseline, QString &configuration)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        return false;
+    }
+
+    QTextStream in(&file);
+    while (!in.atEnd()) {
+        const QString line = in.readLine().trimmed();
+        if (line.startsWith("# run: ")) {
+            configuration = line.mid(7);
+            continue;
+        }
+        if (line.isEmpty() || line.startsWith('#') || line.startsWith("operation,")) {
+            continue;
+        }
+        const QStringList fields = line.split(',');
+        if (fields.size() != 4) {
+            return false;
+        }
+        LatencySummary summary;
+        for (int i = 0; i < 3; ++i) {
+            summary.values[i] = fields[i + 1].toLongLong();
+        }
+        baseline.insert(fields[0], summary);
+    }
+    return true;
+}
+
+bool writeBaseline(const QString &path, const QMap<QString, LatencySummary> &window, const QString &configuration)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        return false;
+    }
+
+    // The machine and build matter as much as the run parameters
+    QSqlQuery version(QSqlDatabase::database("KanjiSoak"));
+    const QString sqliteVersion = version.exec("SELECT sqlite_version()") && version.next()
+        ? version.value(0).toString() : QString("unknown");
+#ifdef QT_DEBUG
+    const char *buildType = "debug";
+#else
+    const char *buildType = "release";
+#endif
+
+    QTextStream out(&file);
+    out << "# KanjiSoak latency ceilings in microseconds, final window of the run below\n";
+    out << "# Written by KanjiSoak --write-baseline on " << QDate::currentDate().toString(Qt::ISODate) << "\n";
+    out << "# run: " << configuration << "\n";
+    out << "# host: " << QSysInfo::prettyProductName() << ", " << QSysInfo::currentCpuArchitecture()
+        << ", " << QThread::idealThreadCount() << " threads\n";
+    out << "# build: " << buildType << ", Qt " << qVersion() << ", SQLite " << sqliteVersion << "\n";
+    out << "operation,p50_us,p95_us,p99_us\n";
+    for (auto it = window.constBegin(); it != window.constEnd(); ++it) {
+        out << it.key() << ',' << it->values[0] << ',' << it->values[1] << ',' << it->values[2] << '\n';
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("KanjiSoak");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Simulates daily study sessions on a virtual clock and gates query latency.");
+    parser.addHelpOption();
+    parser.addOptions({
+        {"days", "Simulated days.", "n", "365"},
+        {"deck-size", "Cards in the generated deck.", "n", "2136"},
+        {"baseline", "Baseline CSV to gate against.", "file",
+         QCoreApplication::applicationDirPath() + "/soak_baseline.csv"},
+        {"tolerance", "Allowed relative regression per percentile.", "fraction", "0.25"},
+        {"slack-us", "Allowed absolute regression per percentile, for timer noise.", "us", "200"},
+        {"report", "Per-window CSV of latency and database size.", "file", "soak_report.csv"},
+        {"write-baseline", "Write the final window as a new baseline and skip the gate.", "file"},
+        {"data-dir", "Database directory, a temporary one by default.", "dir"},
+        {"seed", "Random seed for answers and searches.", "n", "1"},
+        {"verbose", "Keep the database's debug output."}
+    });
+    parser.process(app);
+
+    // KanjiDatabase logs every review query and answer
+    if (!parser.isSet("verbose")) {
+        QLoggingCategory::setFilterRules("default.debug=false");
+    }
+
+    const int days = parser.value("days").toInt();
+    const int deckSize = qBound(1, parser.value("deck-size").toInt(), 0x9FFF - 0x4E00);
+    const double tolerance = parser.value("tolerance").toDouble();
+    const qint64 slack = parser.value("slack-us").toLongLong();
+
+    QTemporaryDir temporaryDir;
+    const QString dataDir = parser.isSet("data-dir") ? parser.value("data-dir") : temporaryDir.path();
+    QDir().mkpath(dataDir);
+    KanjiDatabase::setDataLocation(dataDir);
+
+    const QString configuration = runConfiguration(days, deckSize, parser.value("seed").toUInt());
+    QMap<QString, LatencySummary> baseline;
+    QString baselineConfiguration;
+    const bool gate = !parser.isSet("write-baseline");
+    if (gate && !readBaseline(parser.value("baseline"), baseline, baselineConfiguration)) {
+        qWarning() << "Cannot read baseline" << parser.value("baseline");
+        return 2;
+    }
+    if (gate && baseline.isEmpty()) {
+        QTextStream(stdout) << "The baseline has no measurements yet; regenerate it with --write-baseline\n";
+        return SkippedExitCode;
+    }
+    if (gate && baselineConfiguration != configuration) {
+        qWarning() << "Baseline was measured with" << baselineConfiguration << "- this run is" << configuration;
+    }
+
+    // Day 0 at midnight so sessions land at the same wall-clock time every day
+    const QDateTime start(QDate(2024, 1, 1), QTime(0, 0));
+    KanjiClock::setVirtualTime(start);
+
+    KanjiDatabase database("KanjiSoak");
+    const QString deckPath = dataDir + "/soak_deck.tsv";
+    int imported = 0;
+    if (!database.initialize() || !writeSyntheticDeck(deckPath, deckSize) || !database.importKanjiFile(deckPath, &imported) ||
+        !database.enableWriteBehind()) {
+        qWarning() << "Setup failed:" << database.getLastError();
+        return 2;
+    }
+
+    QFile report(parser.value("report"));
+    if (!report.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        qWarning() << "Cannot write report" << report.fileName();
+        return 2;
+    }
+    QTextStream reportOut(&report);
+    reportOut << "day,database_bytes,learned,operation,count,p50_us,p95_us,p99_us\n";
+
+    QTextStream console(stdout);
+    console << QString("Deck: %1 cards, %2 days, data in %3\n").arg(database.getTotalKanjiCount()).arg(days).arg(dataDir);
+
+    QRandomGenerator random(parser.value("seed").toUInt());
+    KanjiAnalytics analytics(&database);
+    LatencyRecorder recorder;
+    QMap<QString, LatencySummary> window;
+    qint64 answers = 0;
+
+    // One session as the learning window runs it: each card's meaning and
+    // reading asked in turn, a wrong answer retried until right, and progress
+    // written whenever the session reports it
+    auto runSession = [&](const QList<KanjiCard> &cards, QuizSession::Mode mode, double accuracy) {
+        QHash<int, int> difficulty;
+        for (const KanjiCard &card : cards) {
+            difficulty.insert(card.id, card.difficulty_level);
+        }
+        auto write = [&](const QList<QuizProgressUpdate> &updates) {
+            for (const QuizProgressUpdate &update : updates) {
+                recorder.time("answer", [&]() {
+                    return database.updateKanjiProgress(update.cardId, update.correct, difficulty.value(update.cardId));
+                });
+            }
+        };
+
+        QuizSession session(cards, mode);
+        while (!session.isFinished()) {
+            const bool correct = random.generateDouble() < accuracy;
+            const QuizAnswerOutcome outcome = session.submitAnswer(correct ? session.expectedAnswer() : QString("x"));
+            write(outcome.progressUpdates);
+            KanjiClock::advance(SecondsPerAnswer);
+            ++answers;
+            if (outcome.result == QuizAnswerOutcome::Correct) {
+                session.advance();
+            } else {
+                session.retry();
+            }
+        }
+        write(session.completion().progressUpdates);
+    };
+
+    for (int day = 1; day <= days; ++day) {
+        // Evening session, starting within the same hour each day
+        KanjiClock::setVirtualTime(start.addDays(day).addSecs(19 * 3600 + random.bounded(3600)));
+
+        const int due = recorder.time("due_count", [&]() { return database.getReviewDueCount(); });
+        recorder.time("level_counts", [&]() { return database.getKanjiCountByLevel(); });
+        recorder.time("decks", [&]() { return database.getDecks(); });
+
+        QList<KanjiCard> reviews = recorder.time("review_queue", [&]() { return database.getReviewKanji(); });
+        runSession(reviews.mid(0, MaxReviewsPerDay), QuizSession::Mode::Review, Accuracy);
+
+        if (due < BacklogLimit) {
+            QList<KanjiCard> batch = recorder.time("new_batch", [&]() { return database.getNewKanji(NewCardsPerDay); });
+            runSession(batch, QuizSession::Mode::Learning, 1.0);
+        }
+
+        recorder.time("flush", [&]() { return database.flushProgress(); });
+        recorder.time("next_review", [&]() { return database.getNextReviewTime(); });
+
+        const QString term = QString("meaning %1").arg(random.bounded(deckSize));
+        recorder.time("search", [&]() { return database.searchKanji(term); });
+
+        KanjiBrowseQuery browse;
+        browse.status = KanjiBrowseQuery::LearnedCards;
+        browse.sortKey = KanjiBrowseQuery::SortByNextReview;
+        recorder.time("browse_page", [&]() { return database.getKanjiPage(browse, KanjiPageCursor(), 256); });
+        recorder.time("all_rows", [&]() { return database.getAllKanjiRows().size(); });
+        recorder.time("statistics", [&]() { return analytics.statistics().answers.reviews; });
+
+        // Change notifications are delivered through the event loop
+        QCoreApplication::processEvents();
+
+        if (day % WindowDays == 0 || day == days) {
+            window = recorder.takeWindow();
+            const qint64 bytes = databaseBytes(dataDir);
+            const int learned = database.getLearnedKanjiCount();
+            for (auto it = window.constBegin(); it != window.constEnd(); ++it) {
+                reportOut << day << ',' << bytes << ',' << learned << ',' << it.key() << ',' << it->count << ','
+                          << it->values[0] << ',' << it->values[1] << ',' << it->values[2] << '\n';
+            }
+            console << QString("Day %1: %2 KB, %3 learned, %4 answers, review_queue p95 %5 us, answer p95 %6 us\n")
+                       .arg(day, 3).arg(bytes / 1024).arg(learned).arg(answers)
+                       .arg(window.value("review_queue").values[1]).arg(window.value("answer").values[1]);
+            console.flush();
+        }
+    }
+
+    KanjiClock::useSystemTime();
+
+    // Heap blocks kept by a whole-deck read: arena result set against KanjiCard strings
+    const KanjiResultSet::Stats arenaStats = database.getAllKanjiRows().stats();
+    console << QString("Arena result set: %1 rows in %2 heap allocations (%3 KB), about %4 as KanjiCard strings\n")
+               .arg(arenaStats.rows).arg(arenaStats.heapAllocations).arg(arenaStats.bytesReserved / 1024)
+               .arg(arenaStats.stringAllocations);
+
+    if (!gate) {
+        if (!writeBaseline(parser.value("write-baseline"), window, configuration)) {
+            qWarning() << "Cannot write baseline" << parser.value("write-baseline");
+            return 2;
+        }
+        console << "Baseline written to " << parser.value("write-baseline") << "\n";
+        return 0;
+    }
+
+    // Final window against the baseline; operations without a baseline are reported only
+    int regressions = 0;
+    for (auto it = window.constBegin(); it != window.constEnd(); ++it) {
+        if (!baseline.contains(it.key())) {
+            console << QString("%1: no baseline\n").arg(it.key());
+            continue;
+        }
+        const LatencySummary &expected = baseline[it.key()];
+        for (int i = 0; i < 3; ++i) {
+            const qint64 limit = qint64(expected.values[i] * (1.0 + tolerance)) + slack;
+            if (it->values[i] > limit) {
+                console << QString("REGRESSION %1 p%2: %3 us, limit %4 us (baseline %5 us)\n")
+                           .arg(it.key()).arg(Percentiles[i]).arg(it->values[i]).arg(limit).arg(expected.values[i]);
+                ++regressions;
+            }
+        }
+    }
+
+    console << (regressions ? QString("%1 percentiles over baseline\n").arg(regressions)
+                            : QString("All percentiles within baseline\n"));
+    return regressions ? 1 : 0;
+}
@@ -0,0 +1,28 @@
+#include "synthetic_deck.h"
+#include <QFile>
+#include <QStringList>
+#include <QTextStream>
+
+bool writeSyntheticDeck(const QString &path, int deckSize)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        return false;
+    }
+
+    static const QStringList syllables = {"か", "き", "し", "せ", "と", "に", "は", "も", "よ", "りょ", "じゅ", "こう"};
+    QTextStream out(&file);
+    out.setEncoding(QStringConverter::Utf8);
+    for (int i = 0; i < deckSize; ++i) {
+        const char32_t codePoint = 0x4E00 + char32_t(i);
+        const QString kanji = QString::fromUcs4(&codePoint, 1);
+        const QString on = syllables[i % syllables.size()] + syllables[(i / 7) % syllables.size()];
+        const QString kun = syllables[(i / 3) % syllables.size()];
+        const int jlpt = i < 80 ? 5 : i < 250 ? 4 : i < 620 ? 3 : i < 990 ? 2 : 1;
+
+        out << kanji << '\t' << "meaning " << i << '\t' << on << '\t' << kun << '\t'
+            << kanji << kanji << '\t' << on << kun << '\t' << "example " << i << '\t'
+            << (1 + i % 5) << '\t' << jlpt << '\n';
+    }
+    return true;
+}
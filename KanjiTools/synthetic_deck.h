@@ -0,0 +1,11 @@
+#ifndef SYNTHETIC_DECK_H
+#define SYNTHETIC_DECK_H
+
+#include <QString>
+
+// Joyo-sized deck for the tools: consecutive CJK code points, JLPT levels in
+// roughly the real proportions (N5 80, N4 170, N3 370, N2 370, N1 the rest),
+// written as a TSV for KanjiDatabase::importKanjiFile
+bool writeSyntheticDeck(const QString &path, int deckSize);
+
+#endif // SYNTHETIC_DECK_H